@@ -0,0 +1,130 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "/root/repo/CMakeModules/BuildErlang.cmake"
+  "/root/repo/CMakeModules/FindElixir.cmake"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/doc/CMakeLists.txt"
+  "/root/repo/examples/CMakeLists.txt"
+  "/root/repo/examples/erlang/CMakeLists.txt"
+  "/root/repo/examples/erlang/esp32/CMakeLists.txt"
+  "/root/repo/libs/CMakeLists.txt"
+  "/root/repo/libs/eavmlib/CMakeLists.txt"
+  "/root/repo/libs/estdlib/CMakeLists.txt"
+  "/root/repo/libs/etest/CMakeLists.txt"
+  "/root/repo/src/CMakeLists.txt"
+  "/root/repo/src/libAtomVM/CMakeLists.txt"
+  "/root/repo/src/libAtomVM/version.h.in"
+  "/root/repo/src/platforms/generic_unix/CMakeLists.txt"
+  "/root/repo/tests/CMakeLists.txt"
+  "/root/repo/tests/erlang_tests/CMakeLists.txt"
+  "/root/repo/tests/libs/eavmlib/CMakeLists.txt"
+  "/root/repo/tests/libs/estdlib/CMakeLists.txt"
+  "/root/repo/tools/packbeam/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckFunctionExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindDoxygen.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/FindZLIB.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/SelectLibraryConfigurations.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/libAtomVM/version.h"
+  "src/libAtomVM/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/platforms/generic_unix/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/erlang_tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/libs/estdlib/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/libs/eavmlib/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/packbeam/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "libs/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "libs/estdlib/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "libs/eavmlib/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "libs/etest/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/erlang/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/erlang/esp32/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "doc/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "src/CMakeFiles/AtomVM.dir/DependInfo.cmake"
+  "src/libAtomVM/CMakeFiles/generated.dir/DependInfo.cmake"
+  "src/libAtomVM/CMakeFiles/generated-nifs-hash.dir/DependInfo.cmake"
+  "src/libAtomVM/CMakeFiles/libAtomVM.dir/DependInfo.cmake"
+  "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-erlang.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-structs.dir/DependInfo.cmake"
+  "tests/erlang_tests/CMakeFiles/erlang_test_modules.dir/DependInfo.cmake"
+  "tests/libs/estdlib/CMakeFiles/test_estdlib_lib_beams.dir/DependInfo.cmake"
+  "tests/libs/estdlib/CMakeFiles/test_estdlib_lib.dir/DependInfo.cmake"
+  "tests/libs/estdlib/CMakeFiles/test_estdlib.dir/DependInfo.cmake"
+  "tests/libs/eavmlib/CMakeFiles/test_eavmlib_lib_beams.dir/DependInfo.cmake"
+  "tests/libs/eavmlib/CMakeFiles/test_eavmlib_lib.dir/DependInfo.cmake"
+  "tests/libs/eavmlib/CMakeFiles/test_eavmlib.dir/DependInfo.cmake"
+  "tools/packbeam/CMakeFiles/PackBEAM.dir/DependInfo.cmake"
+  "libs/estdlib/CMakeFiles/estdlib_beams.dir/DependInfo.cmake"
+  "libs/estdlib/CMakeFiles/estdlib.dir/DependInfo.cmake"
+  "libs/eavmlib/CMakeFiles/eavmlib_beams.dir/DependInfo.cmake"
+  "libs/eavmlib/CMakeFiles/eavmlib.dir/DependInfo.cmake"
+  "libs/etest/CMakeFiles/etest_beams.dir/DependInfo.cmake"
+  "libs/etest/CMakeFiles/etest.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/hello_world_main.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/hello_world.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/udp_server_main.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/udp_server.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/udp_client_main.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/udp_client.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/server_main.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/server.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/code_lock_main.dir/DependInfo.cmake"
+  "examples/erlang/CMakeFiles/code_lock.dir/DependInfo.cmake"
+  "examples/erlang/esp32/CMakeFiles/blink_main.dir/DependInfo.cmake"
+  "examples/erlang/esp32/CMakeFiles/blink.dir/DependInfo.cmake"
+  "examples/erlang/esp32/CMakeFiles/sta_network_main.dir/DependInfo.cmake"
+  "examples/erlang/esp32/CMakeFiles/sta_network.dir/DependInfo.cmake"
+  "examples/erlang/esp32/CMakeFiles/udp_server_blink_main.dir/DependInfo.cmake"
+  "examples/erlang/esp32/CMakeFiles/udp_server_blink.dir/DependInfo.cmake"
+  )
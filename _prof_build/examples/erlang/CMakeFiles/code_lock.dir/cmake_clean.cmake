@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/code_lock"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/code_lock.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/code_lock_main"
+  "code_lock.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/code_lock_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
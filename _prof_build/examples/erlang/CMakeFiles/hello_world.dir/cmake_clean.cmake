@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hello_world"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/hello_world.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
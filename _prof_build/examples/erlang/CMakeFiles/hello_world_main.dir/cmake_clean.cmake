@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hello_world_main"
+  "hello_world.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/hello_world_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
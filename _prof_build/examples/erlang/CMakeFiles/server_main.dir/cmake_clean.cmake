@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/server_main"
+  "server.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/server_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/udp_client_main"
+  "udp_client.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/udp_client_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/udp_server"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/udp_server.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
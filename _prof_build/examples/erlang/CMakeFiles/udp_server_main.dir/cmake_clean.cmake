@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/udp_server_main"
+  "udp_server.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/udp_server_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/blink_main"
+  "blink.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/blink_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
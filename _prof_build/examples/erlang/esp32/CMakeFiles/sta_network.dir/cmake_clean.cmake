@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sta_network"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/sta_network.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sta_network_main"
+  "sta_network.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/sta_network_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
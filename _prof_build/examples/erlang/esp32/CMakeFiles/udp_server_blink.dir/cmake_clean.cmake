@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/udp_server_blink"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/udp_server_blink.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/udp_server_blink_main"
+  "udp_server_blink.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/udp_server_blink_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
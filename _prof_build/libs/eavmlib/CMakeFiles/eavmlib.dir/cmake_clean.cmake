@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eavmlib"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/eavmlib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
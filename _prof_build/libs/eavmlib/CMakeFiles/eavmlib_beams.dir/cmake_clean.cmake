@@ -0,0 +1,16 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eavmlib_beams"
+  "beams/console.beam"
+  "beams/gpio.beam"
+  "beams/i2c.beam"
+  "beams/logger.beam"
+  "beams/network_fsm.beam"
+  "beams/spi.beam"
+  "beams/timer_manager.beam"
+  "beams/timestamp_util.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/eavmlib_beams.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/estdlib"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/estdlib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,16 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/estdlib_beams"
+  "beams/avm_calendar.beam"
+  "beams/avm_gen_server.beam"
+  "beams/avm_gen_statem.beam"
+  "beams/avm_gen_udp.beam"
+  "beams/avm_lists.beam"
+  "beams/avm_proplists.beam"
+  "beams/avm_timer.beam"
+  "beams/erlang.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/estdlib_beams.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
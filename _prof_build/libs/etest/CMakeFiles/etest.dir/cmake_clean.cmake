@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/etest"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/etest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
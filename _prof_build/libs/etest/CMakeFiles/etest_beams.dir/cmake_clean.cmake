@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/etest_beams"
+  "beams/etest.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/etest_beams.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "AtomVM"
+  "AtomVM.pdb"
+  "CMakeFiles/AtomVM.dir/main.c.o"
+  "CMakeFiles/AtomVM.dir/main.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/AtomVM.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
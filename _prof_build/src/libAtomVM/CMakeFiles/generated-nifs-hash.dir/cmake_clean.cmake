@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/generated-nifs-hash"
+  "nifs_hash.h"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/generated-nifs-hash.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,44 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/libAtomVM/atom.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/atom.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/atom.c.o.d"
+  "/root/repo/src/libAtomVM/atomshashtable.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/atomshashtable.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/atomshashtable.c.o.d"
+  "/root/repo/src/libAtomVM/avmpack.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/avmpack.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/avmpack.c.o.d"
+  "/root/repo/src/libAtomVM/bif.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/bif.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/bif.c.o.d"
+  "/root/repo/src/libAtomVM/context.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/context.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/context.c.o.d"
+  "/root/repo/src/libAtomVM/debug.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/debug.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/debug.c.o.d"
+  "/root/repo/src/libAtomVM/defaultatoms.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/defaultatoms.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/defaultatoms.c.o.d"
+  "/root/repo/src/libAtomVM/externalterm.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/externalterm.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/externalterm.c.o.d"
+  "/root/repo/src/libAtomVM/functionprofiler.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/functionprofiler.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/functionprofiler.c.o.d"
+  "/root/repo/src/libAtomVM/globalcontext.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/globalcontext.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/globalcontext.c.o.d"
+  "/root/repo/src/libAtomVM/heappool.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/heappool.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/heappool.c.o.d"
+  "/root/repo/src/libAtomVM/iff.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/iff.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/iff.c.o.d"
+  "/root/repo/src/libAtomVM/interop.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/interop.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/interop.c.o.d"
+  "/root/repo/src/libAtomVM/mailbox.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/mailbox.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/mailbox.c.o.d"
+  "/root/repo/src/libAtomVM/memory.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/memory.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/memory.c.o.d"
+  "/root/repo/src/libAtomVM/messagepool.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/messagepool.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/messagepool.c.o.d"
+  "/root/repo/src/libAtomVM/module.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/module.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/module.c.o.d"
+  "/root/repo/src/libAtomVM/network.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/network.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/network.c.o.d"
+  "/root/repo/src/libAtomVM/nifs.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/nifs.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/nifs.c.o.d"
+  "/root/repo/src/libAtomVM/opcodestats.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/opcodestats.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/opcodestats.c.o.d"
+  "/root/repo/src/libAtomVM/port.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/port.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/port.c.o.d"
+  "/root/repo/src/libAtomVM/scheduler.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/scheduler.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/scheduler.c.o.d"
+  "/root/repo/src/libAtomVM/socket.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/socket.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/socket.c.o.d"
+  "/root/repo/src/libAtomVM/term.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/term.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/term.c.o.d"
+  "/root/repo/src/libAtomVM/valueshashtable.c" "src/libAtomVM/CMakeFiles/libAtomVM.dir/valueshashtable.c.o" "gcc" "src/libAtomVM/CMakeFiles/libAtomVM.dir/valueshashtable.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_prof_build/src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,59 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/libAtomVM.dir/atom.c.o"
+  "CMakeFiles/libAtomVM.dir/atom.c.o.d"
+  "CMakeFiles/libAtomVM.dir/atomshashtable.c.o"
+  "CMakeFiles/libAtomVM.dir/atomshashtable.c.o.d"
+  "CMakeFiles/libAtomVM.dir/avmpack.c.o"
+  "CMakeFiles/libAtomVM.dir/avmpack.c.o.d"
+  "CMakeFiles/libAtomVM.dir/bif.c.o"
+  "CMakeFiles/libAtomVM.dir/bif.c.o.d"
+  "CMakeFiles/libAtomVM.dir/context.c.o"
+  "CMakeFiles/libAtomVM.dir/context.c.o.d"
+  "CMakeFiles/libAtomVM.dir/debug.c.o"
+  "CMakeFiles/libAtomVM.dir/debug.c.o.d"
+  "CMakeFiles/libAtomVM.dir/defaultatoms.c.o"
+  "CMakeFiles/libAtomVM.dir/defaultatoms.c.o.d"
+  "CMakeFiles/libAtomVM.dir/externalterm.c.o"
+  "CMakeFiles/libAtomVM.dir/externalterm.c.o.d"
+  "CMakeFiles/libAtomVM.dir/functionprofiler.c.o"
+  "CMakeFiles/libAtomVM.dir/functionprofiler.c.o.d"
+  "CMakeFiles/libAtomVM.dir/globalcontext.c.o"
+  "CMakeFiles/libAtomVM.dir/globalcontext.c.o.d"
+  "CMakeFiles/libAtomVM.dir/heappool.c.o"
+  "CMakeFiles/libAtomVM.dir/heappool.c.o.d"
+  "CMakeFiles/libAtomVM.dir/iff.c.o"
+  "CMakeFiles/libAtomVM.dir/iff.c.o.d"
+  "CMakeFiles/libAtomVM.dir/interop.c.o"
+  "CMakeFiles/libAtomVM.dir/interop.c.o.d"
+  "CMakeFiles/libAtomVM.dir/mailbox.c.o"
+  "CMakeFiles/libAtomVM.dir/mailbox.c.o.d"
+  "CMakeFiles/libAtomVM.dir/memory.c.o"
+  "CMakeFiles/libAtomVM.dir/memory.c.o.d"
+  "CMakeFiles/libAtomVM.dir/messagepool.c.o"
+  "CMakeFiles/libAtomVM.dir/messagepool.c.o.d"
+  "CMakeFiles/libAtomVM.dir/module.c.o"
+  "CMakeFiles/libAtomVM.dir/module.c.o.d"
+  "CMakeFiles/libAtomVM.dir/network.c.o"
+  "CMakeFiles/libAtomVM.dir/network.c.o.d"
+  "CMakeFiles/libAtomVM.dir/nifs.c.o"
+  "CMakeFiles/libAtomVM.dir/nifs.c.o.d"
+  "CMakeFiles/libAtomVM.dir/opcodestats.c.o"
+  "CMakeFiles/libAtomVM.dir/opcodestats.c.o.d"
+  "CMakeFiles/libAtomVM.dir/port.c.o"
+  "CMakeFiles/libAtomVM.dir/port.c.o.d"
+  "CMakeFiles/libAtomVM.dir/scheduler.c.o"
+  "CMakeFiles/libAtomVM.dir/scheduler.c.o.d"
+  "CMakeFiles/libAtomVM.dir/socket.c.o"
+  "CMakeFiles/libAtomVM.dir/socket.c.o.d"
+  "CMakeFiles/libAtomVM.dir/term.c.o"
+  "CMakeFiles/libAtomVM.dir/term.c.o.d"
+  "CMakeFiles/libAtomVM.dir/valueshashtable.c.o"
+  "CMakeFiles/libAtomVM.dir/valueshashtable.c.o.d"
+  "liblibAtomVM.a"
+  "liblibAtomVM.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/libAtomVM.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
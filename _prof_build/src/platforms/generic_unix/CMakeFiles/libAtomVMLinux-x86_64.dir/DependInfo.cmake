@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/platforms/generic_unix/dirty_jobs.c" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/dirty_jobs.c.o" "gcc" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/dirty_jobs.c.o.d"
+  "/root/repo/src/platforms/generic_unix/file_driver.c" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/file_driver.c.o" "gcc" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/file_driver.c.o.d"
+  "/root/repo/src/platforms/generic_unix/gpio_driver.c" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/gpio_driver.c.o" "gcc" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/gpio_driver.c.o.d"
+  "/root/repo/src/platforms/generic_unix/mapped_file.c" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/mapped_file.c.o" "gcc" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/mapped_file.c.o.d"
+  "/root/repo/src/platforms/generic_unix/network_driver.c" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/network_driver.c.o" "gcc" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/network_driver.c.o.d"
+  "/root/repo/src/platforms/generic_unix/platform_defaultatoms.c" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/platform_defaultatoms.c.o" "gcc" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/platform_defaultatoms.c.o.d"
+  "/root/repo/src/platforms/generic_unix/socket_driver.c" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/socket_driver.c.o" "gcc" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/socket_driver.c.o.d"
+  "/root/repo/src/platforms/generic_unix/sys.c" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/sys.c.o" "gcc" "src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/sys.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_prof_build/src/libAtomVM/CMakeFiles/libAtomVM.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,25 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/dirty_jobs.c.o"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/dirty_jobs.c.o.d"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/file_driver.c.o"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/file_driver.c.o.d"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/gpio_driver.c.o"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/gpio_driver.c.o.d"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/mapped_file.c.o"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/mapped_file.c.o.d"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/network_driver.c.o"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/network_driver.c.o.d"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/platform_defaultatoms.c.o"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/platform_defaultatoms.c.o.d"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/socket_driver.c.o"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/socket_driver.c.o.d"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/sys.c.o"
+  "CMakeFiles/libAtomVMLinux-x86_64.dir/sys.c.o.d"
+  "liblibAtomVMLinux-x86_64.a"
+  "liblibAtomVMLinux-x86_64.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/libAtomVMLinux-x86_64.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "liblibAtomVMLinux-x86_64.a"
+)
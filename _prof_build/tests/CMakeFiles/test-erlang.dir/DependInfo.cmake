@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/test.c" "tests/CMakeFiles/test-erlang.dir/test.c.o" "gcc" "tests/CMakeFiles/test-erlang.dir/test.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_prof_build/src/libAtomVM/CMakeFiles/libAtomVM.dir/DependInfo.cmake"
+  "/root/repo/_prof_build/src/platforms/generic_unix/CMakeFiles/libAtomVMLinux-x86_64.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-erlang.dir/test.c.o"
+  "CMakeFiles/test-erlang.dir/test.c.o.d"
+  "test-erlang"
+  "test-erlang.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test-erlang.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-structs.dir/test-structs.c.o"
+  "CMakeFiles/test-structs.dir/test-structs.c.o.d"
+  "test-structs"
+  "test-structs.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test-structs.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,240 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/erlang_test_modules"
+  "absovf.beam"
+  "add.beam"
+  "biggerdifference.beam"
+  "biggerintegers.beam"
+  "binary_at_test.beam"
+  "binary_first_test.beam"
+  "binary_last_test.beam"
+  "booleans2_test.beam"
+  "booleans_test.beam"
+  "byte_size_test.beam"
+  "call_with_ref_test.beam"
+  "catch_badmatch.beam"
+  "catch_nocasematch.beam"
+  "catch_noifmatch.beam"
+  "compact15bitsinteger.beam"
+  "compact23bitsinteger.beam"
+  "compact23bitsneginteger.beam"
+  "compact27bitsinteger.beam"
+  "complex_struct_size0.beam"
+  "complex_struct_size1.beam"
+  "complex_struct_size2.beam"
+  "complex_struct_size3.beam"
+  "complex_struct_size4.beam"
+  "copy_terms0.beam"
+  "copy_terms1.beam"
+  "copy_terms10.beam"
+  "copy_terms11.beam"
+  "copy_terms12.beam"
+  "copy_terms13.beam"
+  "copy_terms14.beam"
+  "copy_terms15.beam"
+  "copy_terms16.beam"
+  "copy_terms17.beam"
+  "copy_terms18.beam"
+  "copy_terms2.beam"
+  "copy_terms3.beam"
+  "copy_terms4.beam"
+  "copy_terms5.beam"
+  "copy_terms6.beam"
+  "copy_terms7.beam"
+  "copy_terms8.beam"
+  "copy_terms9.beam"
+  "count_char.beam"
+  "datetime.beam"
+  "echo.beam"
+  "external_proplist_test.beam"
+  "fact.beam"
+  "gen_server_like_test.beam"
+  "guards1.beam"
+  "guards2.beam"
+  "guards3.beam"
+  "guards4.beam"
+  "guards5.beam"
+  "hello_world.beam"
+  "huge.beam"
+  "if_test.beam"
+  "int28mul.beam"
+  "int28mulneg.beam"
+  "int28mulneg2.beam"
+  "is_ref_test.beam"
+  "is_type.beam"
+  "just_receive_test.beam"
+  "len_test.beam"
+  "list_concat.beam"
+  "long_atoms.beam"
+  "lowercase.beam"
+  "make_garbage0.beam"
+  "make_garbage1.beam"
+  "make_garbage2.beam"
+  "make_garbage3.beam"
+  "make_garbage4.beam"
+  "make_garbage5.beam"
+  "make_garbage6.beam"
+  "make_garbage7.beam"
+  "make_ref_test.beam"
+  "makelist_test.beam"
+  "match.beam"
+  "memlimit.beam"
+  "minusone.beam"
+  "minusone2.beam"
+  "moda.beam"
+  "modb.beam"
+  "modc.beam"
+  "moreintegertests.beam"
+  "morelabels.beam"
+  "mutrec.beam"
+  "negatives.beam"
+  "negatives2.beam"
+  "negdiv.beam"
+  "negovf.beam"
+  "nested_list_size0.beam"
+  "nested_list_size1.beam"
+  "nested_list_size2.beam"
+  "nested_list_size3.beam"
+  "nested_list_size4.beam"
+  "nested_tuple_size0.beam"
+  "nested_tuple_size1.beam"
+  "nested_tuple_size2.beam"
+  "nested_tuple_size3.beam"
+  "nested_tuple_size4.beam"
+  "patternmatchfunc.beam"
+  "pingpong.beam"
+  "plusone.beam"
+  "plusone2.beam"
+  "prime.beam"
+  "prime_ext.beam"
+  "register_and_whereis_badarg.beam"
+  "rem_and_comp_test.beam"
+  "selval.beam"
+  "send_receive.beam"
+  "send_to_dead_process.beam"
+  "simple_list_size0.beam"
+  "simple_list_size1.beam"
+  "sleep.beam"
+  "spawn_fun1.beam"
+  "spawn_fun2.beam"
+  "spawn_fun3.beam"
+  "state_test.beam"
+  "state_test2.beam"
+  "state_test2_sender.beam"
+  "state_test3.beam"
+  "state_test3_server.beam"
+  "tagged_tuple_test.beam"
+  "test_abs.beam"
+  "test_apply.beam"
+  "test_apply_last.beam"
+  "test_atom_to_binary.beam"
+  "test_atom_to_list.beam"
+  "test_badarith.beam"
+  "test_badarith2.beam"
+  "test_badarith3.beam"
+  "test_badarith4.beam"
+  "test_bif_badargument.beam"
+  "test_bif_badargument2.beam"
+  "test_bif_badargument3.beam"
+  "test_binary_part.beam"
+  "test_binary_split.beam"
+  "test_binary_to_atom.beam"
+  "test_binary_to_existing_atom.beam"
+  "test_binary_to_list.beam"
+  "test_bitwise.beam"
+  "test_bitwise2.beam"
+  "test_compacting_gc.beam"
+  "test_concat_badarg.beam"
+  "test_delete_element.beam"
+  "test_dirty_file_read.beam"
+  "test_dispatch.beam"
+  "test_display.beam"
+  "test_dynamic_call_cache.beam"
+  "test_echo_driver.beam"
+  "test_element.beam"
+  "test_func_info.beam"
+  "test_func_info2.beam"
+  "test_func_info3.beam"
+  "test_function_profiler.beam"
+  "test_funs0.beam"
+  "test_funs1.beam"
+  "test_funs10.beam"
+  "test_funs11.beam"
+  "test_funs2.beam"
+  "test_funs3.beam"
+  "test_funs4.beam"
+  "test_funs5.beam"
+  "test_funs6.beam"
+  "test_funs7.beam"
+  "test_funs8.beam"
+  "test_funs9.beam"
+  "test_generational_gc.beam"
+  "test_gt_and_le.beam"
+  "test_heap_fragments.beam"
+  "test_heap_growth.beam"
+  "test_heap_pool.beam"
+  "test_incremental_gc.beam"
+  "test_insert_element.beam"
+  "test_integer_to_binary.beam"
+  "test_integer_to_list.beam"
+  "test_is_not_type.beam"
+  "test_is_process_alive.beam"
+  "test_link_on_load.beam"
+  "test_link_on_load_dep.beam"
+  "test_list_gc.beam"
+  "test_list_processes.beam"
+  "test_list_to_atom.beam"
+  "test_list_to_binary.beam"
+  "test_list_to_existing_atom.beam"
+  "test_list_to_integer.beam"
+  "test_literal_area.beam"
+  "test_make_list.beam"
+  "test_make_tuple.beam"
+  "test_message_pool.beam"
+  "test_message_queue_len.beam"
+  "test_min_heap_size.beam"
+  "test_opcode_stats.beam"
+  "test_open_port_badargs.beam"
+  "test_persistent_term.beam"
+  "test_predecoded_operands.beam"
+  "test_process_info.beam"
+  "test_recursion_and_try_catch.beam"
+  "test_recv_mark.beam"
+  "test_reductions.beam"
+  "test_regecho_driver.beam"
+  "test_select_table.beam"
+  "test_selective_receive.beam"
+  "test_send.beam"
+  "test_send_nif_and_echo.beam"
+  "test_set_tuple_element.beam"
+  "test_setelement.beam"
+  "test_shared_copy.beam"
+  "test_superinstructions.beam"
+  "test_system_info.beam"
+  "test_timestamp.beam"
+  "test_tl.beam"
+  "test_try_case_end.beam"
+  "test_tuple_nifs_badargs.beam"
+  "test_tuple_size.beam"
+  "test_tuple_to_list.beam"
+  "test_yielding_nifs.beam"
+  "timestamp.beam"
+  "try_catch_test.beam"
+  "try_noerror.beam"
+  "tuple.beam"
+  "tuple_size0.beam"
+  "tuple_size1.beam"
+  "tuple_size2.beam"
+  "tuple_size3.beam"
+  "tuple_size4.beam"
+  "tuple_size5.beam"
+  "tuple_size6.beam"
+  "tuples_and_list_size0.beam"
+  "tuples_and_list_size1.beam"
+  "tuples_and_list_size2.beam"
+  "whereis_fail.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/erlang_test_modules.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,10 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_eavmlib_lib_beams"
+  "beams/test_logger.beam"
+  "beams/test_timer_manager.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/test_eavmlib_lib_beams.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_estdlib_lib_beams"
+  "beams/test_gen_server.beam"
+  "beams/test_gen_statem.beam"
+  "beams/test_lists.beam"
+  "beams/test_proplists.beam"
+  "beams/test_timer.beam"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/test_estdlib_lib_beams.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
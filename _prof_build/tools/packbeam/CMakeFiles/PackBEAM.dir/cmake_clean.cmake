@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/PackBEAM.dir/packbeam.c.o"
+  "CMakeFiles/PackBEAM.dir/packbeam.c.o.d"
+  "PackBEAM"
+  "PackBEAM.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/PackBEAM.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
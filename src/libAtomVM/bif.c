@@ -133,7 +133,10 @@ term bif_erlang_length_1(Context *ctx, int live, term arg1)
 
     VALIDATE_VALUE(arg1, term_is_list);
 
-    return term_from_int32(term_list_length(arg1));
+    int len = term_list_length(arg1);
+    context_consume_work(ctx, len);
+
+    return term_from_int32(len);
 }
 
 term bif_erlang_hd_1(Context *ctx, term arg1)
@@ -20,6 +20,7 @@
 #include "context.h"
 
 #include "globalcontext.h"
+#include "heappool.h"
 #include "list.h"
 #include "mailbox.h"
 
@@ -39,16 +40,25 @@ Context *context_new(GlobalContext *glb)
     }
     ctx->cp = 0;
 
-    ctx->heap_start = (term *) calloc(DEFAULT_STACK_SIZE, sizeof(term));
+    unsigned long memory_size;
+    ctx->heap_start = heappool_alloc(glb->heap_pool, DEFAULT_STACK_SIZE, &memory_size);
     if (IS_NULL_PTR(ctx->heap_start)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         free(ctx);
         return NULL;
     }
-    ctx->stack_base = ctx->heap_start + DEFAULT_STACK_SIZE;
+    ctx->stack_base = ctx->heap_start + memory_size;
     ctx->e = ctx->stack_base;
     ctx->heap_ptr = ctx->heap_start;
 
+    ctx->old_heap_start = NULL;
+    ctx->old_heap_ptr = NULL;
+    ctx->old_heap_end = NULL;
+    ctx->high_water_mark = ctx->heap_start;
+    ctx->remembered_set = NULL;
+    ctx->remembered_set_count = 0;
+    ctx->remembered_set_size = 0;
+
     ctx->avail_registers = 16;
     context_clean_registers(ctx, 0);
 
@@ -57,9 +67,27 @@ Context *context_new(GlobalContext *glb)
     ctx->has_min_heap_size = 0;
     ctx->has_max_heap_size = 0;
 
+    ctx->fullsweep_after = glb->fullsweep_after;
+    ctx->minor_gcs = 0;
+
+    ctx->heap_growth = glb->heap_growth;
+    ctx->low_occupancy_gcs = 0;
+
+    ctx->compacting_gc_threshold = glb->compacting_gc_threshold;
+
+    ctx->max_gc_pause = glb->max_gc_pause;
+    ctx->incremental_gc = NULL;
+
     list_append(&glb->ready_processes, &ctx->processes_list_head);
 
     ctx->mailbox = NULL;
+    ctx->mailbox_len = 0;
+    ctx->mailbox_bytes = 0;
+    ctx->mailbox_save = NULL;
+    ctx->mailbox_mark = NULL;
+    ctx->mailbox_mark_label = NULL;
+    ctx->heap_fragments = NULL;
+    ctx->heap_fragments_size = 0;
 
     ctx->global = glb;
 
@@ -68,6 +96,14 @@ Context *context_new(GlobalContext *glb)
 
     ctx->native_handler = NULL;
 
+    ctx->reductions = 0;
+    ctx->remaining_reductions = glb->reductions_per_slice;
+    ctx->slice_reductions = glb->reductions_per_slice;
+
+    ctx->trap_nif = NULL;
+    ctx->trap_argc = 0;
+    ctx->trap_cp = 0;
+
     ctx->saved_ip = NULL;
     ctx->jump_to_on_restore = NULL;
 
@@ -84,6 +120,10 @@ Context *context_new(GlobalContext *glb)
         ctx->trace_receive = 0;
     #endif
 
+    #ifdef ENABLE_FUNCTION_PROFILER
+        ctx->function_profile = NULL;
+    #endif
+
     ctx->platform_data = NULL;
 
     return ctx;
@@ -93,46 +133,29 @@ void context_destroy(Context *ctx)
 {
     linkedlist_remove(&ctx->global->processes_table, &ctx->processes_table_head);
 
-    free(ctx->heap_start);
-    free(ctx);
-}
-
-typedef void *(*maibox_iterator)(Message *msg, void *accum);
-
-static void *context_num_messages(Message *msg, void *accum)
-{
-    return (void *) ((size_t) accum + 1);
-}
-
-static void *context_message_size(Message *msg, void *accum)
-{
-    return (void *) (sizeof(Message) + msg->msg_memory_size + (size_t) accum);
-}
+#ifdef ENABLE_FUNCTION_PROFILER
+    functionprofiler_process_destroy(ctx);
+#endif
 
-static void *context_mailbox_iterator(Context *ctx, maibox_iterator fun, void *initial)
-{
-    if (ctx->mailbox == NULL) {
-        return initial;
+    if (ctx->incremental_gc) {
+        memory_cancel_incremental_gc(ctx);
     }
-    Message *messages = GET_LIST_ENTRY(ctx->mailbox, Message, mailbox_list_head);
-    Message *m = messages;
-    void *accum = initial;
-    do {
-        accum = fun(m, accum);
-        m = GET_LIST_ENTRY(m->mailbox_list_head.next, Message, mailbox_list_head);
-    } while (messages != m);
-    return accum;
+    mailbox_destroy(ctx);
+    heappool_free(ctx->global->heap_pool, ctx->old_heap_start, context_old_heap_memory_size(ctx));
+    heappool_free(ctx->global->heap_pool, ctx->heap_start, context_memory_size(ctx));
+    free(ctx->remembered_set);
+    free(ctx);
 }
 
 size_t context_message_queue_len(Context *ctx)
 {
-    return (size_t) context_mailbox_iterator(ctx, context_num_messages, NULL);
+    return ctx->mailbox_len;
 }
 
 size_t context_size(Context *ctx)
 {
     // TODO include ctx->platform_data
     return sizeof(Context)
-        + (size_t) context_mailbox_iterator(ctx, context_message_size, NULL)
-        + context_memory_size(ctx) * BYTES_PER_TERM;
+        + ctx->mailbox_bytes
+        + (context_memory_size(ctx) + context_old_heap_memory_size(ctx)) * BYTES_PER_TERM;
 }
@@ -29,11 +29,16 @@
 
 #include <time.h>
 
+#include "exportedfunction.h"
 #include "linkedlist.h"
 #include "globalcontext.h"
+#include "memory.h"
 #include "term.h"
 
+#define WORK_UNITS_PER_REDUCTION 16
+
 struct Module;
+struct ProcessProfile;
 
 #ifndef TYPEDEF_MODULE
 #define TYPEDEF_MODULE
@@ -57,9 +62,35 @@ struct Context
     term *heap_ptr;
     term *e;
 
+    // old generation, it contains terms that have been promoted by minor garbage collections
+    term *old_heap_start;
+    term *old_heap_ptr;
+    term *old_heap_end;
+    // terms below high_water_mark survived the last garbage collection
+    term *high_water_mark;
+    // old terms that have been written after they have been promoted, they might reference young terms
+    term *remembered_set;
+    int remembered_set_count;
+    int remembered_set_size;
+
     int min_heap_size;
     int max_heap_size;
 
+    // number of minor garbage collections before a major one, 0 disables generational garbage collection
+    int fullsweep_after;
+    int minor_gcs;
+
+    enum HeapGrowthStrategy heap_growth;
+    // consecutive garbage collections that left most of the memory block unused
+    int low_occupancy_gcs;
+
+    // collections of heaps of at least this many terms compact the heap in place instead of copying it
+    unsigned long compacting_gc_threshold;
+
+    // maximum time in microseconds spent by incremental garbage collection in each time slice, 0 disables it
+    int max_gc_pause;
+    struct IncrementalGC *incremental_gc;
+
     unsigned long cp;
 
     //needed for wait and wait_timeout
@@ -68,15 +99,40 @@ struct Context
     const void *jump_to_on_restore;
 
     struct ListHead *mailbox;
+    // number of queued messages and their memory size in bytes, they are kept up to date by mailbox functions
+    size_t mailbox_len;
+    size_t mailbox_bytes;
+    // next queued message that receive is going to match, NULL when all of them have been matched already
+    struct ListHead *mailbox_save;
+    // last message that was queued when recv_mark was executed, the receive at mailbox_mark_label skips it and all
+    // the older ones: it is NULL when the mailbox was empty, mailbox_mark_label is NULL when there is no valid mark
+    struct ListHead *mailbox_mark;
+    const void *mailbox_mark_label;
+
+    // messages that have been removed from the mailbox while the process might still reference their terms in place,
+    // they are released by the next copying collection, that moves live terms to the heap
+    struct ListHead *heap_fragments;
+    // size of heap fragments and of attached messages that are still queued, in term units
+    unsigned long heap_fragments_size;
 
     GlobalContext *global;
 
     //Ports support
     native_handler native_handler;
 
+    // reductions consumed during previous time slices
     uint64_t reductions;
+    // reductions left in the current time slice and its initial length
+    int remaining_reductions;
+    int slice_reductions;
     struct timespec timeout_at;
 
+    // continuation of a NIF that trapped, it is called with trap_argc x registers as arguments when the
+    // process is scheduled again, then execution continues at trap_cp
+    NifImpl trap_nif;
+    int trap_argc;
+    unsigned long trap_cp;
+
     unsigned int leader : 1;
     unsigned int has_min_heap_size : 1;
     unsigned int has_max_heap_size : 1;
@@ -89,6 +145,10 @@ struct Context
         unsigned int trace_receive : 1;
     #endif
 
+    #ifdef ENABLE_FUNCTION_PROFILER
+        struct ProcessProfile *function_profile;
+    #endif
+
     void *platform_data;
 };
 
@@ -178,12 +238,25 @@ static inline unsigned long context_memory_size(const Context *ctx)
 /**
  * @brief Returns context heap size in term units
  *
+ * @details Both young and old heap terms are accounted.
  * @param ctx a valid context.
  * @returns context heap size in term units
  */
 static inline unsigned long context_heap_size(const Context *ctx)
 {
-    return ctx->heap_ptr - ctx->heap_start;
+    return (ctx->heap_ptr - ctx->heap_start) + (ctx->old_heap_ptr - ctx->old_heap_start);
+}
+
+/**
+ * @brief Returns context old heap size in term units
+ *
+ * @details Returns the total memory reserved for the old heap in term units.
+ * @param ctx a valid context.
+ * @returns old heap size in term units
+ */
+static inline unsigned long context_old_heap_memory_size(const Context *ctx)
+{
+    return ctx->old_heap_end - ctx->old_heap_start;
 }
 
 /**
@@ -197,6 +270,29 @@ static inline unsigned long context_stack_size(const Context *ctx)
     return ctx->stack_base - ctx->e;
 }
 
+/**
+ * @brief Records a write to a term that has already been built.
+ *
+ * @details must be called after modifying a term that might have been allocated before the process has been scheduled
+ * out or before a garbage collection, such as a term stored in an x register by a trapping NIF.
+ * @param ctx a valid context.
+ * @param t the modified term, either a boxed term or a list.
+ */
+static inline void context_write_barrier(Context *ctx, term t)
+{
+    if (UNLIKELY(ctx->incremental_gc != NULL)) {
+        memory_record_write(ctx, t);
+    }
+
+    const term *ptr = term_is_boxed(t) ? term_to_const_term_ptr(t) : term_get_list_ptr(t);
+    if ((ptr >= ctx->heap_start) && (ptr < ctx->high_water_mark)) {
+        // the written term is not promoted by next minor collection, so it can reference younger terms
+        ctx->high_water_mark = (term *) ptr;
+    } else if (UNLIKELY((ptr >= ctx->old_heap_start) && (ptr < ctx->old_heap_ptr))) {
+        memory_remember_write(ctx, t);
+    }
+}
+
 /**
  * @brief Checks if a contex is waiting a timeout.
  *
@@ -209,6 +305,81 @@ static inline int context_is_waiting_timeout(const Context *ctx)
     return ctx->timeout_at.tv_sec || ctx->timeout_at.tv_nsec;
 }
 
+/**
+ * @brief Consumes reductions from the current time slice.
+ *
+ * @details BIFs and NIFs call this function to account the work they do, so the calling process is preempted
+ * sooner when a large input is processed.
+ * @param ctx the calling process.
+ * @param reductions the amount of consumed reductions.
+ */
+static inline void context_consume_reductions(Context *ctx, int reductions)
+{
+    ctx->remaining_reductions -= reductions;
+}
+
+/**
+ * @brief Consumes reductions proportional to the given amount of work.
+ *
+ * @details One reduction is consumed every WORK_UNITS_PER_REDUCTION processed items (list elements, bytes or
+ * terms), so small inputs are not charged more than the call itself.
+ * @param ctx the calling process.
+ * @param work_units the number of processed items.
+ */
+static inline void context_consume_work(Context *ctx, unsigned long work_units)
+{
+    context_consume_reductions(ctx, work_units / WORK_UNITS_PER_REDUCTION);
+}
+
+/**
+ * @brief Checks if the current time slice has been used up.
+ *
+ * @details Yielding NIFs check this after each chunk of work to decide if they should trap.
+ * @param ctx the calling process.
+ * @returns 1 if no reductions are left in the current time slice, otherwise 0.
+ */
+static inline int context_time_slice_expired(const Context *ctx)
+{
+    return ctx->remaining_reductions <= 0;
+}
+
+/**
+ * @brief Schedules out the calling process and continues the NIF later.
+ *
+ * @details A NIF that cannot complete its work in the current time slice saves its state as terms and returns
+ * the value returned by this function: the process is scheduled out and continuation is called with the saved
+ * terms as arguments when the process is scheduled again. The value returned by continuation is returned to
+ * the caller of the original NIF, continuation can trap again. State terms are kept in x registers, so they are
+ * preserved by the garbage collector.
+ * @param ctx the calling process.
+ * @param continuation the function that will continue the work.
+ * @param argc the number of state terms, up to 16.
+ * @param argv the state terms.
+ * @returns an invalid term that must be returned by the NIF.
+ */
+static inline term context_trap_nif(Context *ctx, NifImpl continuation, int argc, const term argv[])
+{
+    for (int i = 0; i < argc; i++) {
+        ctx->x[i] = argv[i];
+    }
+    ctx->trap_nif = continuation;
+    ctx->trap_argc = argc;
+
+    return term_invalid_term();
+}
+
+/**
+ * @brief Returns the number of reductions executed by a process.
+ *
+ * @details Reductions consumed in the current time slice are included.
+ * @param ctx a valid context.
+ * @returns the total amount of reductions.
+ */
+static inline uint64_t context_reductions(const Context *ctx)
+{
+    return ctx->reductions + (ctx->slice_reductions - ctx->remaining_reductions);
+}
+
 /**
  * @brief Returns a term representing an atom, from the suppliend string
  *
@@ -227,6 +398,7 @@ static inline term context_make_atom(Context *ctx, AtomString string)
 /**
  * @brief Returns number of messages in the process's mailbox
  *
+ * @details Messages count is cached, so this function does not walk the mailbox.
  * @param ctx a valid context.
  * @returns the number of messages in the process's mailbox
  */
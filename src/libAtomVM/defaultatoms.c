@@ -33,6 +33,28 @@ static const char *const atom_count_atom = "\xA" "atom_count";
 static const char *const system_architecture_atom = "\x13" "system_architecture";
 static const char *const version_atom = "\x7" "version";
 static const char *const wordsize_atom = "\x8" "wordsize";
+static const char *const opcode_stats_atom = "\xC" "opcode_stats";
+static const char *const opcode_pair_stats_atom = "\x11" "opcode_pair_stats";
+static const char *const function_profiler_atom = "\x11" "function_profiler";
+static const char *const function_profile_atom = "\x10" "function_profile";
+static const char *const reductions_atom = "\xA" "reductions";
+static const char *const reductions_per_slice_atom = "\x14" "reductions_per_slice";
+static const char *const fullsweep_after_atom = "\xF" "fullsweep_after";
+static const char *const minor_gcs_atom = "\x9" "minor_gcs";
+static const char *const garbage_collection_atom = "\x12" "garbage_collection";
+static const char *const heap_growth_atom = "\xB" "heap_growth";
+static const char *const minimum_atom = "\x7" "minimum";
+static const char *const fibonacci_atom = "\x9" "fibonacci";
+static const char *const heap_pool_atom = "\x9" "heap_pool";
+static const char *const live_words_atom = "\xA" "live_words";
+static const char *const cached_words_atom = "\xC" "cached_words";
+static const char *const fragmentation_atom = "\xD" "fragmentation";
+static const char *const allocs_atom = "\x6" "allocs";
+static const char *const pool_hits_atom = "\x9" "pool_hits";
+static const char *const classes_atom = "\x7" "classes";
+static const char *const compacting_gc_threshold_atom = "\x17" "compacting_gc_threshold";
+static const char *const max_gc_pause_atom = "\xC" "max_gc_pause";
+static const char *const message_pool_atom = "\xC" "message_pool";
 
 void defaultatoms_init(GlobalContext *glb)
 {
@@ -69,6 +91,28 @@ void defaultatoms_init(GlobalContext *glb)
     ok &= globalcontext_insert_atom(glb, atom_count_atom) == ATOM_COUNT_ATOM_INDEX;
     ok &= globalcontext_insert_atom(glb, system_architecture_atom) == SYSTEM_ARCHITECTURE_ATOM_INDEX;
     ok &= globalcontext_insert_atom(glb, wordsize_atom) == WORDSIZE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, opcode_stats_atom) == OPCODE_STATS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, opcode_pair_stats_atom) == OPCODE_PAIR_STATS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, function_profiler_atom) == FUNCTION_PROFILER_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, function_profile_atom) == FUNCTION_PROFILE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, reductions_atom) == REDUCTIONS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, reductions_per_slice_atom) == REDUCTIONS_PER_SLICE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, fullsweep_after_atom) == FULLSWEEP_AFTER_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, minor_gcs_atom) == MINOR_GCS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, garbage_collection_atom) == GARBAGE_COLLECTION_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, heap_growth_atom) == HEAP_GROWTH_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, minimum_atom) == MINIMUM_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, fibonacci_atom) == FIBONACCI_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, heap_pool_atom) == HEAP_POOL_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, live_words_atom) == LIVE_WORDS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, cached_words_atom) == CACHED_WORDS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, fragmentation_atom) == FRAGMENTATION_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, allocs_atom) == ALLOCS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, pool_hits_atom) == POOL_HITS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, classes_atom) == CLASSES_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, compacting_gc_threshold_atom) == COMPACTING_GC_THRESHOLD_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, max_gc_pause_atom) == MAX_GC_PAUSE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, message_pool_atom) == MESSAGE_POOL_ATOM_INDEX;
 
     if (!ok) {
         abort();
@@ -54,8 +54,30 @@
 #define ATOM_COUNT_ATOM_INDEX 24
 #define SYSTEM_ARCHITECTURE_ATOM_INDEX 25
 #define WORDSIZE_ATOM_INDEX 26
-
-#define PLATFORM_ATOMS_BASE_INDEX 27
+#define OPCODE_STATS_ATOM_INDEX 27
+#define OPCODE_PAIR_STATS_ATOM_INDEX 28
+#define FUNCTION_PROFILER_ATOM_INDEX 29
+#define FUNCTION_PROFILE_ATOM_INDEX 30
+#define REDUCTIONS_ATOM_INDEX 31
+#define REDUCTIONS_PER_SLICE_ATOM_INDEX 32
+#define FULLSWEEP_AFTER_ATOM_INDEX 33
+#define MINOR_GCS_ATOM_INDEX 34
+#define GARBAGE_COLLECTION_ATOM_INDEX 35
+#define HEAP_GROWTH_ATOM_INDEX 36
+#define MINIMUM_ATOM_INDEX 37
+#define FIBONACCI_ATOM_INDEX 38
+#define HEAP_POOL_ATOM_INDEX 39
+#define LIVE_WORDS_ATOM_INDEX 40
+#define CACHED_WORDS_ATOM_INDEX 41
+#define FRAGMENTATION_ATOM_INDEX 42
+#define ALLOCS_ATOM_INDEX 43
+#define POOL_HITS_ATOM_INDEX 44
+#define CLASSES_ATOM_INDEX 45
+#define COMPACTING_GC_THRESHOLD_ATOM_INDEX 46
+#define MAX_GC_PAUSE_ATOM_INDEX 47
+#define MESSAGE_POOL_ATOM_INDEX 48
+
+#define PLATFORM_ATOMS_BASE_INDEX 49
 
 #define FALSE_ATOM term_from_atom_index(FALSE_ATOM_INDEX)
 #define TRUE_ATOM term_from_atom_index(TRUE_ATOM_INDEX)
@@ -89,6 +111,28 @@
 #define ATOM_COUNT_ATOM term_from_atom_index(ATOM_COUNT_ATOM_INDEX)
 #define SYSTEM_ARCHITECTURE_ATOM term_from_atom_index(SYSTEM_ARCHITECTURE_ATOM_INDEX)
 #define WORDSIZE_ATOM term_from_atom_index(WORDSIZE_ATOM_INDEX)
+#define OPCODE_STATS_ATOM term_from_atom_index(OPCODE_STATS_ATOM_INDEX)
+#define OPCODE_PAIR_STATS_ATOM term_from_atom_index(OPCODE_PAIR_STATS_ATOM_INDEX)
+#define FUNCTION_PROFILER_ATOM term_from_atom_index(FUNCTION_PROFILER_ATOM_INDEX)
+#define FUNCTION_PROFILE_ATOM term_from_atom_index(FUNCTION_PROFILE_ATOM_INDEX)
+#define REDUCTIONS_ATOM term_from_atom_index(REDUCTIONS_ATOM_INDEX)
+#define REDUCTIONS_PER_SLICE_ATOM term_from_atom_index(REDUCTIONS_PER_SLICE_ATOM_INDEX)
+#define FULLSWEEP_AFTER_ATOM term_from_atom_index(FULLSWEEP_AFTER_ATOM_INDEX)
+#define MINOR_GCS_ATOM term_from_atom_index(MINOR_GCS_ATOM_INDEX)
+#define GARBAGE_COLLECTION_ATOM term_from_atom_index(GARBAGE_COLLECTION_ATOM_INDEX)
+#define HEAP_GROWTH_ATOM term_from_atom_index(HEAP_GROWTH_ATOM_INDEX)
+#define MINIMUM_ATOM term_from_atom_index(MINIMUM_ATOM_INDEX)
+#define FIBONACCI_ATOM term_from_atom_index(FIBONACCI_ATOM_INDEX)
+#define HEAP_POOL_ATOM term_from_atom_index(HEAP_POOL_ATOM_INDEX)
+#define LIVE_WORDS_ATOM term_from_atom_index(LIVE_WORDS_ATOM_INDEX)
+#define CACHED_WORDS_ATOM term_from_atom_index(CACHED_WORDS_ATOM_INDEX)
+#define FRAGMENTATION_ATOM term_from_atom_index(FRAGMENTATION_ATOM_INDEX)
+#define ALLOCS_ATOM term_from_atom_index(ALLOCS_ATOM_INDEX)
+#define POOL_HITS_ATOM term_from_atom_index(POOL_HITS_ATOM_INDEX)
+#define CLASSES_ATOM term_from_atom_index(CLASSES_ATOM_INDEX)
+#define COMPACTING_GC_THRESHOLD_ATOM term_from_atom_index(COMPACTING_GC_THRESHOLD_ATOM_INDEX)
+#define MAX_GC_PAUSE_ATOM term_from_atom_index(MAX_GC_PAUSE_ATOM_INDEX)
+#define MESSAGE_POOL_ATOM term_from_atom_index(MESSAGE_POOL_ATOM_INDEX)
 
 void defaultatoms_init(GlobalContext *glb);
 
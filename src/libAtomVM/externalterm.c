@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "utils.h"
 
@@ -37,10 +38,10 @@
 #define LIST_EXT 108
 #define BINARY_EXT 109
 
-static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_size, Context *ctx);
-static int calculate_heap_usage(const uint8_t *external_term_buf, int *eterm_size, Context *ctx);
+static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_size, term **heap_ptr, GlobalContext *glb);
+static int calculate_heap_usage(const uint8_t *external_term_buf, int *eterm_size);
 
-term externalterm_to_term(const void *external_term, Context *ctx)
+static inline const uint8_t *external_term_data(const void *external_term)
 {
     const uint8_t *external_term_buf = (const uint8_t *) external_term;
 
@@ -49,8 +50,32 @@ term externalterm_to_term(const void *external_term, Context *ctx)
         abort();
     }
 
+    return external_term_buf + 1;
+}
+
+static inline term *heap_alloc(term **heap_ptr, int size)
+{
+    term *allocated = *heap_ptr;
+    *heap_ptr += size;
+
+    return allocated;
+}
+
+int externalterm_heap_usage(const void *external_term)
+{
     int eterm_size;
-    int heap_usage = calculate_heap_usage(external_term_buf + 1, &eterm_size, ctx);
+    return calculate_heap_usage(external_term_data(external_term), &eterm_size);
+}
+
+term externalterm_to_term_in_heap(const void *external_term, term **heap_ptr, GlobalContext *glb)
+{
+    int eterm_size;
+    return parse_external_terms(external_term_data(external_term), &eterm_size, heap_ptr, glb);
+}
+
+term externalterm_to_term(const void *external_term, Context *ctx)
+{
+    int heap_usage = externalterm_heap_usage(external_term);
     switch (memory_ensure_free(ctx, heap_usage)) {
         case MEMORY_GC_OK:
             break;
@@ -64,10 +89,10 @@ term externalterm_to_term(const void *external_term, Context *ctx)
             abort();
     }
 
-    return parse_external_terms(external_term_buf + 1, &eterm_size, ctx);
+    return externalterm_to_term_in_heap(external_term, &ctx->heap_ptr, ctx->global);
 }
 
-static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_size, Context *ctx)
+static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_size, term **heap_ptr, GlobalContext *glb)
 {
     switch (external_term_buf[0]) {
         case SMALL_INTEGER_EXT: {
@@ -85,7 +110,7 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
         case ATOM_EXT: {
             uint16_t atom_len = READ_16_UNALIGNED(external_term_buf + 1);
 
-            int global_atom_id = globalcontext_insert_atom(ctx->global, (AtomString) (external_term_buf + 2));
+            int global_atom_id = globalcontext_insert_atom(glb, (AtomString) (external_term_buf + 2));
 
             *eterm_size = 3 + atom_len;
             return term_from_atom_index(global_atom_id);
@@ -93,13 +118,15 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
 
         case SMALL_TUPLE_EXT: {
             uint8_t arity = external_term_buf[1];
-            term tuple = term_alloc_tuple(arity, ctx);
+            term *boxed_value = heap_alloc(heap_ptr, 1 + arity);
+            boxed_value[0] = (arity << 6) | TERM_BOXED_TUPLE;
+            term tuple = ((term) boxed_value) | TERM_BOXED_VALUE_TAG;
 
             int buf_pos = 2;
 
             for (int i = 0; i < arity; i++) {
                 int element_size;
-                term put_value = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx);
+                term put_value = parse_external_terms(external_term_buf + buf_pos, &element_size, heap_ptr, glb);
                 term_put_tuple_element(tuple, i, put_value);
 
                 buf_pos += element_size;
@@ -117,7 +144,14 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
         case STRING_EXT: {
             uint16_t string_size = READ_16_UNALIGNED(external_term_buf + 1);
             *eterm_size = 3 + string_size;
-            return term_from_string((uint8_t *) external_term_buf + 3, string_size, ctx);
+
+            term *list_cells = heap_alloc(heap_ptr, string_size * 2);
+            for (int i = 0; i < string_size; i++) {
+                term tail = (i == string_size - 1) ? term_nil() : term_list_from_list_ptr(list_cells + (i + 1) * 2);
+                term_list_init_prepend(list_cells + i * 2, term_from_int11(external_term_buf[3 + i]), tail);
+            }
+
+            return term_list_from_list_ptr(list_cells);
         }
 
         case LIST_EXT: {
@@ -130,9 +164,9 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
 
             for (unsigned int i = 0; i < list_len; i++) {
                 int item_size;
-                term head = parse_external_terms(external_term_buf + buf_pos, &item_size, ctx);
+                term head = parse_external_terms(external_term_buf + buf_pos, &item_size, heap_ptr, glb);
 
-                term *new_list_item = term_list_alloc(ctx);
+                term *new_list_item = heap_alloc(heap_ptr, 2);
 
                 if (prev_term) {
                     prev_term[0] = term_list_from_list_ptr(new_list_item);
@@ -148,7 +182,7 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
 
             if (prev_term) {
                 int tail_size;
-                term tail = parse_external_terms(external_term_buf + buf_pos, &tail_size, ctx);
+                term tail = parse_external_terms(external_term_buf + buf_pos, &tail_size, heap_ptr, glb);
                 if (tail != term_nil()) {
                     //TODO: add support for imporper lists
                     abort();
@@ -165,7 +199,14 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
         case BINARY_EXT: {
             uint32_t binary_size = READ_32_UNALIGNED(external_term_buf + 1);
             *eterm_size = 5 + binary_size;
-            return term_from_literal_binary((uint8_t *) external_term_buf + 5, binary_size, ctx);
+
+            int size_in_terms = term_binary_data_size_in_terms(binary_size);
+            term *boxed_value = heap_alloc(heap_ptr, size_in_terms + 1);
+            boxed_value[0] = (size_in_terms << 6) | TERM_BOXED_HEAP_BINARY;
+            boxed_value[1] = binary_size;
+            memcpy(boxed_value + 2, external_term_buf + 5, binary_size);
+
+            return ((term) boxed_value) | TERM_BOXED_VALUE_TAG;
         }
 
         default:
@@ -174,7 +215,7 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
     }
 }
 
-static int calculate_heap_usage(const uint8_t *external_term_buf, int *eterm_size, Context *ctx)
+static int calculate_heap_usage(const uint8_t *external_term_buf, int *eterm_size)
 {
     switch (external_term_buf[0]) {
         case SMALL_INTEGER_EXT: {
@@ -201,7 +242,7 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, int *eterm_siz
 
             for (int i = 0; i < arity; i++) {
                 int element_size;
-                heap_usage += calculate_heap_usage(external_term_buf + buf_pos, &element_size, ctx) + 1;
+                heap_usage += calculate_heap_usage(external_term_buf + buf_pos, &element_size) + 1;
 
                 buf_pos += element_size;
             }
@@ -229,13 +270,13 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, int *eterm_siz
 
             for (unsigned int i = 0; i < list_len; i++) {
                 int item_size;
-                heap_usage += calculate_heap_usage(external_term_buf + buf_pos, &item_size, ctx) + 2;
+                heap_usage += calculate_heap_usage(external_term_buf + buf_pos, &item_size) + 2;
 
                 buf_pos += item_size;
             }
 
             int tail_size;
-            heap_usage += calculate_heap_usage(external_term_buf + buf_pos, &tail_size, ctx);
+            heap_usage += calculate_heap_usage(external_term_buf + buf_pos, &tail_size);
             buf_pos += tail_size;
 
             *eterm_size = buf_pos;
@@ -27,6 +27,7 @@
 #ifndef _EXTERNALTERM_H_
 #define _EXTERNALTERM_H_
 
+#include "globalcontext.h"
 #include "term.h"
 
 /**
@@ -39,4 +40,23 @@
  */
 term externalterm_to_term(const void *external_term, Context *ctx);
 
+/**
+ * @brief Gets the memory required to deserialize external term data.
+ *
+ * @param external_term the external term that will be deserialized.
+ * @returns the number of terms that externalterm_to_term_in_heap will allocate.
+ */
+int externalterm_heap_usage(const void *external_term);
+
+/**
+ * @brief Gets a term from external term data using the given memory.
+ *
+ * @details Deserialize an external term to a memory area that is not a process heap, such as a module literal area.
+ * @param external_term the external term that will be deserialized.
+ * @param heap_ptr pointer to the memory that will be used, it is advanced by the number of allocated terms.
+ * @param glb the global context, used to insert atoms.
+ * @returns a term.
+ */
+term externalterm_to_term_in_heap(const void *external_term, term **heap_ptr, GlobalContext *glb);
+
 #endif
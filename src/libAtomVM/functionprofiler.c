@@ -0,0 +1,470 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "functionprofiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "context.h"
+#include "memory.h"
+#include "module.h"
+#include "utils.h"
+
+#define INITIAL_FRAMES_CAPACITY 16
+
+struct FunctionProfileEntry
+{
+    term module_atom;
+    term function_atom;
+    int arity;
+    uint64_t calls;
+    uint64_t own_time;
+    uint64_t total_time;
+};
+
+static uint64_t functionprofiler_timestamp()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline int module_imports_count(const Module *mod)
+{
+    const uint8_t *table_data = (const uint8_t *) mod->import_table;
+    return READ_32_ALIGNED(table_data + 8);
+}
+
+// returns the index of the function that contains the given instruction, functions are sorted by offset
+static int module_function_index(const Module *mod, unsigned int instruction_ii)
+{
+    int low = 0;
+    int high = mod->functions_count - 1;
+    int found = -1;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (mod->function_offsets[middle] <= instruction_ii) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return found;
+}
+
+static struct FunctionProfile *module_function_profile(Module *mod, const void *address)
+{
+    if (IS_NULL_PTR(mod->function_profiles)) {
+        if (!mod->functions_count) {
+            return NULL;
+        }
+        mod->function_profiles = calloc(mod->functions_count, sizeof(struct FunctionProfile));
+        if (IS_NULL_PTR(mod->function_profiles)) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            return NULL;
+        }
+    }
+
+    int index = module_function_index(mod, ((const term *) address) - mod->instructions);
+    if (UNLIKELY(index < 0)) {
+        return NULL;
+    }
+
+    return &mod->function_profiles[index];
+}
+
+static struct FunctionProfile *module_import_profile(Module *mod, int import_index)
+{
+    if (IS_NULL_PTR(mod->import_profiles)) {
+        mod->import_profiles = calloc(module_imports_count(mod), sizeof(struct FunctionProfile));
+        if (IS_NULL_PTR(mod->import_profiles)) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            return NULL;
+        }
+    }
+
+    return &mod->import_profiles[import_index];
+}
+
+static struct FunctionProfile *return_address_profile(const Context *ctx)
+{
+    if ((long) ctx->cp == -1) {
+        return NULL;
+    }
+
+    Module *mod = ctx->global->modules_by_index[ctx->cp >> 24];
+    return module_function_profile(mod, &mod->instructions[(ctx->cp & 0xFFFFFF) >> 2]);
+}
+
+static inline int stack_depth(const Context *ctx)
+{
+    return ctx->stack_base - ctx->e;
+}
+
+// gets process profiling state, it is reset when it belongs to a previous profiling session
+static struct ProcessProfile *process_profile(Context *ctx)
+{
+    struct ProcessProfile *state = ctx->function_profile;
+
+    if (IS_NULL_PTR(state)) {
+        state = calloc(1, sizeof(struct ProcessProfile));
+        if (IS_NULL_PTR(state)) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            return NULL;
+        }
+        state->generation = ctx->global->function_profiler_generation - 1;
+        ctx->function_profile = state;
+    }
+
+    if (state->generation != ctx->global->function_profiler_generation) {
+        state->generation = ctx->global->function_profiler_generation;
+        state->clock = 0;
+        state->last_timestamp = functionprofiler_timestamp();
+        state->current = NULL;
+        state->frames_count = 0;
+    }
+
+    return state;
+}
+
+static void process_profile_flush(struct ProcessProfile *state)
+{
+    uint64_t timestamp = functionprofiler_timestamp();
+    uint64_t elapsed = timestamp - state->last_timestamp;
+
+    state->clock += elapsed;
+    state->last_timestamp = timestamp;
+    if (state->current) {
+        state->current->own_time += elapsed;
+    }
+}
+
+static void process_profile_push(struct ProcessProfile *state, struct FunctionProfile *profile, int depth)
+{
+    if (state->frames_count == state->frames_capacity) {
+        int new_capacity = state->frames_capacity ? state->frames_capacity * 2 : INITIAL_FRAMES_CAPACITY;
+        struct FunctionProfilerFrame *new_frames = realloc(state->frames, new_capacity * sizeof(struct FunctionProfilerFrame));
+        if (IS_NULL_PTR(new_frames)) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            return;
+        }
+        state->frames = new_frames;
+        state->frames_capacity = new_capacity;
+    }
+
+    struct FunctionProfilerFrame *frame = &state->frames[state->frames_count];
+    frame->profile = profile;
+    frame->start_clock = state->clock;
+    frame->stack_depth = depth;
+    state->frames_count++;
+
+    profile->active_frames++;
+}
+
+static void process_profile_pop(struct ProcessProfile *state)
+{
+    state->frames_count--;
+    struct FunctionProfilerFrame *frame = &state->frames[state->frames_count];
+
+    // recursive calls are accounted just once into total time
+    frame->profile->active_frames--;
+    if (!frame->profile->active_frames) {
+        frame->profile->total_time += state->clock - frame->start_clock;
+    }
+}
+
+int functionprofiler_set_enabled(GlobalContext *glb, int enabled)
+{
+    int was_enabled = glb->function_profiler_enabled;
+
+    if (enabled && !was_enabled) {
+        glb->function_profiler_generation++;
+
+        for (int i = 0; i < glb->loaded_modules_count; i++) {
+            Module *mod = glb->modules_by_index[i];
+            if (mod->function_profiles) {
+                memset(mod->function_profiles, 0, mod->functions_count * sizeof(struct FunctionProfile));
+            }
+            if (mod->import_profiles) {
+                memset(mod->import_profiles, 0, module_imports_count(mod) * sizeof(struct FunctionProfile));
+            }
+        }
+    }
+    glb->function_profiler_enabled = enabled;
+
+    return was_enabled;
+}
+
+void functionprofiler_call(Context *ctx, Module *target_mod, const void *target_address)
+{
+    struct ProcessProfile *state = process_profile(ctx);
+    if (IS_NULL_PTR(state)) {
+        return;
+    }
+    process_profile_flush(state);
+
+    struct FunctionProfile *profile = module_function_profile(target_mod, target_address);
+    if (IS_NULL_PTR(profile)) {
+        return;
+    }
+    profile->calls++;
+    process_profile_push(state, profile, stack_depth(ctx));
+    state->current = profile;
+}
+
+void functionprofiler_tail_call(Context *ctx, Module *target_mod, const void *target_address)
+{
+    struct ProcessProfile *state = process_profile(ctx);
+    if (IS_NULL_PTR(state)) {
+        return;
+    }
+    process_profile_flush(state);
+
+    struct FunctionProfile *profile = module_function_profile(target_mod, target_address);
+    if (IS_NULL_PTR(profile)) {
+        return;
+    }
+    profile->calls++;
+
+    // the called function will return to the caller of the current one, so it takes its place
+    int depth = stack_depth(ctx);
+    if (state->frames_count) {
+        depth = state->frames[state->frames_count - 1].stack_depth;
+        process_profile_pop(state);
+    }
+    process_profile_push(state, profile, depth);
+    state->current = profile;
+}
+
+void functionprofiler_return(Context *ctx)
+{
+    struct ProcessProfile *state = process_profile(ctx);
+    if (IS_NULL_PTR(state)) {
+        return;
+    }
+    process_profile_flush(state);
+
+    if (state->frames_count) {
+        process_profile_pop(state);
+    }
+    state->current = return_address_profile(ctx);
+}
+
+void functionprofiler_native_begin(Context *ctx)
+{
+    struct ProcessProfile *state = process_profile(ctx);
+    if (IS_NULL_PTR(state)) {
+        return;
+    }
+    process_profile_flush(state);
+}
+
+void functionprofiler_native_end(Context *ctx, Module *mod, int import_index)
+{
+    struct ProcessProfile *state = process_profile(ctx);
+    if (IS_NULL_PTR(state)) {
+        return;
+    }
+
+    uint64_t timestamp = functionprofiler_timestamp();
+    uint64_t elapsed = timestamp - state->last_timestamp;
+    state->clock += elapsed;
+    state->last_timestamp = timestamp;
+
+    struct FunctionProfile *profile = module_import_profile(mod, import_index);
+    if (IS_NULL_PTR(profile)) {
+        return;
+    }
+    profile->calls++;
+    profile->own_time += elapsed;
+    profile->total_time += elapsed;
+}
+
+void functionprofiler_exception(Context *ctx, Module *mod, const void *catch_address)
+{
+    struct ProcessProfile *state = process_profile(ctx);
+    if (IS_NULL_PTR(state)) {
+        return;
+    }
+    process_profile_flush(state);
+
+    // drop all functions called from the catching one, they will not return
+    int depth = stack_depth(ctx);
+    while (state->frames_count && (state->frames[state->frames_count - 1].stack_depth >= depth)) {
+        process_profile_pop(state);
+    }
+    state->current = module_function_profile(mod, catch_address);
+}
+
+void functionprofiler_schedule_out(Context *ctx)
+{
+    struct ProcessProfile *state = ctx->function_profile;
+    if (state && (state->generation == ctx->global->function_profiler_generation)) {
+        process_profile_flush(state);
+    }
+}
+
+void functionprofiler_schedule_in(Context *ctx)
+{
+    struct ProcessProfile *state = ctx->function_profile;
+    if (state && (state->generation == ctx->global->function_profiler_generation)) {
+        state->last_timestamp = functionprofiler_timestamp();
+    }
+}
+
+void functionprofiler_process_destroy(Context *ctx)
+{
+    struct ProcessProfile *state = ctx->function_profile;
+    if (state) {
+        free(state->frames);
+        free(state);
+    }
+}
+
+void functionprofiler_module_destroy(Module *mod)
+{
+    free(mod->function_profiles);
+    free(mod->import_profiles);
+}
+
+static int entry_compare(const void *a, const void *b)
+{
+    const struct FunctionProfileEntry *entry_a = a;
+    const struct FunctionProfileEntry *entry_b = b;
+
+    if (entry_a->module_atom != entry_b->module_atom) {
+        return (entry_a->module_atom > entry_b->module_atom) - (entry_a->module_atom < entry_b->module_atom);
+    }
+    if (entry_a->function_atom != entry_b->function_atom) {
+        return (entry_a->function_atom > entry_b->function_atom) - (entry_a->function_atom < entry_b->function_atom);
+    }
+    return entry_a->arity - entry_b->arity;
+}
+
+static void entry_set_profile(struct FunctionProfileEntry *entry, const struct FunctionProfile *profile)
+{
+    entry->calls = profile->calls;
+    entry->own_time = profile->own_time;
+    entry->total_time = profile->total_time;
+}
+
+static int collect_entries(const GlobalContext *glb, struct FunctionProfileEntry *entries)
+{
+    int count = 0;
+
+    for (int i = 0; i < glb->loaded_modules_count; i++) {
+        const Module *mod = glb->modules_by_index[i];
+
+        if (mod->function_profiles) {
+            for (int j = 0; j < mod->functions_count; j++) {
+                if (!mod->function_profiles[j].calls) {
+                    continue;
+                }
+                if (entries) {
+                    // func_info operands: module atom, function atom and arity
+                    const term *func_info = &mod->instructions[mod->function_offsets[j]];
+                    entries[count].module_atom = func_info[1];
+                    entries[count].function_atom = func_info[2];
+                    entries[count].arity = func_info[3];
+                    entry_set_profile(&entries[count], &mod->function_profiles[j]);
+                }
+                count++;
+            }
+        }
+
+        if (mod->import_profiles) {
+            const uint8_t *table_data = (const uint8_t *) mod->import_table;
+            int imports_count = module_imports_count(mod);
+            for (int j = 0; j < imports_count; j++) {
+                if (!mod->import_profiles[j].calls) {
+                    continue;
+                }
+                if (entries) {
+                    entries[count].module_atom = module_get_atom_term_by_id(mod, READ_32_ALIGNED(table_data + j * 12 + 12));
+                    entries[count].function_atom = module_get_atom_term_by_id(mod, READ_32_ALIGNED(table_data + j * 12 + 4 + 12));
+                    entries[count].arity = READ_32_ALIGNED(table_data + j * 12 + 8 + 12);
+                    entry_set_profile(&entries[count], &mod->import_profiles[j]);
+                }
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+term functionprofiler_to_term(Context *ctx)
+{
+    int count = collect_entries(ctx->global, NULL);
+    if (!count) {
+        return term_nil();
+    }
+
+    struct FunctionProfileEntry *entries = malloc(count * sizeof(struct FunctionProfileEntry));
+    if (IS_NULL_PTR(entries)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        return term_invalid_term();
+    }
+    collect_entries(ctx->global, entries);
+
+    // the same BIF or NIF is imported by several modules, so entries are merged
+    qsort(entries, count, sizeof(struct FunctionProfileEntry), entry_compare);
+    int merged_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (merged_count && !entry_compare(&entries[merged_count - 1], &entries[i])) {
+            entries[merged_count - 1].calls += entries[i].calls;
+            entries[merged_count - 1].own_time += entries[i].own_time;
+            entries[merged_count - 1].total_time += entries[i].total_time;
+        } else {
+            entries[merged_count] = entries[i];
+            merged_count++;
+        }
+    }
+
+    if (UNLIKELY(memory_ensure_free(ctx, merged_count * (4 + 5 + 2)) != MEMORY_GC_OK)) {
+        free(entries);
+        return term_invalid_term();
+    }
+
+    term list = term_nil();
+    for (int i = merged_count - 1; i >= 0; i--) {
+        term mfa = term_alloc_tuple(3, ctx);
+        term_put_tuple_element(mfa, 0, entries[i].module_atom);
+        term_put_tuple_element(mfa, 1, entries[i].function_atom);
+        term_put_tuple_element(mfa, 2, term_from_int32(entries[i].arity));
+
+        term profile_tuple = term_alloc_tuple(4, ctx);
+        term_put_tuple_element(profile_tuple, 0, mfa);
+        term_put_tuple_element(profile_tuple, 1, term_from_counter(entries[i].calls));
+        term_put_tuple_element(profile_tuple, 2, term_from_counter(entries[i].own_time / 1000));
+        term_put_tuple_element(profile_tuple, 3, term_from_counter(entries[i].total_time / 1000));
+        list = term_list_prepend(profile_tuple, list, ctx);
+    }
+
+    free(entries);
+
+    return list;
+}
@@ -0,0 +1,182 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+/**
+ * @file functionprofiler.h
+ * @brief Per function call counters and timers.
+ *
+ * @details When AtomVM is built with ENABLE_FUNCTION_PROFILER the execute loop can account calls, own (exclusive)
+ * time and total (inclusive) time of each function. The profiler is disabled by default and it is toggled at
+ * runtime using erlang:system_flag(function_profiler, true | false), collected data can be retrieved using
+ * erlang:system_info(function_profile). BIFs and NIFs are accounted per import table entry, so they are profiled as
+ * well even if they do not have any code.
+ */
+
+#ifndef _FUNCTIONPROFILER_H_
+#define _FUNCTIONPROFILER_H_
+
+#include <stdint.h>
+
+#include "globalcontext.h"
+#include "term.h"
+
+#ifndef TYPEDEF_CONTEXT
+#define TYPEDEF_CONTEXT
+typedef struct Context Context;
+#endif
+
+#ifndef TYPEDEF_MODULE
+#define TYPEDEF_MODULE
+typedef struct Module Module;
+#endif
+
+struct FunctionProfile
+{
+    uint64_t calls;
+    uint64_t own_time;
+    uint64_t total_time;
+
+    // number of activations on all process stacks, total time is accounted only when the outermost one ends
+    int active_frames;
+};
+
+struct FunctionProfilerFrame
+{
+    struct FunctionProfile *profile;
+    uint64_t start_clock;
+    int stack_depth;
+};
+
+struct ProcessProfile
+{
+    unsigned int generation;
+
+    // time spent running by the process, it doesn't advance while the process is scheduled out
+    uint64_t clock;
+    uint64_t last_timestamp;
+
+    struct FunctionProfile *current;
+
+    struct FunctionProfilerFrame *frames;
+    int frames_count;
+    int frames_capacity;
+};
+
+/**
+ * @brief Enables or disables the function profiler.
+ *
+ * @details Collected data is cleared each time the profiler is enabled.
+ * @param glb the global context.
+ * @param enabled 1 to enable the profiler, 0 to disable it.
+ * @returns 1 if the profiler was enabled before this call, otherwise 0.
+ */
+int functionprofiler_set_enabled(GlobalContext *glb, int enabled);
+
+/**
+ * @brief Accounts a function call.
+ *
+ * @details Called before jumping to a function using call, call_ext, apply and call_fun.
+ * @param ctx the calling process.
+ * @param target_mod the module of the called function.
+ * @param target_address the called function entry point.
+ */
+void functionprofiler_call(Context *ctx, Module *target_mod, const void *target_address);
+
+/**
+ * @brief Accounts a tail call.
+ *
+ * @details Same as functionprofiler_call, but the called function replaces the current one on the profiler stack.
+ * @param ctx the calling process.
+ * @param target_mod the module of the called function.
+ * @param target_address the called function entry point.
+ */
+void functionprofiler_tail_call(Context *ctx, Module *target_mod, const void *target_address);
+
+/**
+ * @brief Accounts a return to ctx->cp.
+ *
+ * @param ctx the returning process.
+ */
+void functionprofiler_return(Context *ctx);
+
+/**
+ * @brief Accounts time spent so far to the current function before calling a BIF or a NIF.
+ *
+ * @param ctx the calling process.
+ */
+void functionprofiler_native_begin(Context *ctx);
+
+/**
+ * @brief Accounts a BIF or a NIF call.
+ *
+ * @details Time elapsed since functionprofiler_native_begin is accounted to the called BIF or NIF.
+ * @param ctx the calling process.
+ * @param mod the calling module.
+ * @param import_index the import table index of the called BIF or NIF.
+ */
+void functionprofiler_native_end(Context *ctx, Module *mod, int import_index);
+
+/**
+ * @brief Unwinds profiler stack after an exception has been caught.
+ *
+ * @details Must be called after ctx->e has been restored to the catching frame.
+ * @param ctx the process that caught the exception.
+ * @param mod the module of the catch handler.
+ * @param catch_address the catch handler address.
+ */
+void functionprofiler_exception(Context *ctx, Module *mod, const void *catch_address);
+
+/**
+ * @brief Stops accounting time to a process that is going to be scheduled out.
+ *
+ * @param ctx the process that is scheduled out.
+ */
+void functionprofiler_schedule_out(Context *ctx);
+
+/**
+ * @brief Resumes accounting time to a process that has been scheduled in.
+ *
+ * @param ctx the process that is scheduled in.
+ */
+void functionprofiler_schedule_in(Context *ctx);
+
+/**
+ * @brief Frees profiler data attached to a process.
+ *
+ * @param ctx the process that is going to be destroyed.
+ */
+void functionprofiler_process_destroy(Context *ctx);
+
+/**
+ * @brief Frees profiler data attached to a module.
+ *
+ * @param mod the module that is going to be destroyed.
+ */
+void functionprofiler_module_destroy(Module *mod);
+
+/**
+ * @brief Makes a list with collected profile data.
+ *
+ * @details Returns a list of {{Module, Function, Arity}, Calls, OwnTime, TotalTime} tuples, times are in microseconds.
+ * @param ctx the context that owns the returned list.
+ * @returns the list or an invalid term if memory cannot be allocated.
+ */
+term functionprofiler_to_term(Context *ctx);
+
+#endif
@@ -24,7 +24,11 @@
 
 #include "atomshashtable.h"
 #include "defaultatoms.h"
+#include "heappool.h"
+#include "messagepool.h"
 #include "list.h"
+#include "memory.h"
+#include "scheduler.h"
 #include "utils.h"
 #include "valueshashtable.h"
 #include "sys.h"
@@ -38,6 +42,29 @@ struct RegisteredProcess
     int local_process_id;
 };
 
+struct PersistentTermValue
+{
+    struct ListHead values_list_head;
+
+    // literal area where a value set after the first one is stored
+    term storage[];
+};
+
+struct PersistentTerm
+{
+    struct ListHead persistent_terms_list_head;
+
+    term key;
+    term value;
+
+    // values that have been set after the first one, replaced values are still referenced by processes so they are
+    // released only when the global context is destroyed
+    struct ListHead *values;
+
+    // literal area where key and first value are stored
+    term storage[];
+};
+
 GlobalContext *globalcontext_new()
 {
     GlobalContext *glb = malloc(sizeof(GlobalContext));
@@ -49,6 +76,7 @@ GlobalContext *globalcontext_new()
     glb->listeners = NULL;
     glb->processes_table = NULL;
     glb->registered_processes = NULL;
+    glb->persistent_terms = NULL;
 
     glb->last_process_id = 0;
 
@@ -81,11 +109,81 @@ GlobalContext *globalcontext_new()
 
     glb->ref_ticks = 0;
 
+    glb->reductions_per_slice = DEFAULT_REDUCTIONS_AMOUNT;
+    glb->fullsweep_after = DEFAULT_FULLSWEEP_AFTER;
+    glb->heap_growth = DEFAULT_HEAP_GROWTH;
+    glb->compacting_gc_threshold = DEFAULT_COMPACTING_GC_THRESHOLD;
+    glb->max_gc_pause = DEFAULT_MAX_GC_PAUSE;
+
+    glb->heap_pool = heappool_new();
+    if (IS_NULL_PTR(glb->heap_pool)) {
+        free(glb->modules_table);
+        free(glb->atoms_ids_table);
+        free(glb->atoms_table);
+        free(glb);
+        return NULL;
+    }
+
+    glb->message_pool = messagepool_new();
+    if (IS_NULL_PTR(glb->message_pool)) {
+        heappool_destroy(glb->heap_pool);
+        free(glb->modules_table);
+        free(glb->atoms_ids_table);
+        free(glb->atoms_table);
+        free(glb);
+        return NULL;
+    }
+
+    glb->dirty_jobs = NULL;
+
+#ifdef ENABLE_FUNCTION_PROFILER
+    glb->function_profiler_enabled = 0;
+    glb->function_profiler_generation = 0;
+#endif
+
+#ifdef ENABLE_OPCODE_PROFILER
+    glb->opcode_stats = opcodestats_new();
+    if (IS_NULL_PTR(glb->opcode_stats)) {
+        messagepool_destroy(glb->message_pool);
+        heappool_destroy(glb->heap_pool);
+        free(glb->modules_table);
+        free(glb->atoms_ids_table);
+        free(glb->atoms_table);
+        free(glb);
+        return NULL;
+    }
+#endif
+
+#ifdef ENABLE_JIT
+    glb->jit_modules = NULL;
+#endif
+
     return glb;
 }
 
 COLD_FUNC void globalcontext_destroy(GlobalContext *glb)
 {
+    while (glb->persistent_terms) {
+        struct PersistentTerm *persistent_term = GET_LIST_ENTRY(glb->persistent_terms, struct PersistentTerm, persistent_terms_list_head);
+        linkedlist_remove(&glb->persistent_terms, &persistent_term->persistent_terms_list_head);
+        while (persistent_term->values) {
+            struct PersistentTermValue *value = GET_LIST_ENTRY(persistent_term->values, struct PersistentTermValue, values_list_head);
+            linkedlist_remove(&persistent_term->values, &value->values_list_head);
+            memory_unregister_literal_area(value->storage);
+            free(value);
+        }
+        memory_unregister_literal_area(persistent_term->storage);
+        free(persistent_term);
+    }
+
+    if (glb->dirty_jobs) {
+        sys_stop_dirty_jobs(glb);
+    }
+#ifdef ENABLE_OPCODE_PROFILER
+    opcodestats_destroy(glb->opcode_stats);
+#endif
+    messagepool_destroy(glb->message_pool);
+    heappool_destroy(glb->heap_pool);
     free(glb);
 }
 
@@ -145,6 +243,92 @@ int globalcontext_get_registered_process(GlobalContext *glb, int atom_index)
     return 0;
 }
 
+static struct PersistentTerm *globalcontext_find_persistent_term(GlobalContext *glb, term key)
+{
+    if (!glb->persistent_terms) {
+        return NULL;
+    }
+
+    struct PersistentTerm *persistent_terms = GET_LIST_ENTRY(glb->persistent_terms, struct PersistentTerm, persistent_terms_list_head);
+
+    struct PersistentTerm *p = persistent_terms;
+    do {
+        if (term_exactly_equals(p->key, key)) {
+            return p;
+        }
+
+        p = GET_LIST_ENTRY(p->persistent_terms_list_head.next, struct PersistentTerm, persistent_terms_list_head);
+    } while (p != persistent_terms);
+
+    return NULL;
+}
+
+// the key is already stored, so only the value is copied to a new literal area
+static int globalcontext_replace_persistent_term(struct PersistentTerm *persistent_term, term value)
+{
+    unsigned long value_size = memory_estimate_usage(value);
+
+    struct PersistentTermValue *new_value = malloc(sizeof(struct PersistentTermValue) + value_size * sizeof(term));
+    if (IS_NULL_PTR(new_value)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        return 0;
+    }
+
+    term *heap_ptr = new_value->storage;
+    term new_value_term = memory_copy_term_tree(&heap_ptr, value);
+
+    if (UNLIKELY(!memory_register_literal_area(new_value->storage, heap_ptr))) {
+        free(new_value);
+        return 0;
+    }
+
+    linkedlist_append(&persistent_term->values, &new_value->values_list_head);
+    persistent_term->value = new_value_term;
+
+    return 1;
+}
+
+int globalcontext_put_persistent_term(GlobalContext *glb, term key, term value)
+{
+    struct PersistentTerm *old_persistent_term = globalcontext_find_persistent_term(glb, key);
+    if (old_persistent_term) {
+        return globalcontext_replace_persistent_term(old_persistent_term, value);
+    }
+
+    unsigned long key_size = memory_estimate_usage(key);
+    unsigned long value_size = memory_estimate_usage(value);
+
+    struct PersistentTerm *persistent_term = malloc(sizeof(struct PersistentTerm) + (key_size + value_size) * sizeof(term));
+    if (IS_NULL_PTR(persistent_term)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        return 0;
+    }
+
+    term *heap_ptr = persistent_term->storage;
+    persistent_term->key = memory_copy_term_tree(&heap_ptr, key);
+    persistent_term->value = memory_copy_term_tree(&heap_ptr, value);
+    persistent_term->values = NULL;
+
+    if (UNLIKELY(!memory_register_literal_area(persistent_term->storage, heap_ptr))) {
+        free(persistent_term);
+        return 0;
+    }
+
+    linkedlist_append(&glb->persistent_terms, &persistent_term->persistent_terms_list_head);
+
+    return 1;
+}
+
+term globalcontext_get_persistent_term(GlobalContext *glb, term key)
+{
+    struct PersistentTerm *persistent_term = globalcontext_find_persistent_term(glb, key);
+    if (!persistent_term) {
+        return term_invalid_term();
+    }
+
+    return persistent_term->value;
+}
+
 int globalcontext_insert_atom(GlobalContext *glb, AtomString atom_string)
 {
     struct AtomsHashTable *htable = glb->atoms_table;
@@ -252,3 +436,15 @@ Module *globalcontext_get_module(GlobalContext *global, AtomString module_name_a
 
     return found_module;
 }
+
+int globalcontext_link_modules(GlobalContext *global)
+{
+    int unresolved_count = 0;
+
+    // linking may load more modules, so loaded_modules_count is checked on each iteration
+    for (int i = 0; i < global->loaded_modules_count; i++) {
+        unresolved_count += module_link(global->modules_by_index[i]);
+    }
+
+    return unresolved_count;
+}
@@ -33,6 +33,11 @@
 #include "atom.h"
 #include "term.h"
 #include "linkedlist.h"
+#include "memory.h"
+
+#ifdef ENABLE_OPCODE_PROFILER
+    #include "opcodestats.h"
+#endif
 
 struct Context;
 
@@ -42,6 +47,8 @@ typedef struct Context Context;
 #endif
 
 struct GlobalContext;
+struct HeapPool;
+struct MessagePool;
 
 #ifndef TYPEDEF_MODULE
 #define TYPEDEF_MODULE
@@ -57,6 +64,7 @@ typedef struct
     struct ListHead *listeners;
     struct ListHead *processes_table;
     struct ListHead *registered_processes;
+    struct ListHead *persistent_terms;
 
     int32_t last_process_id;
 
@@ -73,6 +81,43 @@ typedef struct
 
     uint64_t ref_ticks;
 
+    int reductions_per_slice;
+
+    // default fullsweep_after value of new processes
+    int fullsweep_after;
+
+    // default heap growth strategy of new processes
+    enum HeapGrowthStrategy heap_growth;
+
+    // default compacting_gc_threshold value of new processes
+    unsigned long compacting_gc_threshold;
+
+    // default max_gc_pause value of new processes
+    int max_gc_pause;
+
+    // process heaps allocator
+    struct HeapPool *heap_pool;
+
+    // message buffers allocator
+    struct MessagePool *message_pool;
+
+    // platform specific state of the dirty jobs worker threads, created on first sys_submit_dirty_job
+    void *dirty_jobs;
+
+#ifdef ENABLE_OPCODE_PROFILER
+    struct OpcodeStats *opcode_stats;
+#endif
+
+#ifdef ENABLE_FUNCTION_PROFILER
+    int function_profiler_enabled;
+    unsigned int function_profiler_generation;
+#endif
+
+#ifdef ENABLE_JIT
+    // comma separated names of the modules that are translated to native code when loaded, NULL for all of them
+    const char *jit_modules;
+#endif
+
 } GlobalContext;
 
 /**
@@ -130,6 +175,30 @@ void globalcontext_register_process(GlobalContext *glb, int atom_index, int loca
  */
 int globalcontext_get_registered_process(GlobalContext *glb, int atom_index);
 
+/**
+ * @brief Stores a persistent term
+ *
+ * @details Key and value are copied to a literal area, so they are shared by all processes and they are never
+ * copied again: neither by the garbage collector nor when sent to other processes. Memory used by a replaced value
+ * is released only when the global context is destroyed, since processes might still reference it, so persistent
+ * terms should be used for data that is rarely updated.
+ * @param glb the global context.
+ * @param key the key, keys are compared using exact equality.
+ * @param value the value that will be stored.
+ * @returns 1 when successful, otherwise 0.
+ */
+int globalcontext_put_persistent_term(GlobalContext *glb, term key, term value);
+
+/**
+ * @brief Gets a persistent term
+ *
+ * @details Returns a previously stored persistent term, the returned term must not be modified.
+ * @param glb the global context.
+ * @param key the key.
+ * @returns the value or an invalid term if there is no value for the given key.
+ */
+term globalcontext_get_persistent_term(GlobalContext *glb, term key);
+
 /**
  * @brief Inserts an atom into the global atoms table
  *
@@ -185,6 +254,16 @@ int globalcontext_insert_module(GlobalContext *global, Module *module, AtomStrin
  */
 Module *globalcontext_get_module(GlobalContext *global, AtomString module_name_atom);
 
+/**
+ * @brief Resolves the imports of all loaded modules
+ *
+ * @details Links every loaded module, loading all the modules they depend on (and their dependencies) up front.
+ * Unresolved imports are reported on stderr and they are still resolved lazily on first call.
+ * @param global the global context.
+ * @returns the number of imported functions that cannot be resolved.
+ */
+int globalcontext_link_modules(GlobalContext *global);
+
 static inline uint64_t globalcontext_get_ref_ticks(GlobalContext *global)
 {
     return ++global->ref_ticks;
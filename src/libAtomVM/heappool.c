@@ -0,0 +1,341 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "heappool.h"
+
+#include <stdlib.h>
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "defaultatoms.h"
+#include "memory.h"
+#include "utils.h"
+
+// biggest size class, larger memory blocks are not kept on free lists
+#define HEAP_POOL_MAX_CLASS_SIZE 16384
+// maximum amount of memory kept on the free list of a size class, in term units
+#define HEAP_POOL_CLASS_CACHE_SIZE 65536
+#define HEAP_POOL_MAX_CLASSES 32
+#define HEAP_POOL_MAX_CACHED_LARGE_BLOCKS 4
+// large memory blocks start with a header that stores their size, 2 terms are used to keep the alignment
+#define HEAP_POOL_LARGE_HEADER_SIZE 2
+
+struct FreeBlock
+{
+    struct FreeBlock *next;
+};
+
+struct HeapPoolClass
+{
+    unsigned long size;
+    struct FreeBlock *free_list;
+    unsigned long live_blocks;
+    unsigned long cached_blocks;
+};
+
+struct LargeBlock
+{
+    term *mapping;
+    unsigned long size;
+};
+
+struct HeapPool
+{
+    struct HeapPoolClass classes[HEAP_POOL_MAX_CLASSES];
+    int classes_count;
+
+    // large memory blocks which pages have been released, they are reused when they are not too big
+    struct LargeBlock large_cache[HEAP_POOL_MAX_CACHED_LARGE_BLOCKS];
+    int large_cached_count;
+    unsigned long large_live_blocks;
+    unsigned long large_block_granularity;
+
+    unsigned long live_words;
+    unsigned long cached_words;
+    uint64_t allocs;
+    uint64_t pool_hits;
+};
+
+struct HeapPool *heappool_new()
+{
+    struct HeapPool *pool = malloc(sizeof(struct HeapPool));
+    if (IS_NULL_PTR(pool)) {
+        return NULL;
+    }
+
+    int classes_count = 0;
+    unsigned long class_size = memory_next_fibonacci_heap_size(0);
+    while ((class_size <= HEAP_POOL_MAX_CLASS_SIZE) && (classes_count < HEAP_POOL_MAX_CLASSES)) {
+        pool->classes[classes_count].size = class_size;
+        pool->classes[classes_count].free_list = NULL;
+        pool->classes[classes_count].live_blocks = 0;
+        pool->classes[classes_count].cached_blocks = 0;
+        classes_count++;
+        class_size = memory_next_fibonacci_heap_size(class_size + 1);
+    }
+    pool->classes_count = classes_count;
+
+    pool->large_cached_count = 0;
+    pool->large_live_blocks = 0;
+#ifdef HAVE_MMAP
+    pool->large_block_granularity = sysconf(_SC_PAGESIZE) / sizeof(term);
+#else
+    pool->large_block_granularity = 1;
+#endif
+
+    pool->live_words = 0;
+    pool->cached_words = 0;
+    pool->allocs = 0;
+    pool->pool_hits = 0;
+
+    return pool;
+}
+
+static term *heappool_map(unsigned long size)
+{
+#ifdef HAVE_MMAP
+    void *mapping = mmap(NULL, size * sizeof(term), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (mapping != MAP_FAILED) ? (term *) mapping : NULL;
+#else
+    return malloc(size * sizeof(term));
+#endif
+}
+
+static void heappool_unmap(term *mapping, unsigned long size)
+{
+#ifdef HAVE_MMAP
+    munmap(mapping, size * sizeof(term));
+#else
+    UNUSED(size);
+    free(mapping);
+#endif
+}
+
+void heappool_destroy(struct HeapPool *pool)
+{
+    for (int i = 0; i < pool->classes_count; i++) {
+        struct FreeBlock *free_block = pool->classes[i].free_list;
+        while (free_block) {
+            struct FreeBlock *next = free_block->next;
+            free(free_block);
+            free_block = next;
+        }
+    }
+
+    for (int i = 0; i < pool->large_cached_count; i++) {
+        heappool_unmap(pool->large_cache[i].mapping, pool->large_cache[i].size);
+    }
+
+    free(pool);
+}
+
+// returns the smallest size class that can hold size terms, or -1 when the memory block is a large one
+static int heappool_class_index(const struct HeapPool *pool, unsigned long size)
+{
+    int low = 0;
+    int high = pool->classes_count - 1;
+    if (size > pool->classes[high].size) {
+        return -1;
+    }
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (pool->classes[middle].size < size) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+static unsigned long heappool_large_mapping_size(const struct HeapPool *pool, unsigned long size)
+{
+    unsigned long granularity = pool->large_block_granularity;
+    return ((size + HEAP_POOL_LARGE_HEADER_SIZE + granularity - 1) / granularity) * granularity;
+}
+
+static term *heappool_alloc_large(struct HeapPool *pool, unsigned long size, unsigned long *capacity)
+{
+    unsigned long mapping_size = heappool_large_mapping_size(pool, size);
+
+    // cached blocks are reused when they are no more than 25% bigger than required
+    int best = -1;
+    for (int i = 0; i < pool->large_cached_count; i++) {
+        unsigned long cached_size = pool->large_cache[i].size;
+        if ((cached_size >= mapping_size) && (cached_size <= mapping_size + mapping_size / 4)
+                && ((best < 0) || (cached_size < pool->large_cache[best].size))) {
+            best = i;
+        }
+    }
+
+    term *mapping;
+    if (best >= 0) {
+        mapping = pool->large_cache[best].mapping;
+        mapping_size = pool->large_cache[best].size;
+        pool->large_cached_count--;
+        pool->large_cache[best] = pool->large_cache[pool->large_cached_count];
+        pool->pool_hits++;
+    } else {
+        mapping = heappool_map(mapping_size);
+        if (IS_NULL_PTR(mapping)) {
+            return NULL;
+        }
+    }
+
+    mapping[0] = mapping_size;
+    pool->large_live_blocks++;
+    pool->live_words += mapping_size;
+
+    *capacity = mapping_size - HEAP_POOL_LARGE_HEADER_SIZE;
+    return mapping + HEAP_POOL_LARGE_HEADER_SIZE;
+}
+
+static void heappool_free_large(struct HeapPool *pool, term *block)
+{
+    term *mapping = block - HEAP_POOL_LARGE_HEADER_SIZE;
+    unsigned long mapping_size = mapping[0];
+
+    pool->large_live_blocks--;
+    pool->live_words -= mapping_size;
+
+#ifdef HAVE_MMAP
+    if ((pool->large_cached_count < HEAP_POOL_MAX_CACHED_LARGE_BLOCKS)
+            && (madvise(mapping, mapping_size * sizeof(term), MADV_DONTNEED) == 0)) {
+        pool->large_cache[pool->large_cached_count].mapping = mapping;
+        pool->large_cache[pool->large_cached_count].size = mapping_size;
+        pool->large_cached_count++;
+        return;
+    }
+#endif
+
+    heappool_unmap(mapping, mapping_size);
+}
+
+unsigned long heappool_capacity(const struct HeapPool *pool, unsigned long size)
+{
+    int class_index = heappool_class_index(pool, size);
+    if (class_index < 0) {
+        return heappool_large_mapping_size(pool, size) - HEAP_POOL_LARGE_HEADER_SIZE;
+    }
+
+    return pool->classes[class_index].size;
+}
+
+term *heappool_alloc(struct HeapPool *pool, unsigned long size, unsigned long *capacity)
+{
+    pool->allocs++;
+
+    int class_index = heappool_class_index(pool, size);
+    if (class_index < 0) {
+        return heappool_alloc_large(pool, size, capacity);
+    }
+
+    struct HeapPoolClass *size_class = &pool->classes[class_index];
+    term *block;
+    if (size_class->free_list) {
+        block = (term *) size_class->free_list;
+        size_class->free_list = size_class->free_list->next;
+        size_class->cached_blocks--;
+        pool->cached_words -= size_class->size;
+        pool->pool_hits++;
+    } else {
+        block = malloc(size_class->size * sizeof(term));
+        if (IS_NULL_PTR(block)) {
+            return NULL;
+        }
+    }
+
+    size_class->live_blocks++;
+    pool->live_words += size_class->size;
+
+    *capacity = size_class->size;
+    return block;
+}
+
+void heappool_free(struct HeapPool *pool, term *block, unsigned long size)
+{
+    if (!block) {
+        return;
+    }
+
+    int class_index = heappool_class_index(pool, size);
+    if (class_index < 0) {
+        heappool_free_large(pool, block);
+        return;
+    }
+
+    struct HeapPoolClass *size_class = &pool->classes[class_index];
+    size_class->live_blocks--;
+    pool->live_words -= size_class->size;
+
+    if ((size_class->cached_blocks + 1) * size_class->size > HEAP_POOL_CLASS_CACHE_SIZE) {
+        free(block);
+        return;
+    }
+
+    struct FreeBlock *free_block = (struct FreeBlock *) block;
+    free_block->next = size_class->free_list;
+    size_class->free_list = free_block;
+    size_class->cached_blocks++;
+    pool->cached_words += size_class->size;
+}
+
+term heappool_stats_to_term(struct HeapPool *pool, Context *ctx)
+{
+    // garbage collection updates pool counters, so memory is reserved for every size class
+    if (UNLIKELY(memory_ensure_free(ctx, (pool->classes_count + 1) * (4 + 2) + 6 * (3 + 2)) != MEMORY_GC_OK)) {
+        return term_invalid_term();
+    }
+
+    term classes = term_nil();
+    term large_class = term_alloc_tuple(3, ctx);
+    term_put_tuple_element(large_class, 0, term_from_int32(0));
+    term_put_tuple_element(large_class, 1, term_from_counter(pool->large_live_blocks));
+    term_put_tuple_element(large_class, 2, term_from_int32(pool->large_cached_count));
+    classes = term_list_prepend(large_class, classes, ctx);
+
+    for (int i = pool->classes_count - 1; i >= 0; i--) {
+        const struct HeapPoolClass *size_class = &pool->classes[i];
+        if (!size_class->live_blocks && !size_class->cached_blocks) {
+            continue;
+        }
+        term class_tuple = term_alloc_tuple(3, ctx);
+        term_put_tuple_element(class_tuple, 0, term_from_int32(size_class->size));
+        term_put_tuple_element(class_tuple, 1, term_from_counter(size_class->live_blocks));
+        term_put_tuple_element(class_tuple, 2, term_from_counter(size_class->cached_blocks));
+        classes = term_list_prepend(class_tuple, classes, ctx);
+    }
+
+    unsigned long total_words = pool->live_words + pool->cached_words;
+    int fragmentation = total_words ? (int) ((uint64_t) pool->cached_words * 100 / total_words) : 0;
+
+    term stats = term_list_prepend_pair(CLASSES_ATOM, classes, term_nil(), ctx);
+    stats = term_list_prepend_pair(POOL_HITS_ATOM, term_from_counter(pool->pool_hits), stats, ctx);
+    stats = term_list_prepend_pair(ALLOCS_ATOM, term_from_counter(pool->allocs), stats, ctx);
+    stats = term_list_prepend_pair(FRAGMENTATION_ATOM, term_from_int32(fragmentation), stats, ctx);
+    stats = term_list_prepend_pair(CACHED_WORDS_ATOM, term_from_counter(pool->cached_words), stats, ctx);
+    stats = term_list_prepend_pair(LIVE_WORDS_ATOM, term_from_counter(pool->live_words), stats, ctx);
+
+    return stats;
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+/**
+ * @file heappool.h
+ * @brief Process heaps allocator.
+ *
+ * @details Process heaps are allocated and released on every garbage collection, so released memory blocks are kept
+ * on per size class free lists and reused. Size classes are the Fibonacci heap sizes, so heaps sized by the
+ * Fibonacci heap growth strategy are not rounded up. Memory blocks larger than the biggest size class are
+ * allocated with mmap where it is available, and a few of them are kept after their pages have been released
+ * with MADV_DONTNEED, so they are reused without keeping their memory resident.
+ */
+
+#ifndef _HEAPPOOL_H_
+#define _HEAPPOOL_H_
+
+#include <stdint.h>
+
+#include "term.h"
+
+#ifndef TYPEDEF_CONTEXT
+#define TYPEDEF_CONTEXT
+typedef struct Context Context;
+#endif
+
+struct HeapPool;
+
+/**
+ * @brief Creates a new heap pool.
+ *
+ * @returns a newly allocated HeapPool or NULL if memory cannot be allocated.
+ */
+struct HeapPool *heappool_new();
+
+/**
+ * @brief Destroys a heap pool.
+ *
+ * @details Cached memory blocks are released, memory blocks that are still in use must not be released after this call.
+ * @param pool the pool that will be destroyed.
+ */
+void heappool_destroy(struct HeapPool *pool);
+
+/**
+ * @brief Allocates a memory block.
+ *
+ * @details Memory is not zeroed. The memory block is big enough for size terms, its actual size is returned in
+ * capacity: all of it can be used.
+ * @param pool the pool the memory block is allocated from.
+ * @param size the required size in term units.
+ * @param capacity actual memory block size in term units, output parameter.
+ * @returns the allocated memory block or NULL if memory cannot be allocated.
+ */
+term *heappool_alloc(struct HeapPool *pool, unsigned long size, unsigned long *capacity);
+
+/**
+ * @brief Returns the capacity of a memory block.
+ *
+ * @details returns the capacity a memory block of the given size is allocated with, a cached large memory block
+ * might be a bit bigger.
+ * @param pool the pool the memory block would be allocated from.
+ * @param size the required size in term units.
+ * @returns the memory block capacity in term units.
+ */
+unsigned long heappool_capacity(const struct HeapPool *pool, unsigned long size);
+
+/**
+ * @brief Releases a memory block.
+ *
+ * @details size can be either the size that has been requested when the memory block has been allocated or any
+ * other size up to its capacity.
+ * @param pool the pool the memory block has been allocated from.
+ * @param block the memory block that will be released, NULL is allowed.
+ * @param size the size of the memory block in term units.
+ */
+void heappool_free(struct HeapPool *pool, term *block, unsigned long size);
+
+/**
+ * @brief Returns heap pool statistics.
+ *
+ * @details statistics are returned as a proplist: live_words and cached_words are the total size of memory blocks
+ * in use and kept on free lists, fragmentation is the percentage of memory that is held by free lists, allocs and
+ * pool_hits count allocations and allocations served by free lists, classes is a list of
+ * {ClassSize, LiveBlocks, CachedBlocks} tuples. Memory blocks larger than the biggest size class are accounted
+ * with class size 0.
+ * @param pool the pool.
+ * @param ctx the context that will own the returned term.
+ * @returns statistics list or an invalid term if memory cannot be allocated.
+ */
+term heappool_stats_to_term(struct HeapPool *pool, Context *ctx);
+
+#endif
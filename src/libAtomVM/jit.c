@@ -0,0 +1,634 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "jit.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "bif.h"
+#include "module.h"
+#include "opcodes.h"
+#include "trace.h"
+#include "utils.h"
+
+// operand words, as they are emitted by the code loader (see opcodesswitch.h)
+#define OPERAND_XREG 3
+#define OPERAND_YREG 4
+#define OPERAND_LITERAL 7
+#define OPERAND_LARGE_INTEGER 9
+
+#define REG_RAX 0
+#define REG_RCX 1
+#define REG_RDX 2
+#define REG_RSI 6
+#define REG_RDI 7
+
+// int_native needs the opcode word and the native code pointer, so runs are at least this long
+#define MIN_RUN_INSTRUCTIONS 2
+
+#define JUMP_TARGET_FLAG 1
+
+struct NativeBuffer
+{
+    uint8_t *code;
+    unsigned long size;
+    unsigned long capacity;
+    int failed;
+};
+
+static void emit_bytes(struct NativeBuffer *buf, const void *bytes, unsigned long count)
+{
+    if (buf->size + count > buf->capacity) {
+        unsigned long new_capacity = buf->capacity ? buf->capacity * 2 : 4096;
+        while (buf->size + count > new_capacity) {
+            new_capacity *= 2;
+        }
+        uint8_t *new_code = realloc(buf->code, new_capacity);
+        if (IS_NULL_PTR(new_code)) {
+            buf->failed = 1;
+            return;
+        }
+        buf->code = new_code;
+        buf->capacity = new_capacity;
+    }
+    memcpy(buf->code + buf->size, bytes, count);
+    buf->size += count;
+}
+
+static void emit_u8(struct NativeBuffer *buf, uint8_t byte)
+{
+    emit_bytes(buf, &byte, 1);
+}
+
+// x86-64 is little endian, so values are copied as they are
+static void emit_u32(struct NativeBuffer *buf, uint32_t value)
+{
+    emit_bytes(buf, &value, sizeof(uint32_t));
+}
+
+static void emit_u64(struct NativeBuffer *buf, uint64_t value)
+{
+    emit_bytes(buf, &value, sizeof(uint64_t));
+}
+
+// mov reg, [base + disp32]
+static void emit_load(struct NativeBuffer *buf, int reg, int base, int32_t disp)
+{
+    emit_u8(buf, 0x48);
+    emit_u8(buf, 0x8B);
+    emit_u8(buf, 0x80 | (reg << 3) | base);
+    emit_u32(buf, disp);
+}
+
+// mov [base + disp32], reg
+static void emit_store(struct NativeBuffer *buf, int reg, int base, int32_t disp)
+{
+    emit_u8(buf, 0x48);
+    emit_u8(buf, 0x89);
+    emit_u8(buf, 0x80 | (reg << 3) | base);
+    emit_u32(buf, disp);
+}
+
+// mov reg, imm64
+static void emit_load_immediate(struct NativeBuffer *buf, int reg, uint64_t value)
+{
+    emit_u8(buf, 0x48);
+    emit_u8(buf, 0xB8 | reg);
+    emit_u64(buf, value);
+}
+
+// mov eax, imm32; ret
+#define RETURN_SIZE 6
+static void emit_return(struct NativeBuffer *buf, int instruction_ii)
+{
+    emit_u8(buf, 0xB8);
+    emit_u32(buf, instruction_ii);
+    emit_u8(buf, 0xC3);
+}
+
+// jcc rel8, jumps over the given number of bytes
+static void emit_short_jump(struct NativeBuffer *buf, uint8_t opcode, uint8_t bytes)
+{
+    emit_u8(buf, opcode);
+    emit_u8(buf, bytes);
+}
+
+#define JUMP_IF_OVERFLOW 0x70
+#define JUMP_IF_NOT_OVERFLOW 0x71
+#define JUMP_IF_BELOW 0x72
+#define JUMP_IF_ABOVE_OR_EQUAL 0x73
+#define JUMP_IF_EQUAL 0x74
+#define JUMP_IF_NOT_EQUAL 0x75
+#define JUMP_IF_LESS_OR_EQUAL 0x7E
+
+static int label_ii(const Module *mod, int label)
+{
+    return (const term *) mod->labels[label] - mod->instructions;
+}
+
+// rcx is used as scratch register for y registers, since the interpreter keeps ctx->e up to date
+static void emit_load_operand(struct NativeBuffer *buf, const Module *mod, term operand, int reg)
+{
+    switch (operand & 0xF) {
+        case OPERAND_XREG:
+            emit_load(buf, reg, REG_RDI, offsetof(Context, x) + (operand >> 4) * sizeof(term));
+            break;
+
+        case OPERAND_YREG:
+            emit_load(buf, REG_RCX, REG_RDI, offsetof(Context, e));
+            emit_load(buf, reg, REG_RCX, (operand >> 4) * sizeof(term));
+            break;
+
+        case OPERAND_LITERAL:
+            emit_load_immediate(buf, reg, module_get_literal(mod, operand >> 4));
+            break;
+
+        case OPERAND_LARGE_INTEGER:
+            // it does not fit an immediate term, so it cannot be loaded
+            buf->failed = 1;
+            break;
+
+        default:
+            emit_load_immediate(buf, reg, operand);
+            break;
+    }
+}
+
+static void emit_store_register(struct NativeBuffer *buf, term dreg, int reg)
+{
+    switch (dreg & 0xF) {
+        case OPERAND_XREG:
+            emit_store(buf, reg, REG_RDI, offsetof(Context, x) + (dreg >> 4) * sizeof(term));
+            break;
+
+        case OPERAND_YREG:
+            emit_load(buf, REG_RCX, REG_RDI, offsetof(Context, e));
+            emit_store(buf, reg, REG_RCX, (dreg >> 4) * sizeof(term));
+            break;
+
+        default:
+            buf->failed = 1;
+            break;
+    }
+}
+
+// checks (rax & mask) == value, otherwise returns the label instruction
+static void emit_tag_test(struct NativeBuffer *buf, const Module *mod, uint8_t mask, uint8_t value, int label)
+{
+    // mov ecx, eax; and ecx, mask; cmp ecx, value
+    emit_u8(buf, 0x89);
+    emit_u8(buf, 0xC1);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xE1);
+    emit_u8(buf, mask);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xF9);
+    emit_u8(buf, value);
+    emit_short_jump(buf, JUMP_IF_EQUAL, RETURN_SIZE);
+    emit_return(buf, label_ii(mod, label));
+}
+
+// compares rax with rdx as the interpreter does (as unsigned words), continues on condition otherwise returns the label
+static void emit_compare(struct NativeBuffer *buf, const Module *mod, uint8_t jump_if, int label)
+{
+    // cmp rax, rdx
+    emit_u8(buf, 0x48);
+    emit_u8(buf, 0x39);
+    emit_u8(buf, 0xD0);
+    emit_short_jump(buf, jump_if, RETURN_SIZE);
+    emit_return(buf, label_ii(mod, label));
+}
+
+// equal words are exactly equal and immediates are equal only when their words are, the interpreter compares boxed
+// terms, so it executes the instruction again
+static void emit_exact_compare(struct NativeBuffer *buf, const Module *mod, int label, int instruction_ii)
+{
+    // cmp rax, rdx; je to the next instruction
+    emit_u8(buf, 0x48);
+    emit_u8(buf, 0x39);
+    emit_u8(buf, 0xD0);
+    emit_short_jump(buf, JUMP_IF_EQUAL, 20 + 2 * RETURN_SIZE);
+    // mov ecx, eax; and ecx, 3; cmp ecx, 2; jne to the label return
+    emit_u8(buf, 0x89);
+    emit_u8(buf, 0xC1);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xE1);
+    emit_u8(buf, 0x03);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xF9);
+    emit_u8(buf, TERM_BOXED_VALUE_TAG);
+    emit_short_jump(buf, JUMP_IF_NOT_EQUAL, 10 + RETURN_SIZE);
+    // mov ecx, edx; and ecx, 3; cmp ecx, 2; jne to the label return
+    emit_u8(buf, 0x89);
+    emit_u8(buf, 0xD1);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xE1);
+    emit_u8(buf, 0x03);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xF9);
+    emit_u8(buf, TERM_BOXED_VALUE_TAG);
+    emit_short_jump(buf, JUMP_IF_NOT_EQUAL, RETURN_SIZE);
+    emit_return(buf, instruction_ii);
+    emit_return(buf, label_ii(mod, label));
+}
+
+// same as the interpreter: 32 bits arithmetic on the untagged words, anything else is left to the BIF
+static void emit_integer_arithmetic(struct NativeBuffer *buf, uint8_t arithmetic_opcode, int instruction_ii)
+{
+    // mov ecx, eax; and ecx, edx; and ecx, 0xF; cmp ecx, 0xF; je over the return
+    emit_u8(buf, 0x89);
+    emit_u8(buf, 0xC1);
+    emit_u8(buf, 0x21);
+    emit_u8(buf, 0xD1);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xE1);
+    emit_u8(buf, TERM_INTEGER_TAG);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xF9);
+    emit_u8(buf, TERM_INTEGER_TAG);
+    emit_short_jump(buf, JUMP_IF_EQUAL, RETURN_SIZE);
+    emit_return(buf, instruction_ii);
+    // and eax, ~0xF; and edx, ~0xF; add/sub eax, edx; jno over the return
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xE0);
+    emit_u8(buf, (uint8_t) ~TERM_INTEGER_TAG);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xE2);
+    emit_u8(buf, (uint8_t) ~TERM_INTEGER_TAG);
+    emit_u8(buf, arithmetic_opcode);
+    emit_u8(buf, 0xD0);
+    emit_short_jump(buf, JUMP_IF_NOT_OVERFLOW, RETURN_SIZE);
+    emit_return(buf, instruction_ii);
+    // movsxd rax, eax; or rax, 0xF
+    emit_u8(buf, 0x48);
+    emit_u8(buf, 0x63);
+    emit_u8(buf, 0xC0);
+    emit_u8(buf, 0x48);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xC8);
+    emit_u8(buf, TERM_INTEGER_TAG);
+}
+
+// the time slice is checked as jump does, the interpreter executes the jump when the process has to be scheduled out
+static void emit_jump(struct NativeBuffer *buf, const Module *mod, int label, int instruction_ii)
+{
+    int32_t reductions_offset = offsetof(Context, remaining_reductions);
+    // mov ecx, [rdi + remaining_reductions]; cmp ecx, 1; jle to the interpreter return
+    emit_u8(buf, 0x8B);
+    emit_u8(buf, 0x8F);
+    emit_u32(buf, reductions_offset);
+    emit_u8(buf, 0x83);
+    emit_u8(buf, 0xF9);
+    emit_u8(buf, 0x01);
+    emit_short_jump(buf, JUMP_IF_LESS_OR_EQUAL, 6 + RETURN_SIZE);
+    // dec dword [rdi + remaining_reductions]
+    emit_u8(buf, 0xFF);
+    emit_u8(buf, 0x8F);
+    emit_u32(buf, reductions_offset);
+    emit_return(buf, label_ii(mod, label));
+    emit_return(buf, instruction_ii);
+}
+
+// rax is the list, head and tail are loaded before they are stored, since the list might be overwritten
+static void emit_get_list(struct NativeBuffer *buf, term head_dreg, term tail_dreg)
+{
+    // lists are tagged 01, so the cons cell is at rax - 1: tail first, then head
+    emit_load(buf, REG_RDX, REG_RAX, sizeof(term) - 1);
+    emit_load(buf, REG_RSI, REG_RAX, -1);
+    emit_store_register(buf, head_dreg, REG_RDX);
+    emit_store_register(buf, tail_dreg, REG_RSI);
+}
+
+static int is_integer_arithmetic(const Module *mod, const term *code, BifImpl bif)
+{
+    return (code[0] == OP_GC_BIF2) && (mod->imported_funcs[code[3]].bif == bif);
+}
+
+// number of words of supported instructions, 0 for instructions that are always interpreted
+static int native_instruction_size(const Module *mod, const term *code)
+{
+    switch (code[0]) {
+        case OP_JUMP:
+            return 2;
+
+        case OP_MOVE:
+        case OP_GET_HD:
+        case OP_GET_TL:
+        case OP_IS_NIL:
+        case OP_IS_NONEMPTY_LIST:
+        case OP_IS_INTEGER:
+        case OP_IS_ATOM:
+            return 3;
+
+        case OP_GET_LIST:
+        case OP_GET_TUPLE_ELEMENT:
+        case OP_IS_LT:
+        case OP_IS_GE:
+        case OP_IS_NOT_EQUAL:
+        case OP_IS_EQ_EXACT:
+        case OP_IS_NOT_EQ_EXACT:
+            return 4;
+
+        case OP_IS_NONEMPTY_LIST_GET_LIST:
+            return 6;
+
+        case OP_GC_BIF2:
+            if (is_integer_arithmetic(mod, code, (BifImpl) bif_erlang_add_2)
+                || is_integer_arithmetic(mod, code, (BifImpl) bif_erlang_sub_2)) {
+                return 7;
+            }
+            return 0;
+
+        default:
+            return 0;
+    }
+}
+
+// instructions that return to the interpreter to be executed there in uncommon cases: they cannot start a run, since
+// int_native replaces the first instruction of a run
+static int native_instruction_may_fall_back(int opcode)
+{
+    switch (opcode) {
+        case OP_JUMP:
+        case OP_IS_EQ_EXACT:
+        case OP_GC_BIF2:
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+static void emit_instruction(struct NativeBuffer *buf, const Module *mod, unsigned int instruction_ii)
+{
+    const term *code = &mod->instructions[instruction_ii];
+
+    switch (code[0]) {
+        case OP_MOVE:
+            emit_load_operand(buf, mod, code[1], REG_RAX);
+            emit_store_register(buf, code[2], REG_RAX);
+            break;
+
+        case OP_GET_LIST:
+            emit_load_operand(buf, mod, code[1], REG_RAX);
+            emit_get_list(buf, code[2], code[3]);
+            break;
+
+        case OP_GET_HD:
+            emit_load_operand(buf, mod, code[1], REG_RAX);
+            emit_load(buf, REG_RDX, REG_RAX, sizeof(term) - 1);
+            emit_store_register(buf, code[2], REG_RDX);
+            break;
+
+        case OP_GET_TL:
+            emit_load_operand(buf, mod, code[1], REG_RAX);
+            emit_load(buf, REG_RDX, REG_RAX, -1);
+            emit_store_register(buf, code[2], REG_RDX);
+            break;
+
+        case OP_GET_TUPLE_ELEMENT:
+            // tuples are boxed, tagged 10, and elements follow the header
+            emit_load_operand(buf, mod, code[1], REG_RAX);
+            emit_load(buf, REG_RDX, REG_RAX, (code[2] + 1) * sizeof(term) - 2);
+            emit_store_register(buf, code[3], REG_RDX);
+            break;
+
+        case OP_IS_NIL:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_tag_test(buf, mod, 0x3F, 0x3B, code[1]);
+            break;
+
+        case OP_IS_NONEMPTY_LIST:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_tag_test(buf, mod, 0x3, 0x1, code[1]);
+            break;
+
+        case OP_IS_INTEGER:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_tag_test(buf, mod, 0xF, TERM_INTEGER_TAG, code[1]);
+            break;
+
+        case OP_IS_ATOM:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_tag_test(buf, mod, 0x3F, 0xB, code[1]);
+            break;
+
+        case OP_IS_NONEMPTY_LIST_GET_LIST:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_tag_test(buf, mod, 0x3, 0x1, code[1]);
+            emit_load_operand(buf, mod, code[3], REG_RAX);
+            emit_get_list(buf, code[4], code[5]);
+            break;
+
+        case OP_IS_LT:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_load_operand(buf, mod, code[3], REG_RDX);
+            emit_compare(buf, mod, JUMP_IF_BELOW, code[1]);
+            break;
+
+        case OP_IS_GE:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_load_operand(buf, mod, code[3], REG_RDX);
+            emit_compare(buf, mod, JUMP_IF_ABOVE_OR_EQUAL, code[1]);
+            break;
+
+        case OP_IS_NOT_EQUAL:
+        case OP_IS_NOT_EQ_EXACT:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_load_operand(buf, mod, code[3], REG_RDX);
+            emit_compare(buf, mod, JUMP_IF_NOT_EQUAL, code[1]);
+            break;
+
+        case OP_IS_EQ_EXACT:
+            emit_load_operand(buf, mod, code[2], REG_RAX);
+            emit_load_operand(buf, mod, code[3], REG_RDX);
+            emit_exact_compare(buf, mod, code[1], instruction_ii);
+            break;
+
+        case OP_JUMP:
+            emit_jump(buf, mod, code[1], instruction_ii);
+            break;
+
+        case OP_GC_BIF2:
+            emit_load_operand(buf, mod, code[4], REG_RAX);
+            emit_load_operand(buf, mod, code[5], REG_RDX);
+            // add eax, edx or sub eax, edx
+            emit_integer_arithmetic(buf, is_integer_arithmetic(mod, code, (BifImpl) bif_erlang_add_2) ? 0x01 : 0x29, instruction_ii);
+            emit_store_register(buf, code[6], REG_RAX);
+            break;
+
+        default:
+            buf->failed = 1;
+            break;
+    }
+}
+
+static unsigned int instruction_ii(const Module *mod, unsigned int index)
+{
+    return mod->jit_instructions[index] >> 1;
+}
+
+static int instruction_opcode(const Module *mod, unsigned int index)
+{
+    return mod->instructions[instruction_ii(mod, index)];
+}
+
+// instructions that follow the last recorded one are int_call_end and int_trap_resume
+static unsigned int instruction_end(const Module *mod, unsigned int index)
+{
+    if (index + 1 < mod->jit_instructions_count) {
+        return instruction_ii(mod, index + 1);
+    }
+    return mod->end_instruction_ii;
+}
+
+static int is_native_instruction(const Module *mod, unsigned int index)
+{
+    unsigned int start = instruction_ii(mod, index);
+    int size = native_instruction_size(mod, &mod->instructions[start]);
+    return size && (instruction_end(mod, index) - start == (unsigned int) size);
+}
+
+static int is_module_enabled(const Module *mod)
+{
+    const char *jit_modules = mod->global->jit_modules;
+    if (!jit_modules) {
+        return 1;
+    }
+
+    AtomString module_name = module_get_atom_string_by_id(mod, 1);
+    int len = atom_string_len(module_name);
+    const char *name = atom_string_data(module_name);
+    while (*jit_modules) {
+        const char *end = strchr(jit_modules, ',');
+        int item_len = end ? end - jit_modules : (int) strlen(jit_modules);
+        if ((item_len == len) && !memcmp(jit_modules, name, len)) {
+            return 1;
+        }
+        if (!end) {
+            break;
+        }
+        jit_modules = end + 1;
+    }
+
+    return 0;
+}
+
+void jit_add_instruction(Module *mod, unsigned int instruction_ii, int jump_target)
+{
+    if (mod->jit_instructions) {
+        mod->jit_instructions[mod->jit_instructions_count++] = (instruction_ii << 1) | (jump_target ? JUMP_TARGET_FLAG : 0);
+    }
+}
+
+void jit_compile_module(Module *mod)
+{
+    if (!mod->jit_instructions || !is_module_enabled(mod)) {
+        free(mod->jit_instructions);
+        mod->jit_instructions = NULL;
+        return;
+    }
+
+    struct NativeBuffer buf;
+    buf.code = NULL;
+    buf.size = 0;
+    buf.capacity = 0;
+    buf.failed = 0;
+
+    // instruction index and native code offset of each run are stored as pairs in jit_instructions, this never
+    // overwrites an entry that has not been read yet, since each run is made of at least 2 instructions
+    unsigned int runs_count = 0;
+
+    unsigned int count = mod->jit_instructions_count;
+    unsigned int first = 0;
+    while (first < count) {
+        if (!is_native_instruction(mod, first) || native_instruction_may_fall_back(instruction_opcode(mod, first))) {
+            first++;
+            continue;
+        }
+        // a run ends before a jump target, and after a jump since the following instruction is not reached from it
+        unsigned int last = first + 1;
+        while (last < count && is_native_instruction(mod, last) && !(mod->jit_instructions[last] & JUMP_TARGET_FLAG)
+            && (instruction_opcode(mod, last - 1) != OP_JUMP)) {
+            last++;
+        }
+        if (last - first < MIN_RUN_INSTRUCTIONS) {
+            first = last;
+            continue;
+        }
+
+        unsigned long offset = buf.size;
+        for (unsigned int index = first; index < last; index++) {
+            emit_instruction(&buf, mod, instruction_ii(mod, index));
+        }
+        if (instruction_opcode(mod, last - 1) != OP_JUMP) {
+            emit_return(&buf, instruction_end(mod, last - 1));
+        }
+
+        mod->jit_instructions[runs_count * 2] = instruction_ii(mod, first);
+        mod->jit_instructions[runs_count * 2 + 1] = offset;
+        runs_count++;
+
+        first = last;
+    }
+
+    void *native_code = MAP_FAILED;
+    if (!buf.failed && runs_count) {
+        native_code = mmap(NULL, buf.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (native_code == MAP_FAILED) {
+        free(buf.code);
+        free(mod->jit_instructions);
+        mod->jit_instructions = NULL;
+        return;
+    }
+    memcpy(native_code, buf.code, buf.size);
+    free(buf.code);
+    if (UNLIKELY(mprotect(native_code, buf.size, PROT_READ | PROT_EXEC) != 0)) {
+        munmap(native_code, buf.size);
+        free(mod->jit_instructions);
+        mod->jit_instructions = NULL;
+        return;
+    }
+
+    // instructions are patched only now, so a module that cannot be translated is left untouched
+    for (unsigned int i = 0; i < runs_count; i++) {
+        unsigned int run_ii = mod->jit_instructions[i * 2];
+        mod->instructions[run_ii] = OP_INT_NATIVE;
+        mod->instructions[run_ii + 1] = (term) ((uint8_t *) native_code + mod->jit_instructions[i * 2 + 1]);
+    }
+    TRACE("Translated %u runs to %lu bytes of native code\n", runs_count, buf.size);
+
+    mod->native_code = native_code;
+    mod->native_code_size = buf.size;
+
+    free(mod->jit_instructions);
+    mod->jit_instructions = NULL;
+}
+
+void jit_module_destroy(Module *mod)
+{
+    free(mod->jit_instructions);
+    if (mod->native_code) {
+        munmap(mod->native_code, mod->native_code_size);
+    }
+}
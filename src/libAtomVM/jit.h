@@ -0,0 +1,78 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+/**
+ * @file jit.h
+ * @brief Template based x86-64 native code backend.
+ *
+ * @details When AtomVM is built with ENABLE_JIT, straight runs of simple instructions (moves, list and tuple accessors,
+ * type tests, compares, jumps and small integer addition and subtraction) are translated to x86-64 code using a fixed
+ * template for each opcode. The first instruction of each run is replaced by int_native, that calls the native code
+ * and continues with the instruction it returns, so every other instruction is still interpreted. Uncommon cases, such
+ * as boxed operands or arithmetic overflows, return the instruction itself so the interpreter executes it. Native code
+ * reads and writes the same x and y registers the interpreter uses, so processes can switch between native and
+ * interpreted code at any run boundary.
+ */
+
+#ifndef _JIT_H_
+#define _JIT_H_
+
+#include "context.h"
+
+#ifndef TYPEDEF_MODULE
+#define TYPEDEF_MODULE
+typedef struct Module Module;
+#endif
+
+/**
+ * @brief Native code of a run of instructions.
+ *
+ * @param ctx the context that is executing the run.
+ * @returns the index of the instruction that is executed next.
+ */
+typedef int (*NativeCode)(Context *ctx);
+
+/**
+ * @brief Records an instruction emitted by the code loader.
+ *
+ * @details Called in instructions order, runs never include an instruction that is a jump target, but as their
+ * first instruction.
+ * @param mod the module that is being loaded.
+ * @param instruction_ii the index of the instruction opcode.
+ * @param jump_target whether a label points to this instruction.
+ */
+void jit_add_instruction(Module *mod, unsigned int instruction_ii, int jump_target);
+
+/**
+ * @brief Translates a loaded module to native code.
+ *
+ * @details Called once the module instructions are final. Modules are left interpreted when they are not listed in
+ * the global jit_modules setting or when native code cannot be allocated.
+ * @param mod the module that has been loaded.
+ */
+void jit_compile_module(Module *mod);
+
+/**
+ * @brief Releases native code and loader data of a module.
+ *
+ * @param mod the module that is being destroyed.
+ */
+void jit_module_destroy(Module *mod);
+
+#endif
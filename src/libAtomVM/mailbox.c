@@ -18,7 +18,9 @@
  ***************************************************************************/
 
 #include "mailbox.h"
+#include "globalcontext.h"
 #include "memory.h"
+#include "messagepool.h"
 #include "scheduler.h"
 #include "trace.h"
 
@@ -29,23 +31,42 @@ static inline term *mailbox_message_memory(Message *msg)
     return &msg->message + 1;
 }
 
+static inline size_t mailbox_message_bytes(const Message *msg)
+{
+    return sizeof(Message) + msg->msg_memory_size * sizeof(term);
+}
+
 void mailbox_send(Context *c, term t)
 {
     TRACE("Sending 0x%lx to pid %i\n", t, c->process_id);
 
     unsigned long estimated_mem_usage = memory_estimate_usage(t);
 
-    Message *m = malloc(sizeof(Message) + estimated_mem_usage * sizeof(term));
+    int buffer_size = sizeof(Message) + estimated_mem_usage * sizeof(term);
+    Message *m = messagepool_alloc(c->global->message_pool, buffer_size);
     if (IS_NULL_PTR(m)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return;
     }
+    m->msg_buffer_size = buffer_size;
 
-    term *heap_pos = mailbox_message_memory(m);
-    m->message = memory_copy_term_tree(&heap_pos, t);
+    if (estimated_mem_usage) {
+        term *heap_pos = mailbox_message_memory(m);
+        m->message = memory_copy_term_tree(&heap_pos, t);
+    } else {
+        // immediate or literal term: it is shared, so there is nothing to copy
+        m->message = t;
+    }
     m->msg_memory_size = estimated_mem_usage;
+    m->attached = 0;
 
     linkedlist_append(&c->mailbox, &m->mailbox_list_head);
+    c->mailbox_len++;
+    c->mailbox_bytes += mailbox_message_bytes(m);
+    if (!c->mailbox_save) {
+        // all other messages have been matched already, so receive resumes from this one
+        c->mailbox_save = &m->mailbox_list_head;
+    }
 
     if (c->jump_to_on_restore) {
         c->saved_ip = c->jump_to_on_restore;
@@ -54,22 +75,56 @@ void mailbox_send(Context *c, term t)
     scheduler_make_ready(c->global, c);
 }
 
-term mailbox_receive(Context *c)
+// removes a message from the mailbox, receive goes on with the following one if it was going to match it
+static void mailbox_unlink(Context *c, Message *m)
 {
-    Message *m = GET_LIST_ENTRY(c->mailbox, Message, mailbox_list_head);
-    linkedlist_remove(&c->mailbox, &m->mailbox_list_head);
+    struct ListHead *item = &m->mailbox_list_head;
+    if (c->mailbox_save == item) {
+        c->mailbox_save = (item->next != c->mailbox) ? item->next : NULL;
+    }
+    if (c->mailbox_mark == item) {
+        c->mailbox_mark_label = NULL;
+    }
+    linkedlist_remove(&c->mailbox, item);
+    c->mailbox_len--;
+    c->mailbox_bytes -= mailbox_message_bytes(m);
+}
 
-    if (c->e - c->heap_ptr < m->msg_memory_size) {
-        //ADDITIONAL_PROCESSING_MEMORY_SIZE: ensure some additional memory for message processing, so there is
-        //no need to run GC again.
-        if (UNLIKELY(memory_gc(c, context_memory_size(c) + m->msg_memory_size + ADDITIONAL_PROCESSING_MEMORY_SIZE) != MEMORY_GC_OK)) {
-            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
-        }
+// the process is going to reference message terms in place, so message memory becomes part of its heap
+static void mailbox_attach_message(Context *c, Message *m)
+{
+    if (!m->attached) {
+        m->attached = 1;
+        c->heap_fragments_size += m->msg_memory_size;
+    }
+}
+
+// message has been removed from the mailbox, its memory is kept until the next collection when the process might
+// still reference its terms
+static void mailbox_release_message(Context *c, Message *m)
+{
+    if (m->attached && m->msg_memory_size) {
+        linkedlist_append(&c->heap_fragments, &m->mailbox_list_head);
+    } else {
+        mailbox_destroy_message(c, m);
+    }
+}
+
+term mailbox_receive(Context *c)
+{
+    //ADDITIONAL_PROCESSING_MEMORY_SIZE: ensure some additional memory for message processing, so there is
+    //no need to run GC again.
+    if (UNLIKELY(memory_ensure_free(c, ADDITIONAL_PROCESSING_MEMORY_SIZE) != MEMORY_GC_OK)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
     }
 
-    term rt = memory_copy_term_tree(&c->heap_ptr, m->message);
+    // garbage collection might have replaced the message, so it is fetched only now
+    Message *m = GET_LIST_ENTRY(c->mailbox, Message, mailbox_list_head);
+    mailbox_unlink(c, m);
 
-    free(m);
+    mailbox_attach_message(c, m);
+    term rt = m->message;
+    mailbox_release_message(c, m);
 
     TRACE("Pid %i is receiving 0x%lx.\n", c->process_id, rt);
 
@@ -79,43 +134,170 @@ term mailbox_receive(Context *c)
 Message *mailbox_dequeue(Context *c)
 {
     Message *m = GET_LIST_ENTRY(c->mailbox, Message, mailbox_list_head);
-    linkedlist_remove(&c->mailbox, &m->mailbox_list_head);
+    mailbox_unlink(c, m);
 
     TRACE("Pid %i is dequeueing 0x%lx.\n", c->process_id, m->message);
 
     return m;
 }
 
+void mailbox_destroy_message(Context *c, Message *m)
+{
+    messagepool_free(c->global->message_pool, m, m->msg_buffer_size);
+}
+
 term mailbox_peek(Context *c)
 {
-    Message *m = GET_LIST_ENTRY(c->mailbox, Message, mailbox_list_head);
+    //ADDITIONAL_PROCESSING_MEMORY_SIZE: ensure some additional memory for message processing, so there is
+    //no need to run GC again.
+    if (UNLIKELY(memory_ensure_free(c, ADDITIONAL_PROCESSING_MEMORY_SIZE) != MEMORY_GC_OK)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+    }
+
+    // garbage collection might have replaced the message, so it is fetched only now
+    Message *m = GET_LIST_ENTRY(c->mailbox_save, Message, mailbox_list_head);
 
     TRACE("Pid %i is peeking 0x%lx.\n", c->process_id, m->message);
 
-    if (c->e - c->heap_ptr < m->msg_memory_size) {
-        //ADDITIONAL_PROCESSING_MEMORY_SIZE: ensure some additional memory for message processing, so there is
-        //no need to run GC again.
-        if (UNLIKELY(memory_gc(c, context_memory_size(c) + m->msg_memory_size + ADDITIONAL_PROCESSING_MEMORY_SIZE) != MEMORY_GC_OK)) {
-            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
-        }
+    mailbox_attach_message(c, m);
+
+    return m->message;
+}
+
+void mailbox_next(Context *c)
+{
+    struct ListHead *item = c->mailbox_save;
+    Message *m = GET_LIST_ENTRY(item, Message, mailbox_list_head);
+
+    TRACE("Pid %i is skipping 0x%lx.\n", c->process_id, m->message);
+
+    // the skipped message is not referenced anymore, so it is detached unless a collection moved it to the heap
+    if (m->attached && m->msg_memory_size) {
+        m->attached = 0;
+        c->heap_fragments_size -= m->msg_memory_size;
     }
 
-    term rt = memory_copy_term_tree(&c->heap_ptr, m->message);
+    c->mailbox_save = (item->next != c->mailbox) ? item->next : NULL;
+}
 
-    return rt;
+void mailbox_reset(Context *c)
+{
+    c->mailbox_save = c->mailbox;
+    c->mailbox_mark_label = NULL;
+}
+
+void mailbox_mark(Context *c, const void *label)
+{
+    c->mailbox_mark = c->mailbox ? c->mailbox->prev : NULL;
+    c->mailbox_mark_label = label;
+}
+
+void mailbox_set_to_mark(Context *c, const void *label)
+{
+    if (c->mailbox_mark_label != label) {
+        return;
+    }
+
+    if (!c->mailbox_mark) {
+        // all queued messages have been received after the mark
+        c->mailbox_save = c->mailbox;
+    } else {
+        c->mailbox_save = (c->mailbox_mark->next != c->mailbox) ? c->mailbox_mark->next : NULL;
+    }
 }
 
 void mailbox_remove(Context *c)
 {
-    if (!c->mailbox) {
+    if (!c->mailbox_save) {
         TRACE("Pid %i tried to remove a message from an empty mailbox.\n", c->process_id);
         return;
     }
 
-    Message *m = GET_LIST_ENTRY(c->mailbox, Message, mailbox_list_head);
-    linkedlist_remove(&c->mailbox, &m->mailbox_list_head);
+    Message *m = GET_LIST_ENTRY(c->mailbox_save, Message, mailbox_list_head);
+    mailbox_unlink(c, m);
 
     TRACE("Pid %i is removing a message.\n", c->process_id);
 
-    free(m);
+    mailbox_release_message(c, m);
+
+    // next receive matches queued messages from the first one
+    mailbox_reset(c);
+}
+
+// message terms have been moved to the heap, so only the message header is kept in the mailbox
+static void mailbox_shrink_message(Context *c, Message *m)
+{
+    c->mailbox_bytes -= m->msg_memory_size * sizeof(term);
+
+    Message *header = messagepool_alloc(c->global->message_pool, sizeof(Message));
+    if (IS_NULL_PTR(header)) {
+        // message memory is just kept until the message is removed
+        m->msg_memory_size = 0;
+        return;
+    }
+    header->msg_buffer_size = sizeof(Message);
+    header->msg_memory_size = 0;
+    header->attached = 1;
+    header->message = m->message;
+
+    struct ListHead *item = &m->mailbox_list_head;
+    if (item->next == item) {
+        linkedlist_insert(&header->mailbox_list_head, &header->mailbox_list_head, &header->mailbox_list_head);
+    } else {
+        linkedlist_insert(&header->mailbox_list_head, item->prev, item->next);
+    }
+    if (c->mailbox == item) {
+        c->mailbox = &header->mailbox_list_head;
+    }
+    if (c->mailbox_save == item) {
+        c->mailbox_save = &header->mailbox_list_head;
+    }
+    if (c->mailbox_mark == item) {
+        c->mailbox_mark = &header->mailbox_list_head;
+    }
+
+    mailbox_destroy_message(c, m);
+}
+
+void mailbox_release_heap_fragments(Context *c)
+{
+    while (c->heap_fragments) {
+        Message *m = GET_LIST_ENTRY(c->heap_fragments, Message, mailbox_list_head);
+        linkedlist_remove(&c->heap_fragments, &m->mailbox_list_head);
+        mailbox_destroy_message(c, m);
+    }
+
+    if (c->mailbox) {
+        // messages might be replaced while iterating, so the last one is remembered
+        struct ListHead *last = c->mailbox->prev;
+        struct ListHead *item = c->mailbox;
+        int is_last;
+        do {
+            struct ListHead *next = item->next;
+            is_last = (item == last);
+            Message *m = GET_LIST_ENTRY(item, Message, mailbox_list_head);
+            if (m->attached && m->msg_memory_size) {
+                mailbox_shrink_message(c, m);
+            }
+            item = next;
+        } while (!is_last);
+    }
+
+    c->heap_fragments_size = 0;
+}
+
+void mailbox_destroy(Context *c)
+{
+    while (c->mailbox) {
+        Message *m = GET_LIST_ENTRY(c->mailbox, Message, mailbox_list_head);
+        mailbox_unlink(c, m);
+        mailbox_destroy_message(c, m);
+    }
+
+    while (c->heap_fragments) {
+        Message *m = GET_LIST_ENTRY(c->heap_fragments, Message, mailbox_list_head);
+        linkedlist_remove(&c->heap_fragments, &m->mailbox_list_head);
+        mailbox_destroy_message(c, m);
+    }
+    c->heap_fragments_size = 0;
 }
@@ -35,6 +35,11 @@ typedef struct
 {
     struct ListHead mailbox_list_head;
     int msg_memory_size;
+    // buffer size in bytes, as it has been allocated from the message pool
+    int msg_buffer_size;
+    // set once the receiving process references message terms in place: the message is then a garbage collection
+    // root and its memory is a heap fragment, until the next copying collection moves its terms to the heap
+    int attached;
     term message;
 } Message;
 
@@ -50,7 +55,8 @@ void mailbox_send(Context *c, term t);
 /**
  * @brief Gets next message from a mailbox.
  *
- * @details Dequeue a term that has been previously queued on a certain process or driver mailbox.
+ * @details Dequeue a term that has been previously queued on a certain process or driver mailbox, the term is not
+ * copied: it is referenced in place until the next garbage collection moves it to the process heap.
  * @param c the process or driver context.
  * @returns next queued term.
  */
@@ -61,25 +67,91 @@ term mailbox_receive(Context *c);
  *
  * @details Dequeue a message that has been previously queued on a certain process or driver mailbox.
  * @param c the process or driver context.
- * @returns dequeued message, the caller must free() the message.
+ * @returns dequeued message, the caller must release it using mailbox_destroy_message.
  */
 Message *mailbox_dequeue(Context *c);
 
 /**
- * @brief Gets next message from a mailbox (without removing it).
+ * @brief Releases a dequeued message.
  *
- * @details Peek the mailbox and retrieve a term that has been previously queued on a certain process or driver mailbox.
+ * @details Message buffer is given back to the message pool, its terms must not be referenced anymore.
+ * @param c the process or driver context the message has been dequeued from.
+ * @param m the message that will be released.
+ */
+void mailbox_destroy_message(Context *c, Message *m);
+
+/**
+ * @brief Gets the message that receive is going to match (without removing it).
+ *
+ * @details Peek the mailbox and retrieve a term that has been previously queued on a certain process or driver mailbox,
+ * the term is referenced in place as mailbox_receive does. Receive matches queued messages starting from the first one
+ * and mailbox_next moves to the following one, there must be a message to match.
  * @param c the process or driver context.
  * @returns peek queued term.
  */
 term mailbox_peek(Context *c);
 
 /**
- * @brief Remove next message from mailbox.
+ * @brief Skips the message that receive is matching.
+ *
+ * @details The message is kept in the mailbox and receive goes on with the following one, if any. The term returned by
+ * mailbox_peek must not be referenced anymore.
+ * @param c the process or driver context.
+ */
+void mailbox_next(Context *c);
+
+/**
+ * @brief Makes receive match queued messages from the first one.
+ *
+ * @details Mailbox mark is discarded as well.
+ * @param c the process or driver context.
+ */
+void mailbox_reset(Context *c);
+
+/**
+ * @brief Marks the messages that are currently queued.
+ *
+ * @details A receive that can only match messages queued after the mark, such as a reply that contains a newly
+ * created reference, skips marked messages once mailbox_set_to_mark is called with the same label.
+ * @param c the process context.
+ * @param label the address of the receive that is going to use the mark.
+ */
+void mailbox_mark(Context *c, const void *label);
+
+/**
+ * @brief Makes receive match only messages queued after the mark.
  *
- * @details Discard a term that has been previously queued on a certain process or driver mailbox.
+ * @details Nothing is done when the mark has been set for a different label or it is not valid anymore, such as when
+ * a marked message has been removed: receive matches all queued messages in that case.
+ * @param c the process context.
+ * @param label the address of the receive that is going to match messages.
+ */
+void mailbox_set_to_mark(Context *c, const void *label);
+
+/**
+ * @brief Remove the message that receive is matching from mailbox.
+ *
+ * @details Discard a term that has been previously queued on a certain process or driver mailbox, next receive matches
+ * queued messages from the first one.
  * @param c the process or driver context.
  */
 void mailbox_remove(Context *c);
 
+/**
+ * @brief Releases message memory that has been moved to the process heap.
+ *
+ * @details Called by garbage collections once they copied terms referenced in place to the process heap: heap
+ * fragments are released and the memory of attached messages that are still queued is released as well.
+ * @param c the process context.
+ */
+void mailbox_release_heap_fragments(Context *c);
+
+/**
+ * @brief Releases all messages and heap fragments of a process.
+ *
+ * @details Called when the process is destroyed.
+ * @param c the process or driver context.
+ */
+void mailbox_destroy(Context *c);
+
 #endif
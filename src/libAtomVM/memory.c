@@ -17,12 +17,16 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
  ***************************************************************************/
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "context.h"
 #include "debug.h"
+#include "heappool.h"
+#include "mailbox.h"
 #include "memory.h"
+#include "sys.h"
 
 //#define ENABLE_TRACE
 
@@ -32,8 +36,103 @@
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
-static void memory_scan_and_copy(term *mem_start, const term *mem_end, term **new_heap_pos, int move);
-static term memory_shallow_copy_term(term t, term **new_heap, int move);
+// old heap is grown to this many times the size of the terms that might be promoted
+#define OLD_HEAP_GROWTH_COEFF 2
+
+// first sizes of the Fibonacci-like heap sizes sequence, above the threshold heaps grow by 20% each step
+#define FIBONACCI_HEAP_SIZE_A 12
+#define FIBONACCI_HEAP_SIZE_B 38
+#define FIBONACCI_HEAP_GEOMETRIC_THRESHOLD (1024 * 1024)
+
+// a collection that leaves less than 1/LOW_OCCUPANCY_COEFF of the memory block used is a low occupancy one
+#define LOW_OCCUPANCY_COEFF 4
+#define SHRINK_AFTER_LOW_OCCUPANCY_GCS 3
+// heap is grown before collecting when the previous collection left it more than 3/4 full
+#define HIGH_OCCUPANCY_NUM 3
+#define HIGH_OCCUPANCY_DEN 4
+
+// incremental collections check the elapsed time every time this many terms have been scanned
+#define INCREMENTAL_GC_SCAN_CHUNK_SIZE 256
+// incremental collections are completed once no more than this many terms have been allocated or written since the
+// snapshot has been extended, so the final pause does not depend on the heap size
+#define INCREMENTAL_GC_FINISH_MAX_TERMS 4096
+
+// objects that are tracked by a sharing table before it allocates memory
+#define SHARING_TABLE_INLINE_SIZE 32
+// terms up to this size are estimated without tracking shared subterms
+#define ESTIMATE_FLAT_MAX_SIZE 256
+
+struct SharingTable;
+
+struct CopyState
+{
+    // copied terms are appended here
+    term *heap_pos;
+
+    // terms in [mature_start, mature_end) are promoted: they are copied to old_heap_pos instead
+    const term *mature_start;
+    const term *mature_end;
+    term *old_heap_pos;
+
+    // terms in [shared_start, shared_end) are left in place, such as the old heap during a minor collection
+    const term *shared_start;
+    const term *shared_end;
+
+    // when set, copied terms are replaced with moved markers
+    int move;
+
+    // incremental collections cannot replace terms with moved markers, since the process is still using them: the copy
+    // of the term at forwarding_start + i is stored at forwarding[i] instead
+    term *forwarding;
+    const term *forwarding_start;
+    const term *forwarding_end;
+
+    // when set, only terms in [forwarding_start, forwarding_end) are copied, others are left in place
+    int forwarded_only;
+
+    // when set, terms that are referenced more than once are copied only once, see memory_copy_term_tree
+    struct SharingTable *sharing;
+};
+
+// an incremental collection copies live terms to a new memory block in bounded steps, while the process keeps running
+// on its current memory block, that is never modified until the collection is completed
+struct IncrementalGC
+{
+    struct CopyState state;
+
+    term *new_heap;
+    unsigned long new_size;
+    term *scan_pos;
+
+    // stack terms are copied in chunks starting from the stack base, this is the count of copied ones
+    unsigned long stack_copied;
+    int stack_pending;
+
+    // terms modified by the process after the snapshot has been taken, they are copied again when the snapshot is
+    // extended or the collection is completed
+    term *written_terms;
+    int written_terms_count;
+    int written_terms_size;
+};
+
+static term *memory_scan_and_copy(term *mem_start, const term *mem_end, struct CopyState *state);
+static term memory_shallow_copy_term(term t, struct CopyState *state);
+static void memory_copy_pending_terms(struct CopyState *state, term *scan_start, term *old_scan_start);
+static enum MemoryGCResult memory_compacting_gc(Context *ctx, int new_size);
+static void memory_finish_incremental_gc(Context *ctx);
+static Message *memory_next_message(const Context *ctx, const Message *m);
+
+struct LiteralArea
+{
+    const term *start;
+    const term *end;
+};
+
+// literal areas are sorted by address, lowest and highest addresses allow to quickly skip heap pointers
+static struct LiteralArea *literal_areas;
+static int literal_areas_count;
+static const term *literal_areas_lowest;
+static const term *literal_areas_highest;
 
 HOT_FUNC term *memory_heap_alloc(Context *c, uint32_t size)
 {
@@ -47,24 +146,150 @@ HOT_FUNC term *memory_heap_alloc(Context *c, uint32_t size)
     return allocated;
 }
 
+unsigned long memory_next_fibonacci_heap_size(unsigned long size)
+{
+    unsigned long previous = FIBONACCI_HEAP_SIZE_A;
+    unsigned long current = FIBONACCI_HEAP_SIZE_B;
+
+    if (size <= previous) {
+        return previous;
+    }
+
+    while (current < size) {
+        unsigned long next;
+        if (current < FIBONACCI_HEAP_GEOMETRIC_THRESHOLD) {
+            next = previous + current + 1;
+        } else {
+            next = current + current / 5;
+        }
+        previous = current;
+        current = next;
+    }
+
+    return current;
+}
+
+unsigned long memory_heap_target_size(const Context *ctx, unsigned long size)
+{
+    unsigned long target_size;
+    switch (ctx->heap_growth) {
+        case FibonacciHeapGrowth:
+            target_size = memory_next_fibonacci_heap_size(size);
+            break;
+
+        case MinimumHeapGrowth:
+        default:
+            target_size = size;
+            break;
+    }
+
+    if (ctx->has_min_heap_size && (target_size < (unsigned long) ctx->min_heap_size)) {
+        target_size = ctx->min_heap_size;
+    }
+
+    if (ctx->has_max_heap_size) {
+        // rounding up must not deny an allocation that would fit, old heap terms are accounted as in memory_gc
+        long old_heap_used = ctx->old_heap_ptr - ctx->old_heap_start;
+        long max_size = ctx->max_heap_size - old_heap_used;
+        if ((max_size >= 0) && (target_size > (unsigned long) max_size) && (size <= (unsigned long) max_size)) {
+            target_size = max_size;
+        }
+    }
+
+    return target_size;
+}
+
+// returns the size of the terms that a collection might copy: heap fragments are moved to the new heap as well
+static inline unsigned long memory_used_size(const Context *ctx)
+{
+    return context_memory_size(ctx) - context_avail_free_memory(ctx) + ctx->heap_fragments_size;
+}
+
+// returns the size the memory block should be shrunk to, or 0 when it should be kept as it is
+static unsigned long memory_shrink_size(const Context *ctx, uint32_t size)
+{
+    unsigned long memory_size = context_memory_size(ctx);
+    unsigned long used_size = memory_used_size(ctx);
+    unsigned long new_size;
+
+    switch (ctx->heap_growth) {
+        case FibonacciHeapGrowth:
+            if (ctx->low_occupancy_gcs < SHRINK_AFTER_LOW_OCCUPANCY_GCS) {
+                return 0;
+            }
+            new_size = memory_heap_target_size(ctx, 2 * (used_size + size + MIN_FREE_SPACE_SIZE));
+            break;
+
+        case MinimumHeapGrowth:
+        default:
+            new_size = memory_heap_target_size(ctx, used_size + 2 * (size + MIN_FREE_SPACE_SIZE));
+            break;
+    }
+
+    return (new_size < memory_size) ? new_size : 0;
+}
+
+// returns the size of the memory block used by a collection that must make room for size terms
+static unsigned long memory_grow_size(const Context *ctx, uint32_t size)
+{
+    unsigned long memory_size = context_memory_size(ctx);
+    unsigned long used_size = memory_used_size(ctx);
+
+    if (ctx->heap_growth == FibonacciHeapGrowth) {
+        // a memory block as big as the used memory is always enough, since only live terms are copied: the heap is
+        // grown only when the previous collection found it mostly full, so the live set is likely to be growing
+        unsigned long previous_live_size = (ctx->high_water_mark - ctx->heap_start) + context_stack_size(ctx);
+        if ((previous_live_size + size + MIN_FREE_SPACE_SIZE) * HIGH_OCCUPANCY_DEN <= memory_size * HIGH_OCCUPANCY_NUM) {
+            return memory_heap_target_size(ctx, used_size);
+        }
+    }
+
+    return memory_heap_target_size(ctx, used_size + size + MIN_FREE_SPACE_SIZE);
+}
+
 enum MemoryGCResult memory_ensure_free(Context *c, uint32_t size)
+{
+    return memory_ensure_free_opt(c, size, MEMORY_NO_SHRINK);
+}
+
+enum MemoryGCResult memory_ensure_free_opt(Context *c, uint32_t size, enum MemoryAllocMode alloc_mode)
 {
     size_t free_space = context_avail_free_memory(c);
+    // heap fragments are moved to the heap by the next collection, so they take room from it
+    free_space = (free_space > c->heap_fragments_size) ? free_space - c->heap_fragments_size : 0;
+    if (c->incremental_gc && !c->heap_fragments_size && (free_space < size + MIN_FREE_SPACE_SIZE)) {
+        // completing the collection in progress is cheaper than starting a new one
+        memory_finish_incremental_gc(c);
+        free_space = context_avail_free_memory(c);
+    }
+
     if (free_space < size + MIN_FREE_SPACE_SIZE) {
-        size_t memory_size = context_memory_size(c);
-        if (UNLIKELY(memory_gc(c, memory_size + size + MIN_FREE_SPACE_SIZE) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_gc(c, memory_grow_size(c, size)) != MEMORY_GC_OK)) {
             //TODO: handle this more gracefully
             TRACE("Unable to allocate memory for GC\n");
             return MEMORY_GC_ERROR_FAILED_ALLOCATION;
         }
-        size_t new_free_space = context_avail_free_memory(c);
-        size_t new_minimum_free_space = 2 * (size + MIN_FREE_SPACE_SIZE);
-        if (new_free_space > new_minimum_free_space) {
-            size_t new_memory_size = context_memory_size(c);
-            if (UNLIKELY(memory_gc(c, (new_memory_size - new_free_space) + new_minimum_free_space) != MEMORY_GC_OK)) {
-                TRACE("Unable to allocate memory for GC shrink\n");
+
+        if (context_avail_free_memory(c) < size + MIN_FREE_SPACE_SIZE) {
+            // live terms did not leave enough room, so the heap is grown
+            size_t used_size = memory_used_size(c);
+            if (UNLIKELY(memory_gc(c, memory_heap_target_size(c, used_size + size + MIN_FREE_SPACE_SIZE)) != MEMORY_GC_OK)) {
+                TRACE("Unable to allocate memory for GC\n");
                 return MEMORY_GC_ERROR_FAILED_ALLOCATION;
             }
+        } else {
+            alloc_mode = MEMORY_CAN_SHRINK;
+        }
+
+    } else if ((alloc_mode == MEMORY_CAN_SHRINK) && (free_space <= (size + MIN_FREE_SPACE_SIZE) * HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF)) {
+        alloc_mode = MEMORY_NO_SHRINK;
+    }
+
+    if (alloc_mode == MEMORY_CAN_SHRINK) {
+        unsigned long new_size = memory_shrink_size(c, size);
+        if (new_size && UNLIKELY(memory_gc(c, new_size) != MEMORY_GC_OK)) {
+            TRACE("Unable to allocate memory for GC shrink\n");
+            return MEMORY_GC_ERROR_FAILED_ALLOCATION;
         }
     }
 
@@ -74,7 +299,7 @@ enum MemoryGCResult memory_ensure_free(Context *c, uint32_t size)
 enum MemoryGCResult memory_gc_and_shrink(Context *c)
 {
     if (context_avail_free_memory(c) >= MIN_FREE_SPACE_SIZE * 2) {
-        if (UNLIKELY(memory_gc(c, context_memory_size(c) - context_avail_free_memory(c) / 2) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_gc(c, memory_used_size(c) + context_avail_free_memory(c) / 2) != MEMORY_GC_OK)) {
             fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         }
     }
@@ -88,26 +313,83 @@ static inline void push_to_stack(term **stack, term value)
     **stack = value;
 }
 
-enum MemoryGCResult memory_gc(Context *ctx, int new_size)
+// returns the terms of a written term that might reference other terms
+static term *memory_written_term_fields(term t, int *fields_count)
 {
-    TRACE("Going to perform gc\n");
+    if (term_is_nonempty_list(t)) {
+        *fields_count = 2;
+        return term_get_list_ptr(t);
+    }
 
-    if (UNLIKELY(ctx->has_max_heap_size && (new_size > ctx->max_heap_size))) {
-        return MEMORY_GC_DENIED_ALLOCATION;
+    term *boxed_value = term_to_term_ptr(t);
+    switch (boxed_value[0] & TERM_BOXED_TAG_MASK) {
+        case TERM_BOXED_TUPLE:
+            *fields_count = term_boxed_size(t);
+            return boxed_value + 1;
+
+        case TERM_BOXED_FUN:
+            // first term is the boxed header, followed by module and fun index.
+            *fields_count = term_boxed_size(t) - 2;
+            return boxed_value + 3;
+
+        default:
+            *fields_count = 0;
+            return boxed_value;
+    }
+}
+
+static inline int memory_is_young_term(const Context *ctx, term t)
+{
+    const term *ptr;
+    if (term_is_boxed(t)) {
+        ptr = term_to_const_term_ptr(t);
+    } else if (term_is_nonempty_list(t)) {
+        ptr = term_get_list_ptr(t);
+    } else {
+        return 0;
+    }
+
+    return (ptr >= ctx->heap_start) && (ptr < ctx->heap_ptr);
+}
+
+// remembered terms that do not reference young terms anymore are removed, once they have been collected
+static void memory_prune_remembered_set(Context *ctx)
+{
+    int count = 0;
+    for (int i = 0; i < ctx->remembered_set_count; i++) {
+        int fields_count;
+        term *fields = memory_written_term_fields(ctx->remembered_set[i], &fields_count);
+        for (int j = 0; j < fields_count; j++) {
+            if (memory_is_young_term(ctx, fields[j])) {
+                ctx->remembered_set[count] = ctx->remembered_set[i];
+                count++;
+                break;
+            }
+        }
     }
+    ctx->remembered_set_count = count;
+}
 
-    term *new_heap = calloc(new_size, sizeof(term));
+static int memory_copy_roots(Context *ctx, int new_size, struct CopyState *state)
+{
+    unsigned long capacity;
+    term *new_heap = heappool_alloc(ctx->global->heap_pool, new_size, &capacity);
     if (IS_NULL_PTR(new_heap)) {
-        return MEMORY_GC_ERROR_FAILED_ALLOCATION;
+        return 0;
+    }
+    // the whole memory block is used, unless the heap size is limited
+    if (!ctx->has_max_heap_size) {
+        new_size = capacity;
     }
     term *new_stack = new_heap + new_size;
 
-    term *heap_ptr = new_heap;
+    state->heap_pos = new_heap;
     term *stack_ptr = new_stack;
+    term *old_scan_start = state->old_heap_pos;
 
     TRACE("- Running copy GC on registers\n");
     for (int i = 0; i < ctx->avail_registers; i++) {
-        term new_root = memory_shallow_copy_term(ctx->x[i], &heap_ptr, 1);
+        term new_root = memory_shallow_copy_term(ctx->x[i], state);
         ctx->x[i] = new_root;
     }
 
@@ -115,31 +397,197 @@ enum MemoryGCResult memory_gc(Context *ctx, int new_size)
     int stack_size = ctx->stack_base - ctx->e;
     TRACE("- Running copy GC on stack (stack size: %i)\n", stack_size);
     for (int i = stack_size - 1; i >= 0; i--) {
-        term new_root = memory_shallow_copy_term(stack[i], &heap_ptr, 1);
+        term new_root = memory_shallow_copy_term(stack[i], state);
         push_to_stack(&stack_ptr, new_root);
     }
 
-    term *temp_start = new_heap;
-    term *temp_end = heap_ptr;
-    do {
-        term *next_end = temp_end;
-        memory_scan_and_copy(temp_start, temp_end, &next_end, 1);
-        temp_start = temp_end;
-        temp_end = next_end;
-    } while (temp_start != temp_end);
+    TRACE("- Running copy GC on attached messages\n");
+    for (Message *m = memory_next_message(ctx, NULL); m; m = memory_next_message(ctx, m)) {
+        if (m->attached) {
+            m->message = memory_shallow_copy_term(m->message, state);
+        }
+    }
+
+    // the old heap is left in place by minor collections, written old terms are roots then
+    if (state->shared_start) {
+        TRACE("- Running copy GC on remembered set\n");
+        for (int i = 0; i < ctx->remembered_set_count; i++) {
+            int fields_count;
+            term *fields = memory_written_term_fields(ctx->remembered_set[i], &fields_count);
+            for (int j = 0; j < fields_count; j++) {
+                fields[j] = memory_shallow_copy_term(fields[j], state);
+            }
+        }
+    }
 
-    heap_ptr = temp_end;
+    memory_copy_pending_terms(state, new_heap, old_scan_start);
 
-    free(ctx->heap_start);
+    // heap fragment terms have been copied as well
+    mailbox_release_heap_fragments(ctx);
+    heappool_free(ctx->global->heap_pool, ctx->heap_start, context_memory_size(ctx));
 
     ctx->heap_start = new_heap;
     ctx->stack_base = ctx->heap_start + new_size;
-    ctx->heap_ptr = heap_ptr;
+    ctx->heap_ptr = state->heap_pos;
     ctx->e = stack_ptr;
 
+    // everything that survived this collection is going to be promoted by the next minor collection
+    ctx->high_water_mark = ctx->heap_ptr;
+
+    return 1;
+}
+
+// copies all live terms, both young and old ones, to a new heap and releases the old heap
+static enum MemoryGCResult memory_major_gc(Context *ctx, int new_size)
+{
+    TRACE("- Running major GC\n");
+
+    struct CopyState state;
+    state.mature_start = NULL;
+    state.mature_end = NULL;
+    state.old_heap_pos = NULL;
+    state.shared_start = NULL;
+    state.shared_end = NULL;
+    state.move = 1;
+    state.forwarding = NULL;
+    state.forwarding_start = NULL;
+    state.forwarding_end = NULL;
+    state.forwarded_only = 0;
+    state.sharing = NULL;
+
+    if (UNLIKELY(!memory_copy_roots(ctx, new_size, &state))) {
+        return MEMORY_GC_ERROR_FAILED_ALLOCATION;
+    }
+
+    heappool_free(ctx->global->heap_pool, ctx->old_heap_start, context_old_heap_memory_size(ctx));
+    ctx->old_heap_start = NULL;
+    ctx->old_heap_ptr = NULL;
+    ctx->old_heap_end = NULL;
+    ctx->remembered_set_count = 0;
+
+    ctx->minor_gcs = 0;
+
+    return MEMORY_GC_OK;
+}
+
+// copies only young terms: terms that survived the previous collection are promoted to the old heap, that is not
+// scanned since old terms reference younger ones only when they are in the remembered set
+static enum MemoryGCResult memory_minor_gc(Context *ctx, int new_size)
+{
+    TRACE("- Running minor GC\n");
+
+    int mature_size = ctx->high_water_mark - ctx->heap_start;
+    if (mature_size && !ctx->old_heap_start) {
+        unsigned long old_heap_size;
+        ctx->old_heap_start = heappool_alloc(ctx->global->heap_pool, mature_size * OLD_HEAP_GROWTH_COEFF, &old_heap_size);
+        if (IS_NULL_PTR(ctx->old_heap_start)) {
+            return MEMORY_GC_ERROR_FAILED_ALLOCATION;
+        }
+        ctx->old_heap_ptr = ctx->old_heap_start;
+        ctx->old_heap_end = ctx->old_heap_start + old_heap_size;
+    }
+
+    struct CopyState state;
+    state.mature_start = ctx->heap_start;
+    state.mature_end = ctx->high_water_mark;
+    state.old_heap_pos = ctx->old_heap_ptr;
+    state.shared_start = ctx->old_heap_start;
+    state.shared_end = ctx->old_heap_end;
+    state.move = 1;
+    state.forwarding = NULL;
+    state.forwarding_start = NULL;
+    state.forwarding_end = NULL;
+    state.forwarded_only = 0;
+    state.sharing = NULL;
+
+    if (UNLIKELY(!memory_copy_roots(ctx, new_size, &state))) {
+        return MEMORY_GC_ERROR_FAILED_ALLOCATION;
+    }
+
+    ctx->old_heap_ptr = state.old_heap_pos;
+    ctx->minor_gcs++;
+    memory_prune_remembered_set(ctx);
+
     return MEMORY_GC_OK;
 }
 
+static int memory_is_minor_gc_allowed(const Context *ctx)
+{
+    if (ctx->minor_gcs >= ctx->fullsweep_after) {
+        return 0;
+    }
+
+    // terms below high water mark might be promoted, when old heap has not enough room a major gc is required
+    int mature_size = ctx->high_water_mark - ctx->heap_start;
+    return !ctx->old_heap_start || (ctx->old_heap_end - ctx->old_heap_ptr >= mature_size);
+}
+
+// collections that leave old terms in place are allowed unless a major collection is due, since old terms are moved
+// to the young heap only by a major collection
+static int memory_is_young_gc_allowed(const Context *ctx)
+{
+    return !ctx->old_heap_start || memory_is_minor_gc_allowed(ctx);
+}
+
+// compacting and incremental collections leave terms that are not on the heap in place, so heap fragments are moved
+// to the heap only by copying collections
+static int memory_is_compacting_gc_allowed(const Context *ctx)
+{
+    return (context_memory_size(ctx) >= ctx->compacting_gc_threshold) && !ctx->heap_fragments_size
+        && memory_is_young_gc_allowed(ctx);
+}
+
+static void memory_update_occupancy(Context *ctx)
+{
+    unsigned long used_size = context_memory_size(ctx) - context_avail_free_memory(ctx);
+    if (used_size * LOW_OCCUPANCY_COEFF < context_memory_size(ctx)) {
+        ctx->low_occupancy_gcs++;
+    } else {
+        ctx->low_occupancy_gcs = 0;
+    }
+}
+
+// iterates over queued messages: attached ones are roots, as registers and stack are
+static Message *memory_next_message(const Context *ctx, const Message *m)
+{
+    struct ListHead *item = m ? m->mailbox_list_head.next : ctx->mailbox;
+    if (!item || (m && (item == ctx->mailbox))) {
+        return NULL;
+    }
+
+    return GET_LIST_ENTRY(item, Message, mailbox_list_head);
+}
+
+enum MemoryGCResult memory_gc(Context *ctx, int new_size)
+{
+    TRACE("Going to perform gc\n");
+
+    // the collection in progress is discarded, this one collects all young terms anyway
+    if (ctx->incremental_gc) {
+        memory_cancel_incremental_gc(ctx);
+    }
+
+    int old_heap_used = ctx->old_heap_ptr - ctx->old_heap_start;
+    if (UNLIKELY(ctx->has_max_heap_size && (new_size + old_heap_used > ctx->max_heap_size))) {
+        return MEMORY_GC_DENIED_ALLOCATION;
+    }
+
+    enum MemoryGCResult result;
+    if (memory_is_compacting_gc_allowed(ctx)) {
+        result = memory_compacting_gc(ctx, new_size);
+    } else if (memory_is_minor_gc_allowed(ctx)) {
+        result = memory_minor_gc(ctx, new_size);
+    } else {
+        // all old terms are moved to the new heap
+        result = memory_major_gc(ctx, new_size + old_heap_used);
+    }
+
+    if (result == MEMORY_GC_OK) {
+        memory_update_occupancy(ctx);
+    }
+
+    return result;
+}
 
 static inline int memory_is_moved_marker(term *t)
 {
@@ -158,26 +606,218 @@ static inline term memory_dereference_moved_marker(const term *moved_marker)
     return moved_marker[1];
 }
 
+static void literal_areas_update_bounds()
+{
+    if (literal_areas_count) {
+        literal_areas_lowest = literal_areas[0].start;
+        literal_areas_highest = literal_areas[literal_areas_count - 1].end;
+    } else {
+        literal_areas_lowest = NULL;
+        literal_areas_highest = NULL;
+    }
+}
+
+int memory_register_literal_area(const term *start, const term *end)
+{
+    struct LiteralArea *new_areas = realloc(literal_areas, (literal_areas_count + 1) * sizeof(struct LiteralArea));
+    if (IS_NULL_PTR(new_areas)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        return 0;
+    }
+    literal_areas = new_areas;
+
+    int i = literal_areas_count;
+    while ((i > 0) && (literal_areas[i - 1].start > start)) {
+        literal_areas[i] = literal_areas[i - 1];
+        i--;
+    }
+    literal_areas[i].start = start;
+    literal_areas[i].end = end;
+    literal_areas_count++;
+
+    literal_areas_update_bounds();
+
+    return 1;
+}
+
+void memory_unregister_literal_area(const term *start)
+{
+    for (int i = 0; i < literal_areas_count; i++) {
+        if (literal_areas[i].start == start) {
+            memmove(&literal_areas[i], &literal_areas[i + 1], (literal_areas_count - i - 1) * sizeof(struct LiteralArea));
+            literal_areas_count--;
+            break;
+        }
+    }
+
+    if (!literal_areas_count) {
+        free(literal_areas);
+        literal_areas = NULL;
+    }
+
+    literal_areas_update_bounds();
+}
+
+int memory_is_literal(const term *ptr)
+{
+    if ((ptr < literal_areas_lowest) || (ptr >= literal_areas_highest)) {
+        return 0;
+    }
+
+    int low = 0;
+    int high = literal_areas_count - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (ptr < literal_areas[middle].start) {
+            high = middle - 1;
+        } else if (ptr >= literal_areas[middle].end) {
+            low = middle + 1;
+        } else {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// copied objects are tracked by their source address, so an object that is referenced more than once is copied only
+// once and the copy keeps sharing it, the same table is used as a visited set when sizes are calculated
+struct SharingTable
+{
+    const term **keys;
+    term *values;
+    unsigned long capacity;
+    unsigned long count;
+
+    // most terms have only a few objects, they are tracked without allocating memory
+    const term *inline_keys[SHARING_TABLE_INLINE_SIZE];
+    term inline_values[SHARING_TABLE_INLINE_SIZE];
+};
+
+static inline void sharing_table_init(struct SharingTable *table)
+{
+    memset(table->inline_keys, 0, sizeof(table->inline_keys));
+    table->keys = table->inline_keys;
+    table->values = table->inline_values;
+    table->capacity = SHARING_TABLE_INLINE_SIZE;
+    table->count = 0;
+}
+
+static inline void sharing_table_destroy(struct SharingTable *table)
+{
+    if (table->keys != table->inline_keys) {
+        free(table->keys);
+        free(table->values);
+    }
+}
+
+static inline unsigned long sharing_table_index(const term **keys, unsigned long capacity, const term *ptr)
+{
+    // objects are term aligned, so lowest address bits are always 0
+    unsigned long hash = (unsigned long) (((uintptr_t) ptr) / sizeof(term)) * 2654435761UL;
+    unsigned long index = hash & (capacity - 1);
+
+    while (keys[index] && (keys[index] != ptr)) {
+        index = (index + 1) & (capacity - 1);
+    }
+
+    return index;
+}
+
+static void sharing_table_grow(struct SharingTable *table)
+{
+    unsigned long new_capacity = table->capacity * 2;
+    const term **new_keys = calloc(new_capacity, sizeof(const term *));
+    term *new_values = malloc(new_capacity * sizeof(term));
+    if (IS_NULL_PTR(new_keys) || IS_NULL_PTR(new_values)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (unsigned long i = 0; i < table->capacity; i++) {
+        if (table->keys[i]) {
+            unsigned long index = sharing_table_index(new_keys, new_capacity, table->keys[i]);
+            new_keys[index] = table->keys[i];
+            new_values[index] = table->values[i];
+        }
+    }
+
+    sharing_table_destroy(table);
+    table->keys = new_keys;
+    table->values = new_values;
+    table->capacity = new_capacity;
+}
+
+// returns the value stored for ptr, or 0 when there is none: copied terms are never 0
+static inline term sharing_table_get(const struct SharingTable *table, const term *ptr)
+{
+    unsigned long index = sharing_table_index(table->keys, table->capacity, ptr);
+
+    return table->keys[index] ? table->values[index] : 0;
+}
+
+static void sharing_table_put(struct SharingTable *table, const term *ptr, term value)
+{
+    // table is kept at most 3/4 full, so probe sequences are short
+    if ((table->count + 1) * 4 > table->capacity * 3) {
+        sharing_table_grow(table);
+    }
+
+    unsigned long index = sharing_table_index(table->keys, table->capacity, ptr);
+    if (!table->keys[index]) {
+        table->keys[index] = ptr;
+        table->count++;
+    }
+    table->values[index] = value;
+}
+
 term memory_copy_term_tree(term **new_heap, term t)
 {
     TRACE("Copy term tree: 0x%lx, heap: 0x%p\n", t, *new_heap);
 
-    term *temp_start = *new_heap;
-    term copied_term = memory_shallow_copy_term(t, new_heap, 0);
-    term *temp_end = *new_heap;
+    struct CopyState state;
+    state.heap_pos = *new_heap;
+    state.mature_start = NULL;
+    state.mature_end = NULL;
+    state.old_heap_pos = NULL;
+    state.shared_start = NULL;
+    state.shared_end = NULL;
+    state.move = 0;
+    state.forwarding = NULL;
+    state.forwarding_start = NULL;
+    state.forwarding_end = NULL;
+    state.forwarded_only = 0;
+
+    struct SharingTable sharing;
+    sharing_table_init(&sharing);
+    state.sharing = &sharing;
 
-    do {
-        term *next_end = temp_end;
-        memory_scan_and_copy(temp_start, temp_end, &next_end, 0);
-        temp_start = temp_end;
-        temp_end = next_end;
-    } while (temp_start != temp_end);
+    term *scan_start = *new_heap;
+    term copied_term = memory_shallow_copy_term(t, &state);
+    memory_copy_pending_terms(&state, scan_start, NULL);
 
-    *new_heap = temp_end;
+    sharing_table_destroy(&sharing);
+
+    *new_heap = state.heap_pos;
 
     return copied_term;
 }
 
+static void memory_copy_pending_terms(struct CopyState *state, term *scan_start, term *old_scan_start)
+{
+    // scanned terms might reference terms that have not been copied yet, they are appended to either of the two
+    // destinations, so both are scanned until there are no more new terms
+    while ((scan_start != state->heap_pos) || (old_scan_start != state->old_heap_pos)) {
+        term *scan_end = state->heap_pos;
+        memory_scan_and_copy(scan_start, scan_end, state);
+        scan_start = scan_end;
+
+        term *old_scan_end = state->old_heap_pos;
+        memory_scan_and_copy(old_scan_start, old_scan_end, state);
+        old_scan_start = old_scan_end;
+    }
+}
+
 struct TempStack
 {
     term *stack_end;
@@ -234,16 +874,42 @@ static inline term temp_stack_pop(struct TempStack *temp_stack)
     return value;
 }
 
-unsigned long memory_estimate_usage(term t)
+static inline int memory_is_literal_term(term t)
+{
+    if (term_is_boxed(t)) {
+        return memory_is_literal(term_to_const_term_ptr(t));
+    } else if (term_is_nonempty_list(t)) {
+        return memory_is_literal(term_get_list_ptr(t));
+    } else {
+        return 0;
+    }
+}
+
+static inline int memory_is_visited_term(struct SharingTable *visited, term t)
+{
+    const term *ptr = term_is_nonempty_list(t) ? term_get_list_ptr(t) : term_to_const_term_ptr(t);
+    if (sharing_table_get(visited, ptr)) {
+        return 1;
+    }
+    sharing_table_put(visited, ptr, t);
+
+    return 0;
+}
+
+// the walk stops once more than max_size terms have been accounted
+static unsigned long memory_term_size(term t, int skip_literals, int preserve_sharing, unsigned long max_size)
 {
     unsigned long acc = 0;
 
     struct TempStack temp_stack;
     temp_stack_init(&temp_stack);
 
+    struct SharingTable visited;
+    sharing_table_init(&visited);
+
     temp_stack_push(&temp_stack, t);
 
-    while (!temp_stack_is_empty(&temp_stack)) {
+    while (!temp_stack_is_empty(&temp_stack) && (acc <= max_size)) {
         if (term_is_atom(t)) {
             t = temp_stack_pop(&temp_stack);
 
@@ -256,6 +922,14 @@ unsigned long memory_estimate_usage(term t)
         } else if (term_is_pid(t)) {
             t = temp_stack_pop(&temp_stack);
 
+        } else if (skip_literals && memory_is_literal_term(t)) {
+            // literals are shared, so they are not copied
+            t = temp_stack_pop(&temp_stack);
+
+        } else if (preserve_sharing && (term_is_nonempty_list(t) || term_is_boxed(t)) && memory_is_visited_term(&visited, t)) {
+            // shared subterms are copied once, so they are accounted once
+            t = temp_stack_pop(&temp_stack);
+
         } else if (term_is_nonempty_list(t)) {
             acc += 2;
             temp_stack_push(&temp_stack, term_get_list_tail(t));
@@ -275,6 +949,17 @@ unsigned long memory_estimate_usage(term t)
                 t = term_nil();
             }
 
+        } else if (term_is_function(t)) {
+            const term *boxed_value = term_to_const_term_ptr(t);
+            int fun_size = term_boxed_size(t);
+            acc += fun_size + 1;
+
+            // first term is the boxed header, followed by module and fun index, then frozen values.
+            for (int i = 3; i <= fun_size; i++) {
+                temp_stack_push(&temp_stack, boxed_value[i]);
+            }
+            t = temp_stack_pop(&temp_stack);
+
         } else if (term_is_boxed(t)) {
             acc += term_boxed_size(t) + 1;
             t = temp_stack_pop(&temp_stack);
@@ -290,17 +975,40 @@ unsigned long memory_estimate_usage(term t)
         }
     }
 
+    sharing_table_destroy(&visited);
     temp_stack_destory(&temp_stack);
 
     return acc;
 }
 
-static void memory_scan_and_copy(term *mem_start, const term *mem_end, term **new_heap_pos, int move)
+unsigned long memory_estimate_usage(term t)
 {
-    term *ptr = mem_start;
-    term *new_heap = *new_heap_pos;
+    // the flat size is never smaller than the copy, and most terms are small enough that walking them again is cheaper
+    // than tracking visited subterms. Larger ones are accounted as they are copied, since shared subterms might be
+    // referenced so many times that the flat size would be far bigger than the copy.
+    unsigned long flat_size = memory_term_size(t, 1, 0, ESTIMATE_FLAT_MAX_SIZE);
+    if (flat_size <= ESTIMATE_FLAT_MAX_SIZE) {
+        return flat_size;
+    }
 
-    while (ptr < mem_end) {
+    return memory_term_size(t, 1, 1, ULONG_MAX);
+}
+
+unsigned long memory_flat_size(term t)
+{
+    return memory_term_size(t, 0, 0, ULONG_MAX);
+}
+
+unsigned long memory_shared_size(term t)
+{
+    return memory_term_size(t, 0, 1, ULONG_MAX);
+}
+
+static term *memory_scan_and_copy(term *mem_start, const term *mem_end, struct CopyState *state)
+{
+    term *ptr = mem_start;
+
+    while (ptr < mem_end) {
         term t = *ptr;
 
         if (term_is_atom(t)) {
@@ -329,7 +1037,7 @@ static void memory_scan_and_copy(term *mem_start, const term *mem_end, term **ne
 
                     for (int i = 1; i <= arity; i++) {
                         TRACE("-- Elem: %lx\n", ptr[i]);
-                        ptr[i] = memory_shallow_copy_term(ptr[i], &new_heap, move);
+                        ptr[i] = memory_shallow_copy_term(ptr[i], state);
                     }
                     break;
                 }
@@ -346,7 +1054,7 @@ static void memory_scan_and_copy(term *mem_start, const term *mem_end, term **ne
 
                     for (int i = 3; i <= fun_size; i++) {
                         TRACE("-- Frozen: %lx\n", ptr[i]);
-                        ptr[i] = memory_shallow_copy_term(ptr[i], &new_heap, move);
+                        ptr[i] = memory_shallow_copy_term(ptr[i], state);
                     }
                     break;
                 }
@@ -364,12 +1072,12 @@ static void memory_scan_and_copy(term *mem_start, const term *mem_end, term **ne
 
         } else if (term_is_nonempty_list(t)) {
             TRACE("Found nonempty list (%lx)\n", t);
-            *ptr = memory_shallow_copy_term(t, &new_heap, move);
+            *ptr = memory_shallow_copy_term(t, state);
             ptr++;
 
         } else if (term_is_boxed(t)) {
             TRACE("Found boxed (%lx)\n", t);
-            *ptr = memory_shallow_copy_term(t, &new_heap, move);
+            *ptr = memory_shallow_copy_term(t, state);
             ptr++;
 
         } else {
@@ -378,10 +1086,33 @@ static void memory_scan_and_copy(term *mem_start, const term *mem_end, term **ne
         }
     }
 
-    *new_heap_pos = new_heap;
+    return ptr;
+}
+
+static inline int memory_is_shared(const term *ptr, const struct CopyState *state)
+{
+    return ((ptr >= state->shared_start) && (ptr < state->shared_end)) || memory_is_literal(ptr);
+}
+
+static inline term *memory_forwarding_slot(const term *ptr, const struct CopyState *state)
+{
+    if ((ptr >= state->forwarding_start) && (ptr < state->forwarding_end)) {
+        return &state->forwarding[ptr - state->forwarding_start];
+    }
+
+    return NULL;
 }
 
-HOT_FUNC static term memory_shallow_copy_term(term t, term **new_heap, int move)
+static inline term **memory_copy_destination(const term *ptr, struct CopyState *state)
+{
+    if ((ptr >= state->mature_start) && (ptr < state->mature_end)) {
+        return &state->old_heap_pos;
+    } else {
+        return &state->heap_pos;
+    }
+}
+
+HOT_FUNC static term memory_shallow_copy_term(term t, struct CopyState *state)
 {
     if (term_is_atom(t)) {
         return t;
@@ -406,21 +1137,42 @@ HOT_FUNC static term memory_shallow_copy_term(term t, term **new_heap, int move)
     } else if (term_is_boxed(t)) {
         term *boxed_value = term_to_term_ptr(t);
 
-        if (memory_is_moved_marker(boxed_value)) {
+        if (memory_is_shared(boxed_value, state)) {
+            return t;
+        }
+
+        term *forwarding_slot = memory_forwarding_slot(boxed_value, state);
+        if (forwarding_slot) {
+            if (*forwarding_slot) {
+                return *forwarding_slot;
+            }
+        } else if (state->forwarded_only) {
+            return t;
+        } else if (memory_is_moved_marker(boxed_value)) {
             return memory_dereference_moved_marker(boxed_value);
+        } else if (state->sharing) {
+            term copied_term = sharing_table_get(state->sharing, boxed_value);
+            if (copied_term) {
+                return copied_term;
+            }
         }
 
         int boxed_size = term_boxed_size(t) + 1;
-        term *dest = *new_heap;
+        term **dest_pos = memory_copy_destination(boxed_value, state);
+        term *dest = *dest_pos;
         for (int i = 0; i < boxed_size; i++) {
             dest[i] = boxed_value[i];
         }
-        *new_heap += boxed_size;
+        *dest_pos += boxed_size;
 
         term new_term = ((term) dest) | TERM_BOXED_VALUE_TAG;
 
-        if (move) {
+        if (forwarding_slot) {
+            *forwarding_slot = new_term;
+        } else if (state->move) {
             memory_replace_with_moved_marker(boxed_value, new_term);
+        } else if (state->sharing) {
+            sharing_table_put(state->sharing, boxed_value, new_term);
         }
 
         return new_term;
@@ -428,19 +1180,40 @@ HOT_FUNC static term memory_shallow_copy_term(term t, term **new_heap, int move)
     } else if (term_is_nonempty_list(t)) {
         term *list_ptr = term_get_list_ptr(t);
 
-        if (memory_is_moved_marker(list_ptr)) {
+        if (memory_is_shared(list_ptr, state)) {
+            return t;
+        }
+
+        term *forwarding_slot = memory_forwarding_slot(list_ptr, state);
+        if (forwarding_slot) {
+            if (*forwarding_slot) {
+                return *forwarding_slot;
+            }
+        } else if (state->forwarded_only) {
+            return t;
+        } else if (memory_is_moved_marker(list_ptr)) {
             return memory_dereference_moved_marker(list_ptr);
+        } else if (state->sharing) {
+            term copied_term = sharing_table_get(state->sharing, list_ptr);
+            if (copied_term) {
+                return copied_term;
+            }
         }
 
-        term *dest = *new_heap;
+        term **dest_pos = memory_copy_destination(list_ptr, state);
+        term *dest = *dest_pos;
         dest[0] = list_ptr[0];
         dest[1] = list_ptr[1];
-        *new_heap += 2;
+        *dest_pos += 2;
 
         term new_term = ((term) dest) | 0x1;
 
-        if (move) {
+        if (forwarding_slot) {
+            *forwarding_slot = new_term;
+        } else if (state->move) {
             memory_replace_with_moved_marker(list_ptr, new_term);
+        } else if (state->sharing) {
+            sharing_table_put(state->sharing, list_ptr, new_term);
         }
 
         return new_term;
@@ -450,3 +1223,661 @@ HOT_FUNC static term memory_shallow_copy_term(term t, term **new_heap, int move)
         abort();
     }
 }
+
+// one mark bit for each young heap term, all the terms of a live object are marked
+struct MarkBitmap
+{
+    const term *heap_start;
+    const term *heap_end;
+    term *bits;
+
+    // live terms before each bitmap word, new positions are computed from them, so objects do not need to store a
+    // forwarding pointer, that would not fit a list cell
+    unsigned long *live_before;
+
+    // live terms are slid to dest, that is either heap_start or the start of a resized memory block
+    term *dest;
+};
+
+#define MARK_BITMAP_WORD_BITS TERM_BITS
+
+static inline int memory_count_bits(term bits)
+{
+#ifdef __GNUC__
+    return __builtin_popcountl(bits);
+#else
+    int count = 0;
+    while (bits) {
+        bits &= bits - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+static inline int mark_bitmap_contains(const struct MarkBitmap *bitmap, const term *ptr)
+{
+    return (ptr >= bitmap->heap_start) && (ptr < bitmap->heap_end);
+}
+
+static inline int mark_bitmap_is_marked(const struct MarkBitmap *bitmap, const term *ptr)
+{
+    unsigned long index = ptr - bitmap->heap_start;
+    return (bitmap->bits[index / MARK_BITMAP_WORD_BITS] >> (index % MARK_BITMAP_WORD_BITS)) & 1;
+}
+
+static void mark_bitmap_mark(struct MarkBitmap *bitmap, const term *ptr, unsigned long size)
+{
+    unsigned long index = ptr - bitmap->heap_start;
+    for (unsigned long i = index; i < index + size; i++) {
+        bitmap->bits[i / MARK_BITMAP_WORD_BITS] |= ((term) 1) << (i % MARK_BITMAP_WORD_BITS);
+    }
+}
+
+static inline term *mark_bitmap_forward(const struct MarkBitmap *bitmap, const term *ptr)
+{
+    unsigned long index = ptr - bitmap->heap_start;
+    unsigned long word = index / MARK_BITMAP_WORD_BITS;
+    term lower_bits = bitmap->bits[word] & ((((term) 1) << (index % MARK_BITMAP_WORD_BITS)) - 1);
+
+    return bitmap->dest + bitmap->live_before[word] + memory_count_bits(lower_bits);
+}
+
+static void memory_mark_term(struct MarkBitmap *bitmap, struct TempStack *temp_stack, term t)
+{
+    temp_stack_push(temp_stack, t);
+
+    while (!temp_stack_is_empty(temp_stack)) {
+        t = temp_stack_pop(temp_stack);
+
+        if (term_is_boxed(t)) {
+            const term *boxed_value = term_to_const_term_ptr(t);
+            if (!mark_bitmap_contains(bitmap, boxed_value) || mark_bitmap_is_marked(bitmap, boxed_value)) {
+                continue;
+            }
+            int boxed_size = term_boxed_size(t);
+            mark_bitmap_mark(bitmap, boxed_value, boxed_size + 1);
+
+            switch (boxed_value[0] & TERM_BOXED_TAG_MASK) {
+                case TERM_BOXED_TUPLE:
+                    for (int i = 1; i <= boxed_size; i++) {
+                        temp_stack_push(temp_stack, boxed_value[i]);
+                    }
+                    break;
+
+                case TERM_BOXED_FUN:
+                    // first term is the boxed header, followed by module and fun index.
+                    for (int i = 3; i <= boxed_size; i++) {
+                        temp_stack_push(temp_stack, boxed_value[i]);
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+
+        } else if (term_is_nonempty_list(t)) {
+            const term *list_ptr = term_get_list_ptr(t);
+            if (!mark_bitmap_contains(bitmap, list_ptr) || mark_bitmap_is_marked(bitmap, list_ptr)) {
+                continue;
+            }
+            mark_bitmap_mark(bitmap, list_ptr, 2);
+
+            temp_stack_push(temp_stack, list_ptr[0]);
+            temp_stack_push(temp_stack, list_ptr[1]);
+        }
+    }
+}
+
+static inline term memory_forward_term(const struct MarkBitmap *bitmap, term t)
+{
+    if (term_is_boxed(t)) {
+        const term *boxed_value = term_to_const_term_ptr(t);
+        if (mark_bitmap_contains(bitmap, boxed_value)) {
+            return ((term) mark_bitmap_forward(bitmap, boxed_value)) | TERM_BOXED_VALUE_TAG;
+        }
+
+    } else if (term_is_nonempty_list(t)) {
+        const term *list_ptr = term_get_list_ptr(t);
+        if (mark_bitmap_contains(bitmap, list_ptr)) {
+            return ((term) mark_bitmap_forward(bitmap, list_ptr)) | 0x1;
+        }
+    }
+
+    return t;
+}
+
+// the heap is walked as memory_scan_and_copy does, dead terms are skipped but they are still needed for finding
+// where next term starts
+static void memory_forward_heap_terms(const struct MarkBitmap *bitmap, term *mem_start, const term *mem_end)
+{
+    term *ptr = mem_start;
+
+    while (ptr < mem_end) {
+        term t = *ptr;
+
+        if ((t & 0x3) == 0x0) {
+            int boxed_size = term_get_size_from_boxed_header(t);
+
+            if (mark_bitmap_is_marked(bitmap, ptr)) {
+                switch (t & TERM_BOXED_TAG_MASK) {
+                    case TERM_BOXED_TUPLE:
+                        for (int i = 1; i <= boxed_size; i++) {
+                            ptr[i] = memory_forward_term(bitmap, ptr[i]);
+                        }
+                        break;
+
+                    case TERM_BOXED_FUN:
+                        for (int i = 3; i <= boxed_size; i++) {
+                            ptr[i] = memory_forward_term(bitmap, ptr[i]);
+                        }
+                        break;
+
+                    case TERM_BOXED_REF:
+                    case TERM_BOXED_HEAP_BINARY:
+                        break;
+
+                    default:
+                        fprintf(stderr, "- Found unknown boxed type: %lx\n", (t >> 2) & 0xF);
+                        abort();
+                }
+            }
+
+            ptr += boxed_size + 1;
+
+        } else {
+            if (mark_bitmap_is_marked(bitmap, ptr)) {
+                *ptr = memory_forward_term(bitmap, t);
+            }
+            ptr++;
+        }
+    }
+}
+
+// terms are moved in address order and never upwards, so a term is overwritten only after it has been moved
+static void memory_slide_heap_terms(const struct MarkBitmap *bitmap, term *mem_start, const term *mem_end)
+{
+    term *ptr = mem_start;
+
+    while (ptr < mem_end) {
+        unsigned long size = ((*ptr & 0x3) == 0x0) ? term_get_size_from_boxed_header(*ptr) + 1 : 1;
+        if (mark_bitmap_is_marked(bitmap, ptr)) {
+            memmove(mark_bitmap_forward(bitmap, ptr), ptr, size * sizeof(term));
+        }
+        ptr += size;
+    }
+}
+
+// sliding mark-compact collection: live young terms are marked, pointers are updated to the positions terms will
+// have once slid, and then they are slid down. Only the mark bitmap is allocated, unless the heap is resized, so
+// there is no need for a second heap as big as the current one. Old heap terms are not moved, the ones in the
+// remembered set are roots. Moved markers are not used, so the heap never contains any of them when this function
+// returns, as memory_scan_and_copy expects.
+static enum MemoryGCResult memory_compacting_gc(Context *ctx, int new_size)
+{
+    TRACE("- Running compacting GC\n");
+
+    struct HeapPool *heap_pool = ctx->global->heap_pool;
+    unsigned long memory_size = context_memory_size(ctx);
+
+    // live terms are slid to a new memory block only when it would have a different size
+    term *new_heap = ctx->heap_start;
+    unsigned long new_memory_size = ctx->has_max_heap_size ? (unsigned long) new_size : heappool_capacity(heap_pool, new_size);
+    if (new_memory_size != memory_size) {
+        new_heap = heappool_alloc(heap_pool, new_size, &new_memory_size);
+        if (IS_NULL_PTR(new_heap)) {
+            return MEMORY_GC_ERROR_FAILED_ALLOCATION;
+        }
+        // the whole memory block is used, unless the heap size is limited
+        if (ctx->has_max_heap_size) {
+            new_memory_size = new_size;
+        }
+    }
+
+    unsigned long bitmap_words = (ctx->heap_ptr - ctx->heap_start) / MARK_BITMAP_WORD_BITS + 1;
+    struct MarkBitmap bitmap;
+    bitmap.heap_start = ctx->heap_start;
+    bitmap.heap_end = ctx->heap_ptr;
+    bitmap.dest = new_heap;
+    bitmap.bits = calloc(bitmap_words, sizeof(term));
+    bitmap.live_before = malloc(bitmap_words * sizeof(unsigned long));
+    if (IS_NULL_PTR(bitmap.bits) || IS_NULL_PTR(bitmap.live_before)) {
+        free(bitmap.bits);
+        free(bitmap.live_before);
+        if (new_heap != ctx->heap_start) {
+            heappool_free(heap_pool, new_heap, new_memory_size);
+        }
+        return MEMORY_GC_ERROR_FAILED_ALLOCATION;
+    }
+
+    TRACE("- Marking live terms\n");
+    struct TempStack temp_stack;
+    temp_stack_init(&temp_stack);
+    for (int i = 0; i < ctx->avail_registers; i++) {
+        memory_mark_term(&bitmap, &temp_stack, ctx->x[i]);
+    }
+    for (term *stack_ptr = ctx->e; stack_ptr < ctx->stack_base; stack_ptr++) {
+        memory_mark_term(&bitmap, &temp_stack, *stack_ptr);
+    }
+    for (Message *m = memory_next_message(ctx, NULL); m; m = memory_next_message(ctx, m)) {
+        if (m->attached) {
+            memory_mark_term(&bitmap, &temp_stack, m->message);
+        }
+    }
+    for (int i = 0; i < ctx->remembered_set_count; i++) {
+        int fields_count;
+        term *fields = memory_written_term_fields(ctx->remembered_set[i], &fields_count);
+        for (int j = 0; j < fields_count; j++) {
+            memory_mark_term(&bitmap, &temp_stack, fields[j]);
+        }
+    }
+    temp_stack_destory(&temp_stack);
+
+    unsigned long live_size = 0;
+    for (unsigned long i = 0; i < bitmap_words; i++) {
+        bitmap.live_before[i] = live_size;
+        live_size += memory_count_bits(bitmap.bits[i]);
+    }
+
+    TRACE("- Updating pointers, live terms: %lu\n", live_size);
+    for (int i = 0; i < ctx->avail_registers; i++) {
+        ctx->x[i] = memory_forward_term(&bitmap, ctx->x[i]);
+    }
+    for (term *stack_ptr = ctx->e; stack_ptr < ctx->stack_base; stack_ptr++) {
+        *stack_ptr = memory_forward_term(&bitmap, *stack_ptr);
+    }
+    for (Message *m = memory_next_message(ctx, NULL); m; m = memory_next_message(ctx, m)) {
+        if (m->attached) {
+            m->message = memory_forward_term(&bitmap, m->message);
+        }
+    }
+    for (int i = 0; i < ctx->remembered_set_count; i++) {
+        int fields_count;
+        term *fields = memory_written_term_fields(ctx->remembered_set[i], &fields_count);
+        for (int j = 0; j < fields_count; j++) {
+            fields[j] = memory_forward_term(&bitmap, fields[j]);
+        }
+    }
+    memory_forward_heap_terms(&bitmap, ctx->heap_start, ctx->heap_ptr);
+
+    memory_slide_heap_terms(&bitmap, ctx->heap_start, ctx->heap_ptr);
+
+    free(bitmap.bits);
+    free(bitmap.live_before);
+
+    if (new_heap != ctx->heap_start) {
+        unsigned long stack_size = context_stack_size(ctx);
+        term *new_stack_base = new_heap + new_memory_size;
+        memcpy(new_stack_base - stack_size, ctx->e, stack_size * sizeof(term));
+
+        heappool_free(heap_pool, ctx->heap_start, memory_size);
+
+        ctx->heap_start = new_heap;
+        ctx->stack_base = new_stack_base;
+        ctx->e = new_stack_base - stack_size;
+    }
+    ctx->heap_ptr = ctx->heap_start + live_size;
+    memory_prune_remembered_set(ctx);
+
+    // everything that survived is promoted if the next collection is a minor one
+    ctx->high_water_mark = ctx->heap_ptr;
+
+    // without an old heap all live terms have been collected, as a major collection does
+    if (ctx->old_heap_start) {
+        ctx->minor_gcs++;
+    } else {
+        ctx->minor_gcs = 0;
+    }
+
+    return MEMORY_GC_OK;
+}
+
+static void memory_destroy_incremental_gc(struct IncrementalGC *gc)
+{
+    free(gc->state.forwarding);
+    free(gc->written_terms);
+    free(gc);
+}
+
+void memory_cancel_incremental_gc(Context *ctx)
+{
+    struct IncrementalGC *gc = ctx->incremental_gc;
+
+    // the process memory block has not been modified, so the new one is just released
+    heappool_free(ctx->global->heap_pool, gc->new_heap, gc->new_size);
+    memory_destroy_incremental_gc(gc);
+    ctx->incremental_gc = NULL;
+}
+
+// roots are not updated, they are copied again when the collection is completed: registers and messages are copied
+// right away, the stack is copied in chunks by the following steps
+static void memory_copy_incremental_gc_roots(Context *ctx, struct IncrementalGC *gc)
+{
+    for (int i = 0; i < ctx->avail_registers; i++) {
+        memory_shallow_copy_term(ctx->x[i], &gc->state);
+    }
+    for (Message *m = memory_next_message(ctx, NULL); m; m = memory_next_message(ctx, m)) {
+        if (m->attached) {
+            memory_shallow_copy_term(m->message, &gc->state);
+        }
+    }
+    for (int i = 0; i < ctx->remembered_set_count; i++) {
+        int fields_count;
+        term *fields = memory_written_term_fields(ctx->remembered_set[i], &fields_count);
+        for (int j = 0; j < fields_count; j++) {
+            memory_shallow_copy_term(fields[j], &gc->state);
+        }
+    }
+
+    gc->stack_copied = 0;
+    gc->stack_pending = 1;
+}
+
+// the process might have pushed or popped frames since the previous chunk: this is fine, since the stack is copied
+// again when the collection is completed, so missed terms are just copied later
+static void memory_copy_incremental_gc_stack_chunk(Context *ctx, struct IncrementalGC *gc)
+{
+    unsigned long stack_size = ctx->stack_base - ctx->e;
+    unsigned long chunk_end = gc->stack_copied + INCREMENTAL_GC_SCAN_CHUNK_SIZE;
+    if (chunk_end >= stack_size) {
+        chunk_end = stack_size;
+        gc->stack_pending = 0;
+    }
+
+    for (unsigned long i = gc->stack_copied; i < chunk_end; i++) {
+        memory_shallow_copy_term(*(ctx->stack_base - 1 - i), &gc->state);
+    }
+    gc->stack_copied = chunk_end;
+}
+
+// terms allocated or written after the snapshot has been taken, that are copied when the collection is completed
+static unsigned long memory_incremental_gc_pending_terms(const Context *ctx, const struct IncrementalGC *gc)
+{
+    return (ctx->heap_ptr - gc->state.forwarding_end) + gc->written_terms_count;
+}
+
+// a copy that has already been scanned is scanned again, otherwise it is going to be scanned with other pending terms
+static void memory_copy_written_term(term t, term *scan_pos, struct CopyState *state)
+{
+    const term *ptr = term_is_boxed(t) ? term_to_const_term_ptr(t) : term_get_list_ptr(t);
+    term copy = *memory_forwarding_slot(ptr, state);
+    if (!copy) {
+        // it will be copied with its current content if it is still reachable
+        return;
+    }
+
+    term *copy_ptr = term_is_boxed(copy) ? term_to_term_ptr(copy) : term_get_list_ptr(copy);
+    int size = term_is_boxed(t) ? term_boxed_size(t) + 1 : 2;
+    memcpy(copy_ptr, ptr, size * sizeof(term));
+
+    if (copy_ptr < scan_pos) {
+        memory_scan_and_copy(copy_ptr, copy_ptr + size, state);
+    }
+}
+
+// the snapshot is extended to all terms that are on the heap now, so terms allocated since the collection started are
+// copied by incremental steps as well: written terms are copied again right away, since every term they might
+// reference is part of the snapshot now, then roots are copied again
+static int memory_extend_incremental_gc(Context *ctx, struct IncrementalGC *gc)
+{
+    unsigned long forwarding_size = gc->state.forwarding_end - gc->state.forwarding_start;
+    unsigned long heap_size = ctx->heap_ptr - ctx->heap_start;
+    term *new_forwarding = realloc(gc->state.forwarding, (heap_size + 1) * sizeof(term));
+    if (IS_NULL_PTR(new_forwarding)) {
+        return 0;
+    }
+    memset(new_forwarding + forwarding_size, 0, (heap_size + 1 - forwarding_size) * sizeof(term));
+    gc->state.forwarding = new_forwarding;
+    gc->state.forwarding_end = ctx->heap_ptr;
+
+    for (int i = 0; i < gc->written_terms_count; i++) {
+        memory_copy_written_term(gc->written_terms[i], gc->scan_pos, &gc->state);
+    }
+    gc->written_terms_count = 0;
+
+    memory_copy_incremental_gc_roots(ctx, gc);
+
+    return 1;
+}
+
+static inline int memory_is_incremental_gc_ready(const Context *ctx, const struct IncrementalGC *gc)
+{
+    return (gc->scan_pos == gc->state.heap_pos) && !gc->stack_pending
+        && (memory_incremental_gc_pending_terms(ctx, gc) <= INCREMENTAL_GC_FINISH_MAX_TERMS);
+}
+
+// the young terms that are reachable when the collection starts are the snapshot that is copied by incremental steps:
+// terms are never modified without memory_record_write, so terms that become reachable later are either part of the
+// snapshot or allocated after the collection started
+static void memory_start_incremental_gc(Context *ctx)
+{
+    TRACE("- Starting incremental GC\n");
+
+    struct IncrementalGC *gc = malloc(sizeof(struct IncrementalGC));
+    if (IS_NULL_PTR(gc)) {
+        return;
+    }
+
+    // live terms cannot take more than the current memory block, whatever is allocated before the collection ends
+    unsigned long memory_size = context_memory_size(ctx);
+    unsigned long heap_size = ctx->heap_ptr - ctx->heap_start;
+    gc->new_heap = heappool_alloc(ctx->global->heap_pool, memory_size, &gc->new_size);
+    gc->state.forwarding = calloc(heap_size + 1, sizeof(term));
+    if (IS_NULL_PTR(gc->new_heap) || IS_NULL_PTR(gc->state.forwarding)) {
+        heappool_free(ctx->global->heap_pool, gc->new_heap, memory_size);
+        free(gc->state.forwarding);
+        free(gc);
+        return;
+    }
+    // the whole memory block is used, unless the heap size is limited
+    if (ctx->has_max_heap_size) {
+        gc->new_size = memory_size;
+    }
+
+    gc->state.heap_pos = gc->new_heap;
+    gc->state.mature_start = NULL;
+    gc->state.mature_end = NULL;
+    gc->state.old_heap_pos = NULL;
+    gc->state.shared_start = ctx->old_heap_start;
+    gc->state.shared_end = ctx->old_heap_end;
+    gc->state.move = 0;
+    gc->state.forwarding_start = ctx->heap_start;
+    gc->state.forwarding_end = ctx->heap_ptr;
+    gc->state.forwarded_only = 1;
+    gc->state.sharing = NULL;
+
+    gc->scan_pos = gc->new_heap;
+    gc->written_terms = NULL;
+    gc->written_terms_count = 0;
+    gc->written_terms_size = 0;
+
+    memory_copy_incremental_gc_roots(ctx, gc);
+
+    ctx->incremental_gc = gc;
+}
+
+static inline int timespec_is_before(const struct timespec *a, const struct timespec *b)
+{
+    return (a->tv_sec < b->tv_sec) || ((a->tv_sec == b->tv_sec) && (a->tv_nsec < b->tv_nsec));
+}
+
+static void memory_incremental_gc_step(Context *ctx)
+{
+    struct IncrementalGC *gc = ctx->incremental_gc;
+
+    struct timespec deadline;
+    sys_set_timestamp_from_relative_to_abs(&deadline, 0);
+    deadline.tv_sec += ctx->max_gc_pause / 1000000;
+    deadline.tv_nsec += (ctx->max_gc_pause % 1000000) * 1000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    while (!memory_is_incremental_gc_ready(ctx, gc)) {
+        if (gc->scan_pos < gc->state.heap_pos) {
+            term *scan_end = gc->scan_pos + INCREMENTAL_GC_SCAN_CHUNK_SIZE;
+            if (scan_end > gc->state.heap_pos) {
+                scan_end = gc->state.heap_pos;
+            }
+            gc->scan_pos = memory_scan_and_copy(gc->scan_pos, scan_end, &gc->state);
+
+        } else if (gc->stack_pending) {
+            memory_copy_incremental_gc_stack_chunk(ctx, gc);
+
+        } else if (UNLIKELY(!memory_extend_incremental_gc(ctx, gc))) {
+            memory_cancel_incremental_gc(ctx);
+            return;
+        }
+
+        struct timespec now;
+        sys_set_timestamp_from_relative_to_abs(&now, 0);
+        if (!timespec_is_before(&now, &deadline)) {
+            break;
+        }
+    }
+
+    TRACE("- Incremental GC step, scanned: %li, copied: %li\n", (long) (gc->scan_pos - gc->new_heap),
+        (long) (gc->state.heap_pos - gc->new_heap));
+}
+
+// completes the collection while the process is not running: terms allocated after the snapshot has been taken are
+// copied as well, so moved markers can be used for them, as the copying collector does. Only those terms, written terms
+// and roots are copied here, so the pause depends on the stack size and on INCREMENTAL_GC_FINISH_MAX_TERMS, unless the
+// process ran out of memory before the collection was ready to be completed
+static void memory_finish_incremental_gc(Context *ctx)
+{
+    TRACE("- Completing incremental GC\n");
+
+    struct IncrementalGC *gc = ctx->incremental_gc;
+    struct CopyState *state = &gc->state;
+    state->forwarded_only = 0;
+    state->move = 1;
+
+    for (int i = 0; i < gc->written_terms_count; i++) {
+        memory_copy_written_term(gc->written_terms[i], gc->scan_pos, state);
+    }
+
+    for (int i = 0; i < ctx->avail_registers; i++) {
+        ctx->x[i] = memory_shallow_copy_term(ctx->x[i], state);
+    }
+
+    term *stack_ptr = gc->new_heap + gc->new_size;
+    int stack_size = ctx->stack_base - ctx->e;
+    for (int i = stack_size - 1; i >= 0; i--) {
+        push_to_stack(&stack_ptr, memory_shallow_copy_term(ctx->e[i], state));
+    }
+    for (Message *m = memory_next_message(ctx, NULL); m; m = memory_next_message(ctx, m)) {
+        if (m->attached) {
+            m->message = memory_shallow_copy_term(m->message, state);
+        }
+    }
+    for (int i = 0; i < ctx->remembered_set_count; i++) {
+        int fields_count;
+        term *fields = memory_written_term_fields(ctx->remembered_set[i], &fields_count);
+        for (int j = 0; j < fields_count; j++) {
+            fields[j] = memory_shallow_copy_term(fields[j], state);
+        }
+    }
+
+    memory_copy_pending_terms(state, gc->scan_pos, NULL);
+
+    heappool_free(ctx->global->heap_pool, ctx->heap_start, context_memory_size(ctx));
+
+    ctx->heap_start = gc->new_heap;
+    ctx->stack_base = gc->new_heap + gc->new_size;
+    ctx->heap_ptr = state->heap_pos;
+    ctx->e = stack_ptr;
+    memory_prune_remembered_set(ctx);
+
+    // everything that survived is promoted if the next collection is a minor one
+    ctx->high_water_mark = ctx->heap_ptr;
+
+    // without an old heap all live terms have been collected, as a major collection does
+    if (ctx->old_heap_start) {
+        ctx->minor_gcs++;
+    } else {
+        ctx->minor_gcs = 0;
+    }
+
+    memory_destroy_incremental_gc(gc);
+    ctx->incremental_gc = NULL;
+
+    memory_update_occupancy(ctx);
+}
+
+void memory_incremental_gc_slice(Context *ctx)
+{
+    struct IncrementalGC *gc = ctx->incremental_gc;
+
+    if (ctx->heap_fragments_size) {
+        // heap fragments are moved to the heap by the next copying collection
+        if (gc) {
+            memory_cancel_incremental_gc(ctx);
+        }
+
+    } else if (!gc) {
+        // a collection is started once half of the memory that was free after the previous one has been used
+        if ((ctx->heap_ptr - ctx->high_water_mark >= (long) context_avail_free_memory(ctx)) && memory_is_young_gc_allowed(ctx)) {
+            memory_start_incremental_gc(ctx);
+        }
+
+    } else if (memory_is_incremental_gc_ready(ctx, gc)) {
+        memory_finish_incremental_gc(ctx);
+
+    } else {
+        memory_incremental_gc_step(ctx);
+    }
+}
+
+void memory_record_write(Context *ctx, term t)
+{
+    struct IncrementalGC *gc = ctx->incremental_gc;
+
+    // terms allocated after the snapshot has been taken are copied with their current content
+    const term *ptr = term_is_boxed(t) ? term_to_const_term_ptr(t) : term_get_list_ptr(t);
+    if (!memory_forwarding_slot(ptr, &gc->state)) {
+        return;
+    }
+
+    if (gc->written_terms_count == gc->written_terms_size) {
+        int new_size = gc->written_terms_size ? gc->written_terms_size * 2 : 16;
+        term *new_written_terms = realloc(gc->written_terms, new_size * sizeof(term));
+        if (IS_NULL_PTR(new_written_terms)) {
+            // the write would be lost, a new collection is started later
+            memory_cancel_incremental_gc(ctx);
+            return;
+        }
+        gc->written_terms = new_written_terms;
+        gc->written_terms_size = new_size;
+    }
+
+    gc->written_terms[gc->written_terms_count] = t;
+    gc->written_terms_count++;
+}
+
+void memory_remember_write(Context *ctx, term t)
+{
+    // the same term is usually written over and over
+    if (ctx->remembered_set_count && (ctx->remembered_set[ctx->remembered_set_count - 1] == t)) {
+        return;
+    }
+
+    if (ctx->remembered_set_count == ctx->remembered_set_size) {
+        int new_size = ctx->remembered_set_size ? ctx->remembered_set_size * 2 : 16;
+        term *new_remembered_set = realloc(ctx->remembered_set, new_size * sizeof(term));
+        if (IS_NULL_PTR(new_remembered_set)) {
+            // the write would be lost, so next collection must be a major one
+            ctx->minor_gcs = ctx->fullsweep_after;
+            if (ctx->incremental_gc) {
+                memory_cancel_incremental_gc(ctx);
+            }
+            return;
+        }
+        ctx->remembered_set = new_remembered_set;
+        ctx->remembered_set_size = new_size;
+    }
+
+    ctx->remembered_set[ctx->remembered_set_count] = t;
+    ctx->remembered_set_count++;
+}
@@ -26,12 +26,18 @@
 #include <stdint.h>
 
 #define HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF 64
+#define DEFAULT_FULLSWEEP_AFTER 65535
+#define DEFAULT_HEAP_GROWTH FibonacciHeapGrowth
+#define DEFAULT_COMPACTING_GC_THRESHOLD (1024 * 1024)
+#define DEFAULT_MAX_GC_PAUSE 0
 
 #ifndef TYPEDEF_CONTEXT
 #define TYPEDEF_CONTEXT
 typedef struct Context Context;
 #endif
 
+struct IncrementalGC;
+
 enum MemoryGCResult
 {
     MEMORY_GC_OK = 0,
@@ -39,6 +45,26 @@ enum MemoryGCResult
     MEMORY_GC_DENIED_ALLOCATION = 2
 };
 
+/**
+ * @brief heap sizing policies
+ *
+ * @details MinimumHeapGrowth grows the heap to the exact required size and shrinks it as soon as there is
+ * unused space, so the process uses as little memory as possible at the price of frequent collections.
+ * FibonacciHeapGrowth grows the heap along a Fibonacci-like sequence of sizes, that becomes geometric for
+ * large heaps, and shrinks it only after several collections found the heap mostly empty.
+ */
+enum HeapGrowthStrategy
+{
+    MinimumHeapGrowth = 0,
+    FibonacciHeapGrowth = 1
+};
+
+enum MemoryAllocMode
+{
+    MEMORY_NO_SHRINK = 0,
+    MEMORY_CAN_SHRINK = 1
+};
+
 /**
  * @brief allocates space for a certain ammount of terms on the heap
  *
@@ -53,6 +79,12 @@ MALLOC_LIKE term *memory_heap_alloc(Context *ctx, uint32_t size);
  * @brief allocates a new memory block and executes garbage collection
  *
  * @details allocates a new memory block (that can have new size) and executes garbage collection, any existing term might be invalid after this call.
+ * A minor collection copies only young terms and promotes to the old heap the ones that survived the previous collection, a major
+ * collection copies all live terms and releases the old heap: it is performed after ctx->fullsweep_after minor ones or when the old
+ * heap is full. Terms are promoted once they survive one collection, as survivors are not ordered by age. Old terms that
+ * have been written are in the remembered set, that is scanned by collections that leave the old heap in place.
+ * Heaps of at least ctx->compacting_gc_threshold terms are compacted in place instead, so a second memory block is
+ * allocated only when the heap has to be resized.
  * @param ctx the context that owns the memory block.
  * @param new_size the size of the new memory block in term units.
  * @returns MEMORY_GC_OK when successful.
@@ -62,7 +94,8 @@ enum MemoryGCResult memory_gc(Context *ctx, int new_size);
 /**
  * @brief copies a term to a destination heap
  *
- * @details deep copies a term to a destination heap, once finished old memory can be freed.
+ * @details deep copies a term to a destination heap, once finished old memory can be freed. Subterms that are
+ * referenced more than once are copied once, so the copy preserves sharing and it is not bigger than the original term.
  * @param new_heap the destination heap where terms will be copied.
  * @returns a new term that is stored on the new heap.
  */
@@ -78,6 +111,37 @@ term memory_copy_term_tree(term **new_heap, term t);
  */
 enum MemoryGCResult memory_ensure_free(Context *ctx, uint32_t size) MUST_CHECK;
 
+/**
+ * @brief meakes sure that the given context has given free memory, optionally shrinking the heap
+ *
+ * @details same as memory_ensure_free, but when alloc_mode is MEMORY_CAN_SHRINK and the heap growth strategy of the
+ * context considers the heap oversized, a garbage collection is performed to shrink it, any existing term might be
+ * invalid after this call.
+ * @param ctx the target context.
+ * @param size needed available memory.
+ * @param alloc_mode MEMORY_CAN_SHRINK if the heap can be shrunk, otherwise MEMORY_NO_SHRINK.
+ */
+enum MemoryGCResult memory_ensure_free_opt(Context *ctx, uint32_t size, enum MemoryAllocMode alloc_mode) MUST_CHECK;
+
+/**
+ * @brief returns the smallest Fibonacci heap size that is not less than size
+ *
+ * @details Fibonacci heap sizes follow a Fibonacci-like sequence that becomes geometric for large heaps.
+ * @param size the required size in term units.
+ * @returns a Fibonacci heap size in term units.
+ */
+unsigned long memory_next_fibonacci_heap_size(unsigned long size);
+
+/**
+ * @brief returns the memory block size that should be used for a certain amount of memory
+ *
+ * @details applies the heap growth strategy of the given context, min_heap_size and max_heap_size.
+ * @param ctx the context that owns the heap.
+ * @param size the required memory block size in term units.
+ * @returns the memory block size in term units, that is at least size unless max_heap_size is exceeded.
+ */
+unsigned long memory_heap_target_size(const Context *ctx, unsigned long size);
+
 /**
  * @brief runs a garbage collection and shrinks used memory
  *
@@ -86,13 +150,109 @@ enum MemoryGCResult memory_ensure_free(Context *ctx, uint32_t size) MUST_CHECK;
  */
 enum MemoryGCResult memory_gc_and_shrink(Context *ctx) MUST_CHECK;
 
+/**
+ * @brief performs a bounded step of an incremental garbage collection
+ *
+ * @details called at the beginning of each time slice of processes that have a max_gc_pause. An incremental collection
+ * is started once the process used half of the memory that was free after the previous collection, then live terms are
+ * copied to a new memory block for at most ctx->max_gc_pause microseconds per time slice, while the process keeps
+ * running on its current memory block. Once all the terms that were live when it started have been copied, the
+ * snapshot is extended to the terms allocated in the meantime, until few enough terms have been allocated since then.
+ * The collection is then completed, or earlier when the process runs out of memory. Completing it requires copying
+ * roots and terms allocated after the snapshot has been extended, so any existing term might be invalid after this call.
+ * An incremental collection needs a new memory block as big as the current one and one term for each heap term,
+ * where copied terms are recorded.
+ * @param ctx the context that owns the heap.
+ */
+void memory_incremental_gc_slice(Context *ctx);
+
+/**
+ * @brief discards an incremental garbage collection in progress
+ *
+ * @details the heap of the process is left as it is.
+ * @param ctx the context that has an incremental collection in progress.
+ */
+void memory_cancel_incremental_gc(Context *ctx);
+
+/**
+ * @brief records a write to a term during an incremental garbage collection
+ *
+ * @details terms are immutable once they have been built, terms that are modified after the process might have been
+ * scheduled out must be recorded, otherwise an incremental collection might keep a copy that misses the write.
+ * Use context_write_barrier, that calls this function only when needed.
+ * @param ctx the context that owns the term.
+ * @param t the modified term, either a boxed term or a list.
+ */
+void memory_record_write(Context *ctx, term t);
+
+/**
+ * @brief records a write to an old term
+ *
+ * @details old terms are not scanned by minor collections, so the ones that have been written are added to the
+ * remembered set, that is scanned instead, since they might reference young terms.
+ * Use context_write_barrier, that calls this function only when needed.
+ * @param ctx the context that owns the term.
+ * @param t the modified term, either a boxed term or a list that is on the old heap.
+ */
+void memory_remember_write(Context *ctx, term t);
+
 /**
  * @brief calculates term memory usage
  *
- * @details perform an used memory calculation using given term as root, shared memory (that is not part of the memory block) is not accounted.
+ * @details perform an used memory calculation using given term as root, shared memory (that is not part of the memory block) is not accounted,
+ * such as terms stored in a literal area. The result is never smaller than the amount of memory required by
+ * memory_copy_term_tree: small terms are walked as if they had no shared subterms, larger ones account subterms that
+ * are referenced more than once only once, as the copy does.
  * @param t root term on which used memory calculation will be performed.
  * @returns used memory terms count in term units output parameter.
  */
 unsigned long memory_estimate_usage(term t);
 
+/**
+ * @brief calculates term size
+ *
+ * @details terms stored in a literal area are accounted as well and subterms that are referenced more than once are
+ * accounted every time, so the result is the size that the term would have if it was completely stored on a process
+ * heap without any sharing.
+ * @param t root term on which size calculation will be performed.
+ * @returns the size of the term in term units.
+ */
+unsigned long memory_flat_size(term t);
+
+/**
+ * @brief calculates term size preserving sharing
+ *
+ * @details same as memory_flat_size, but subterms that are referenced more than once are accounted once.
+ * @param t root term on which size calculation will be performed.
+ * @returns the size of the term in term units.
+ */
+unsigned long memory_shared_size(term t);
+
+/**
+ * @brief registers a literal area
+ *
+ * @details terms stored in a literal area are shared by all processes: they are never copied or moved by the garbage
+ * collector and they are not copied when sent to other processes, so they must not be modified.
+ * @param start the first term of the literal area.
+ * @param end the end of the literal area (excluded).
+ * @returns 1 when successful, otherwise 0.
+ */
+int memory_register_literal_area(const term *start, const term *end);
+
+/**
+ * @brief unregisters a literal area
+ *
+ * @details no process must reference terms stored in the literal area after this call.
+ * @param start the first term of a previously registered literal area.
+ */
+void memory_unregister_literal_area(const term *start);
+
+/**
+ * @brief checks if a pointer belongs to a registered literal area
+ *
+ * @param ptr the pointer that will be checked.
+ * @returns 1 if ptr points to a literal area, otherwise 0.
+ */
+int memory_is_literal(const term *ptr);
+
 #endif
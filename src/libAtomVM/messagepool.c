@@ -0,0 +1,216 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "messagepool.h"
+
+#include <stdlib.h>
+
+#include "defaultatoms.h"
+#include "memory.h"
+#include "utils.h"
+
+// size classes are multiples of this size, in bytes
+#define MESSAGE_POOL_GRANULARITY (2 * sizeof(term))
+#define MESSAGE_POOL_CLASSES 16
+// maximum amount of memory kept on the free list of a size class, in bytes
+#define MESSAGE_POOL_CLASS_CACHE_SIZE 32768
+
+struct FreeBuffer
+{
+    struct FreeBuffer *next;
+};
+
+struct MessagePoolClass
+{
+    struct FreeBuffer *free_list;
+    unsigned long live_buffers;
+    unsigned long cached_buffers;
+};
+
+struct MessagePool
+{
+    struct MessagePoolClass classes[MESSAGE_POOL_CLASSES];
+    unsigned long large_live_buffers;
+
+    size_t live_bytes;
+    size_t cached_bytes;
+    uint64_t allocs;
+    uint64_t pool_hits;
+};
+
+struct MessagePool *messagepool_new()
+{
+    struct MessagePool *pool = malloc(sizeof(struct MessagePool));
+    if (IS_NULL_PTR(pool)) {
+        return NULL;
+    }
+
+    for (int i = 0; i < MESSAGE_POOL_CLASSES; i++) {
+        pool->classes[i].free_list = NULL;
+        pool->classes[i].live_buffers = 0;
+        pool->classes[i].cached_buffers = 0;
+    }
+    pool->large_live_buffers = 0;
+
+    pool->live_bytes = 0;
+    pool->cached_bytes = 0;
+    pool->allocs = 0;
+    pool->pool_hits = 0;
+
+    return pool;
+}
+
+void messagepool_destroy(struct MessagePool *pool)
+{
+    for (int i = 0; i < MESSAGE_POOL_CLASSES; i++) {
+        struct FreeBuffer *free_buffer = pool->classes[i].free_list;
+        while (free_buffer) {
+            struct FreeBuffer *next = free_buffer->next;
+            free(free_buffer);
+            free_buffer = next;
+        }
+    }
+
+    free(pool);
+}
+
+// returns the smallest size class that can hold size bytes, or -1 when the buffer is a large one
+static inline int messagepool_class_index(size_t size)
+{
+    size_t class_index = (size + MESSAGE_POOL_GRANULARITY - 1) / MESSAGE_POOL_GRANULARITY;
+    if (class_index > MESSAGE_POOL_CLASSES) {
+        return -1;
+    }
+
+    // a free buffer must be able to hold the free list link
+    return (class_index > 0) ? (int) class_index - 1 : 0;
+}
+
+static inline size_t messagepool_class_size(int class_index)
+{
+    return (class_index + 1) * MESSAGE_POOL_GRANULARITY;
+}
+
+void *messagepool_alloc(struct MessagePool *pool, size_t size)
+{
+    pool->allocs++;
+
+    int class_index = messagepool_class_index(size);
+    if (class_index < 0) {
+        void *buffer = malloc(size);
+        if (IS_NULL_PTR(buffer)) {
+            return NULL;
+        }
+        pool->large_live_buffers++;
+        pool->live_bytes += size;
+        return buffer;
+    }
+
+    struct MessagePoolClass *size_class = &pool->classes[class_index];
+    size_t class_size = messagepool_class_size(class_index);
+    void *buffer;
+    if (size_class->free_list) {
+        buffer = size_class->free_list;
+        size_class->free_list = size_class->free_list->next;
+        size_class->cached_buffers--;
+        pool->cached_bytes -= class_size;
+        pool->pool_hits++;
+    } else {
+        buffer = malloc(class_size);
+        if (IS_NULL_PTR(buffer)) {
+            return NULL;
+        }
+    }
+
+    size_class->live_buffers++;
+    pool->live_bytes += class_size;
+
+    return buffer;
+}
+
+void messagepool_free(struct MessagePool *pool, void *buffer, size_t size)
+{
+    if (!buffer) {
+        return;
+    }
+
+    int class_index = messagepool_class_index(size);
+    if (class_index < 0) {
+        pool->large_live_buffers--;
+        pool->live_bytes -= size;
+        free(buffer);
+        return;
+    }
+
+    struct MessagePoolClass *size_class = &pool->classes[class_index];
+    size_t class_size = messagepool_class_size(class_index);
+    size_class->live_buffers--;
+    pool->live_bytes -= class_size;
+
+    if ((size_class->cached_buffers + 1) * class_size > MESSAGE_POOL_CLASS_CACHE_SIZE) {
+        free(buffer);
+        return;
+    }
+
+    struct FreeBuffer *free_buffer = (struct FreeBuffer *) buffer;
+    free_buffer->next = size_class->free_list;
+    size_class->free_list = free_buffer;
+    size_class->cached_buffers++;
+    pool->cached_bytes += class_size;
+}
+
+term messagepool_stats_to_term(struct MessagePool *pool, Context *ctx)
+{
+    if (UNLIKELY(memory_ensure_free(ctx, (MESSAGE_POOL_CLASSES + 1) * (4 + 2) + 6 * (3 + 2)) != MEMORY_GC_OK)) {
+        return term_invalid_term();
+    }
+
+    term classes = term_nil();
+    term large_class = term_alloc_tuple(3, ctx);
+    term_put_tuple_element(large_class, 0, term_from_int32(0));
+    term_put_tuple_element(large_class, 1, term_from_counter(pool->large_live_buffers));
+    term_put_tuple_element(large_class, 2, term_from_int32(0));
+    classes = term_list_prepend(large_class, classes, ctx);
+
+    for (int i = MESSAGE_POOL_CLASSES - 1; i >= 0; i--) {
+        const struct MessagePoolClass *size_class = &pool->classes[i];
+        if (!size_class->live_buffers && !size_class->cached_buffers) {
+            continue;
+        }
+        term class_tuple = term_alloc_tuple(3, ctx);
+        term_put_tuple_element(class_tuple, 0, term_from_int32(messagepool_class_size(i) / sizeof(term)));
+        term_put_tuple_element(class_tuple, 1, term_from_counter(size_class->live_buffers));
+        term_put_tuple_element(class_tuple, 2, term_from_counter(size_class->cached_buffers));
+        classes = term_list_prepend(class_tuple, classes, ctx);
+    }
+
+    size_t live_words = pool->live_bytes / sizeof(term);
+    size_t cached_words = pool->cached_bytes / sizeof(term);
+    size_t total_words = live_words + cached_words;
+    int fragmentation = total_words ? (int) ((uint64_t) cached_words * 100 / total_words) : 0;
+
+    term stats = term_list_prepend_pair(CLASSES_ATOM, classes, term_nil(), ctx);
+    stats = term_list_prepend_pair(POOL_HITS_ATOM, term_from_counter(pool->pool_hits), stats, ctx);
+    stats = term_list_prepend_pair(ALLOCS_ATOM, term_from_counter(pool->allocs), stats, ctx);
+    stats = term_list_prepend_pair(FRAGMENTATION_ATOM, term_from_int32(fragmentation), stats, ctx);
+    stats = term_list_prepend_pair(CACHED_WORDS_ATOM, term_from_counter(cached_words), stats, ctx);
+    stats = term_list_prepend_pair(LIVE_WORDS_ATOM, term_from_counter(live_words), stats, ctx);
+
+    return stats;
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+/**
+ * @file messagepool.h
+ * @brief Message buffers allocator.
+ *
+ * @details Every sent message is copied to a newly allocated buffer that is released once the message has been
+ * received, so small message buffers are kept on per size class free lists and reused. Size classes are multiples of
+ * 2 terms, buffers larger than the biggest size class are allocated with malloc and released with free.
+ */
+
+#ifndef _MESSAGEPOOL_H_
+#define _MESSAGEPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "term.h"
+
+#ifndef TYPEDEF_CONTEXT
+#define TYPEDEF_CONTEXT
+typedef struct Context Context;
+#endif
+
+struct MessagePool;
+
+/**
+ * @brief Creates a new message pool.
+ *
+ * @returns a newly allocated MessagePool or NULL if memory cannot be allocated.
+ */
+struct MessagePool *messagepool_new();
+
+/**
+ * @brief Destroys a message pool.
+ *
+ * @details Cached buffers are released, buffers that are still in use must not be released after this call.
+ * @param pool the pool that will be destroyed.
+ */
+void messagepool_destroy(struct MessagePool *pool);
+
+/**
+ * @brief Allocates a message buffer.
+ *
+ * @details Memory is not zeroed.
+ * @param pool the pool the buffer is allocated from.
+ * @param size the required size in bytes.
+ * @returns the allocated buffer or NULL if memory cannot be allocated.
+ */
+void *messagepool_alloc(struct MessagePool *pool, size_t size);
+
+/**
+ * @brief Releases a message buffer.
+ *
+ * @param pool the pool the buffer has been allocated from.
+ * @param buffer the buffer that will be released, NULL is allowed.
+ * @param size the size the buffer has been allocated with, in bytes.
+ */
+void messagepool_free(struct MessagePool *pool, void *buffer, size_t size);
+
+/**
+ * @brief Returns message pool statistics.
+ *
+ * @details statistics are returned as a proplist with the same keys heappool_stats_to_term uses: live_words and
+ * cached_words are the total size of buffers in use and kept on free lists, fragmentation is the percentage of memory
+ * that is held by free lists, allocs and pool_hits count allocations and allocations served by free lists, classes is
+ * a list of {ClassSize, LiveBuffers, CachedBuffers} tuples. Buffers larger than the biggest size class are accounted
+ * with class size 0.
+ * @param pool the pool.
+ * @param ctx the context that will own the returned term.
+ * @returns statistics list or an invalid term if memory cannot be allocated.
+ */
+term messagepool_stats_to_term(struct MessagePool *pool, Context *ctx);
+
+#endif
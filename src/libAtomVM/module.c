@@ -23,7 +23,10 @@
 #include "bif.h"
 #include "context.h"
 #include "externalterm.h"
+#include "functionprofiler.h"
 #include "iff.h"
+#include "jit.h"
+#include "memory.h"
 #include "nifs.h"
 #include "utils.h"
 
@@ -40,10 +43,10 @@
 #ifdef WITH_ZLIB
     static void *module_uncompress_literals(const uint8_t *litT, int size);
 #endif
-static void const* *module_build_literals_table(const void *literalsBuf);
+static enum ModuleLoadResult module_load_literals(Module *mod, const void *literals_buf);
 static void module_add_label(Module *mod, int index, void *ptr);
 static enum ModuleLoadResult module_build_imported_functions_table(Module *this_module, uint8_t *table_data);
-static void module_add_label(Module *mod, int index, void *ptr);
+static enum ModuleLoadResult module_shrink_instructions(Module *mod, int instructions_count);
 
 #define IMPL_CODE_LOADER 1
 #include "opcodesswitch.h"
@@ -123,7 +126,6 @@ static enum ModuleLoadResult module_build_imported_functions_table(Module *this_
     return MODULE_LOAD_OK;
 }
 
-#ifdef ENABLE_ADVANCED_TRACE
 void module_get_imported_function_module_and_name(const Module *this_module, int index, AtomString *module_atom, AtomString *function_atom)
 {
     const uint8_t *table_data = (const uint8_t *) this_module->import_table;
@@ -137,7 +139,6 @@ void module_get_imported_function_module_and_name(const Module *this_module, int
     *module_atom = module_get_atom_string_by_id(this_module, local_module_atom_index);
     *function_atom = module_get_atom_string_by_id(this_module, local_function_atom_index);
 }
-#endif
 
 uint32_t module_search_exported_function(Module *this_module, AtomString func_name, int func_arity)
 {
@@ -161,6 +162,29 @@ static void module_add_label(Module *mod, int index, void *ptr)
     mod->labels[index] = ptr;
 }
 
+static enum ModuleLoadResult module_shrink_instructions(Module *mod, int instructions_count)
+{
+    uintptr_t old_instructions = (uintptr_t) mod->instructions;
+    term *new_instructions = realloc(mod->instructions, instructions_count * sizeof(term));
+    if (IS_NULL_PTR(new_instructions)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        return MODULE_ERROR_FAILED_ALLOCATION;
+    }
+
+    if ((uintptr_t) new_instructions != old_instructions) {
+        int labels_count = ENDIAN_SWAP_32(mod->code->labels);
+        for (int i = 0; i < labels_count; i++) {
+            if (mod->labels[i]) {
+                uintptr_t label_offset = (uintptr_t) mod->labels[i] - old_instructions;
+                mod->labels[i] = (uint8_t *) new_instructions + label_offset;
+            }
+        }
+    }
+    mod->instructions = new_instructions;
+
+    return MODULE_LOAD_OK;
+}
+
 Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary, unsigned long size)
 {
     uint8_t *beam_file = (void *) iff_binary;
@@ -189,9 +213,7 @@ Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary
         return NULL;
     }
 
-#ifdef ENABLE_ADVANCED_TRACE
     mod->import_table = beam_file + offsets[IMPT];
-#endif
     mod->code = (CodeChunk *) (beam_file + offsets[CODE]);
     mod->export_table = beam_file + offsets[EXPT];
     mod->atom_table = beam_file + offsets[AT8U];
@@ -204,8 +226,14 @@ Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary
 
     if (offsets[LITT]) {
         #ifdef WITH_ZLIB
-            mod->literals_data = module_uncompress_literals(beam_file + offsets[LITT], sizes[LITT]);
-            if (IS_NULL_PTR(mod->literals_data)) {
+            void *literals_data = module_uncompress_literals(beam_file + offsets[LITT], sizes[LITT]);
+            if (IS_NULL_PTR(literals_data)) {
+                module_destroy(mod);
+                return NULL;
+            }
+            enum ModuleLoadResult result = module_load_literals(mod, literals_data);
+            free(literals_data);
+            if (UNLIKELY(result != MODULE_LOAD_OK)) {
                 module_destroy(mod);
                 return NULL;
             }
@@ -215,33 +243,78 @@ Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary
             return NULL;
         #endif
 
-        mod->literals_table = module_build_literals_table(mod->literals_data);
-        mod->free_literals_data = 1;
-
     } else if (offsets[LITU]) {
-        mod->literals_data = beam_file + offsets[LITU] + IFF_SECTION_HEADER_SIZE;
-        mod->literals_table = module_build_literals_table(mod->literals_data);
-        mod->free_literals_data = 0;
+        if (UNLIKELY(module_load_literals(mod, beam_file + offsets[LITU] + IFF_SECTION_HEADER_SIZE) != MODULE_LOAD_OK)) {
+            module_destroy(mod);
+            return NULL;
+        }
+    }
 
-    } else {
-        mod->literals_data = NULL;
-        mod->literals_table = NULL;
-        mod->free_literals_data = 0;
+    uint32_t code_size = ENDIAN_SWAP_32(mod->code->size) - sizeof(uint32_t) - ENDIAN_SWAP_32(mod->code->info_size);
+    // every instruction and operand takes at least one byte, so this is an upper bound
+    // plus one more word for the int_trap_resume instruction that follows int_call_end
+    mod->instructions = malloc((code_size + 2) * sizeof(term));
+    if (IS_NULL_PTR(mod->instructions)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        module_destroy(mod);
+        return NULL;
+    }
+
+#ifdef ENABLE_JIT
+    // the same upper bound is used, the module is interpreted if this cannot be allocated
+    mod->jit_instructions = malloc((code_size + 2) * sizeof(unsigned int));
+#endif
+
+#ifdef ENABLE_FUNCTION_PROFILER
+    mod->function_offsets = malloc(ENDIAN_SWAP_32(mod->code->functions_count) * sizeof(unsigned int));
+    if (IS_NULL_PTR(mod->function_offsets)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        module_destroy(mod);
+        return NULL;
     }
+#endif
 
     mod->end_instruction_ii = read_core_chunk(mod);
 
+    if (mod->call_site_caches_count) {
+        mod->call_site_caches = calloc(mod->call_site_caches_count, sizeof(struct CallSiteCache));
+        if (IS_NULL_PTR(mod->call_site_caches)) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            module_destroy(mod);
+            return NULL;
+        }
+    }
+
+    if (UNLIKELY(module_shrink_instructions(mod, mod->end_instruction_ii + 2) != MODULE_LOAD_OK)) {
+        module_destroy(mod);
+        return NULL;
+    }
+
+#ifdef ENABLE_JIT
+    jit_compile_module(mod);
+#endif
+
     return mod;
 }
 
 COLD_FUNC void module_destroy(Module *module)
 {
+    free(module->instructions);
     free(module->labels);
     free(module->imported_funcs);
-    free(module->literals_table);
-    if (module->free_literals_data) {
-        free(module->literals_data);
+    free(module->call_site_caches);
+#ifdef ENABLE_FUNCTION_PROFILER
+    free(module->function_offsets);
+    functionprofiler_module_destroy(module);
+#endif
+#ifdef ENABLE_JIT
+    jit_module_destroy(module);
+#endif
+    if (module->literals_heap) {
+        memory_unregister_literal_area(module->literals_heap);
+        free(module->literals_heap);
     }
+    free(module->literals);
     free(module);
 }
 
@@ -281,30 +354,50 @@ static void *module_uncompress_literals(const uint8_t *litT, int size)
 }
 #endif
 
-static void const* *module_build_literals_table(const void *literalsBuf)
+static enum ModuleLoadResult module_load_literals(Module *mod, const void *literals_buf)
 {
-    uint32_t terms_count = READ_32_ALIGNED(literalsBuf);
-
-    const uint8_t *pos = (const uint8_t *) literalsBuf + sizeof(uint32_t);
+    uint32_t terms_count = READ_32_ALIGNED(literals_buf);
+    const uint8_t *first_literal = (const uint8_t *) literals_buf + sizeof(uint32_t);
 
-    void const* *literals_table = calloc(terms_count, sizeof(void *const));
-    if (IS_NULL_PTR(literals_table)) {
+    mod->literals = malloc(terms_count * sizeof(term));
+    if (IS_NULL_PTR(mod->literals)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
-        return NULL;
+        return MODULE_ERROR_FAILED_ALLOCATION;
     }
+
+    int heap_size = 0;
+    const uint8_t *pos = first_literal;
     for (uint32_t i = 0; i < terms_count; i++) {
         uint32_t term_size = READ_32_UNALIGNED(pos);
-        literals_table[i] = pos + sizeof(uint32_t);
+        heap_size += externalterm_heap_usage(pos + sizeof(uint32_t));
 
         pos += term_size + sizeof(uint32_t);
     }
 
-    return literals_table;
-}
+    if (heap_size > 0) {
+        mod->literals_heap = malloc(heap_size * sizeof(term));
+        if (IS_NULL_PTR(mod->literals_heap)) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            return MODULE_ERROR_FAILED_ALLOCATION;
+        }
+    }
 
-term module_load_literal(Module *mod, int index, Context *ctx)
-{
-    return externalterm_to_term(mod->literals_table[index], ctx);
+    term *heap_ptr = mod->literals_heap;
+    pos = first_literal;
+    for (uint32_t i = 0; i < terms_count; i++) {
+        uint32_t term_size = READ_32_UNALIGNED(pos);
+        mod->literals[i] = externalterm_to_term_in_heap(pos + sizeof(uint32_t), &heap_ptr, mod->global);
+
+        pos += term_size + sizeof(uint32_t);
+    }
+
+    if (heap_size > 0 && UNLIKELY(!memory_register_literal_area(mod->literals_heap, heap_ptr))) {
+        free(mod->literals_heap);
+        mod->literals_heap = NULL;
+        return MODULE_ERROR_FAILED_ALLOCATION;
+    }
+
+    return MODULE_LOAD_OK;
 }
 
 const struct ExportedFunction *module_resolve_function(Module *mod, int import_table_index)
@@ -340,8 +433,65 @@ const struct ExportedFunction *module_resolve_function(Module *mod, int import_t
         return &mfunc->base;
     } else {
         char buf[256];
-        atom_string_to_c(module_name_atom, buf, 256);
-        fprintf(stderr, "Warning: module %s cannot be resolved.\n", buf);
+        atom_write_mfa(buf, 256, module_name_atom, function_name_atom, arity);
+        fprintf(stderr, "Warning: function %s cannot be resolved, its module cannot be loaded.\n", buf);
         return NULL;
     }
 }
+
+const struct CallSiteCacheEntry *module_call_site_cache_resolve(Module *mod, struct CallSiteCache *cache, term module_atom, term function_atom, int arity)
+{
+    AtomString module_name = globalcontext_atomstring_from_term(mod->global, module_atom);
+    AtomString function_name = globalcontext_atomstring_from_term(mod->global, function_atom);
+
+    const struct Nif *nif = nifs_get(module_name, function_name, arity);
+    Module *target_module = NULL;
+    int target_label = 0;
+
+    if (IS_NULL_PTR(nif)) {
+        target_module = globalcontext_get_module(mod->global, module_name);
+        if (IS_NULL_PTR(target_module)) {
+            return NULL;
+        }
+        target_label = module_search_exported_function(target_module, function_name, arity);
+        if (target_label == 0) {
+            return NULL;
+        }
+    }
+
+    struct CallSiteCacheEntry *entry = &cache->entries[cache->next_entry];
+    cache->next_entry = (cache->next_entry + 1) % CALL_SITE_CACHE_WAYS;
+
+    entry->module_atom = module_atom;
+    entry->function_atom = function_atom;
+    entry->nif = nif;
+    entry->target_module = target_module;
+    entry->target_label = target_label;
+
+    return entry;
+}
+
+int module_link(Module *mod)
+{
+    const uint8_t *table_data = (const uint8_t *) mod->import_table;
+    int functions_count = READ_32_ALIGNED(table_data + 8);
+    int unresolved_count = 0;
+
+    for (int i = 0; i < functions_count; i++) {
+        AtomString module_atom;
+        AtomString function_atom;
+        module_get_imported_function_module_and_name(mod, i, &module_atom, &function_atom);
+        uint32_t arity = READ_32_ALIGNED(table_data + i * 12 + 8 + 12);
+
+        // BIF entries are plain function pointers, they don't have an ExportedFunction header
+        if (bif_registry_get_handler(module_atom, function_atom, arity)) {
+            continue;
+        }
+
+        if ((mod->imported_funcs[i].func->type == UnresolvedFunctionCall) && !module_resolve_function(mod, i)) {
+            unresolved_count++;
+        }
+    }
+
+    return unresolved_count;
+}
@@ -48,16 +48,40 @@ typedef struct
 } __attribute__((packed)) CodeChunk;
 
 struct ExportedFunction;
+struct FunctionProfile;
+struct Nif;
+
+#ifndef TYPEDEF_MODULE
+#define TYPEDEF_MODULE
+typedef struct Module Module;
+#endif
+
+#define CALL_SITE_CACHE_WAYS 4
+
+struct CallSiteCacheEntry
+{
+    term module_atom;
+    term function_atom;
+
+    const struct Nif *nif;
+    Module *target_module;
+    int target_label;
+};
+
+struct CallSiteCache
+{
+    struct CallSiteCacheEntry entries[CALL_SITE_CACHE_WAYS];
+    unsigned int next_entry;
+};
 
 struct Module
 {
     GlobalContext *global;
 
-#ifdef ENABLE_ADVANCED_TRACE
     void *import_table;
-#endif
 
     CodeChunk *code;
+    term *instructions;
     void *export_table;
     void *atom_table;
     void *fun_table;
@@ -65,10 +89,21 @@ struct Module
     union imported_func *imported_funcs;
     void *local_labels;
 
+    struct CallSiteCache *call_site_caches;
+    unsigned int call_site_caches_count;
+
+#ifdef ENABLE_FUNCTION_PROFILER
+    unsigned int *function_offsets;
+    int functions_count;
+    struct FunctionProfile *function_profiles;
+    struct FunctionProfile *import_profiles;
+#endif
+
     void **labels;
 
-    void *literals_data;
-    void const* *literals_table;
+    // literals are decoded once when the module is loaded, processes reference them in place
+    term *literals;
+    term *literals_heap;
 
     int *local_atoms_to_global_table;
 
@@ -78,13 +113,15 @@ struct Module
 
     int end_instruction_ii;
 
-    unsigned int free_literals_data : 1;
-};
+#ifdef ENABLE_JIT
+    // emitted instructions, recorded by the code loader for jit_compile_module and then released
+    unsigned int *jit_instructions;
+    unsigned int jit_instructions_count;
 
-#ifndef TYPEDEF_MODULE
-#define TYPEDEF_MODULE
-typedef struct Module Module;
+    void *native_code;
+    unsigned long native_code_size;
 #endif
+};
 
 enum ModuleLoadResult
 {
@@ -92,7 +129,6 @@ enum ModuleLoadResult
     MODULE_ERROR_FAILED_ALLOCATION = 1
 };
 
-#ifdef ENABLE_ADVANCED_TRACE
 /**
  * @briefs Gets imported function module and name
  *
@@ -102,7 +138,6 @@ enum ModuleLoadResult
  * @param function_atom function name atom string.
  */
 void module_get_imported_function_module_and_name(const Module *this_module, int index, AtomString *module_atom, AtomString *function_atom);
-#endif
 
 /**
  * @briefs Gets exported function index by searching it by function name and arity
@@ -134,11 +169,15 @@ Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary
 /**
  * @brief Gets a literal stored on the literal table of the specified module
  *
- * @details Loads and deserialize a term stored in the literal table and returns a term.
- * @param mod The module that owns that is going to be loaded.
+ * @details Literals are stored in a read only literal area owned by the module, so the returned term is not copied
+ * to the process heap and it must not be modified.
+ * @param mod The module that owns the literal.
  * @param index a valid literal index.
  */
-term module_load_literal(Module *mod, int index, Context *ctx);
+static inline term module_get_literal(const Module *mod, int index)
+{
+    return mod->literals[index];
+}
 
 /**
  * @brief Gets the AtomString for the given local atom id
@@ -178,6 +217,53 @@ static inline term module_get_atom_term_by_id(const Module *mod, int local_atom_
  */
 const struct ExportedFunction *module_resolve_function(Module *mod, int import_table_index);
 
+/**
+ * @brief Resolves all the imported functions of a module
+ *
+ * @details Resolves every import that is neither a BIF nor a NIF to a ModuleFunction, loading referenced modules
+ * when required, so call_ext doesn't have to resolve them on first call. Imports that cannot be resolved are reported
+ * on stderr and they are left unresolved.
+ * @param mod the module that will be linked.
+ * @return the number of imported functions that cannot be resolved.
+ */
+int module_link(Module *mod);
+
+/**
+ * @brief Looks up a dynamic call target in a call site cache
+ *
+ * @details Searches the entries of an apply call site cache for the given module and function atoms, the arity is
+ * not part of the key since it is fixed for each call site.
+ * @param cache the call site cache.
+ * @param module_atom the called module atom term.
+ * @param function_atom the called function atom term.
+ * @return the matching cache entry or NULL if there is a cache miss.
+ */
+static inline const struct CallSiteCacheEntry *module_call_site_cache_lookup(const struct CallSiteCache *cache, term module_atom, term function_atom)
+{
+    for (int i = 0; i < CALL_SITE_CACHE_WAYS; i++) {
+        const struct CallSiteCacheEntry *entry = &cache->entries[i];
+        if ((entry->module_atom == module_atom) && (entry->function_atom == function_atom)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Resolves a dynamic call target and stores it in a call site cache
+ *
+ * @details Resolves module_atom:function_atom/arity either to a NIF or to an exported function (loading its module
+ * when required), then it stores the result in the call site cache replacing its oldest entry.
+ * @param mod the module that owns the call site.
+ * @param cache the call site cache.
+ * @param module_atom the called module atom term.
+ * @param function_atom the called function atom term.
+ * @param arity the called function arity.
+ * @return the new cache entry or NULL if the function cannot be resolved.
+ */
+const struct CallSiteCacheEntry *module_call_site_cache_resolve(Module *mod, struct CallSiteCache *cache, term module_atom, term function_atom, int arity);
+
 /*
  * @brief Casts an instruction index and module index to a return address
  *
@@ -24,6 +24,11 @@
 #include "atomshashtable.h"
 #include "context.h"
 #include "defaultatoms.h"
+#ifdef ENABLE_FUNCTION_PROFILER
+#include "functionprofiler.h"
+#endif
+#include "heappool.h"
+#include "messagepool.h"
 #include "interop.h"
 #include "mailbox.h"
 #include "module.h"
@@ -40,6 +45,9 @@
 
 #define MAX_NIF_NAME_LEN 260
 
+// list items or bytes processed by yielding NIFs before checking if the time slice has expired
+#define NIF_CHUNK_SIZE 256
+
 #define VALIDATE_VALUE(value, verify_function) \
     if (UNLIKELY(!verify_function((value)))) { \
         argv[0] = ERROR_ATOM; \
@@ -54,6 +62,12 @@
 
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 
+#if TERM_BITS == 32
+    #define MAX_REDUCTIONS_VALUE 0x0FFFFFFF
+#else
+    #define MAX_REDUCTIONS_VALUE 0x0FFFFFFFFFFFFFFF
+#endif
+
 #ifdef ENABLE_ADVANCED_TRACE
 static const char *const trace_calls_atom = "\xB" "trace_calls";
 static const char *const trace_call_args_atom = "\xF" "trace_call_args";
@@ -105,10 +119,14 @@ static term nif_erlang_tuple_to_list_1(Context *ctx, int argc, term argv[]);
 static term nif_erlang_universaltime_0(Context *ctx, int argc, term argv[]);
 static term nif_erlang_timestamp_0(Context *ctx, int argc, term argv[]);
 static term nif_erts_debug_flat_size(Context *ctx, int argc, term argv[]);
+static term nif_erts_debug_size(Context *ctx, int argc, term argv[]);
+static term nif_persistent_term_get(Context *ctx, int argc, term argv[]);
+static term nif_persistent_term_put_2(Context *ctx, int argc, term argv[]);
 static term nifs_erlang_process_flag(Context *ctx, int argc, term argv[]);
 static term nifs_erlang_processes(Context *ctx, int argc, term argv[]);
 static term nifs_erlang_process_info(Context *ctx, int argc, term argv[]);
 static term nifs_erlang_system_info(Context *ctx, int argc, term argv[]);
+static term nifs_erlang_system_flag(Context *ctx, int argc, term argv[]);
 
 static const struct Nif binary_at_nif =
 {
@@ -337,6 +355,23 @@ static const struct Nif flat_size_nif =
     .base.type = NIFFunctionType,
     .nif_ptr = nif_erts_debug_flat_size
 };
+static const struct Nif size_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erts_debug_size
+};
+
+static const struct Nif persistent_term_get_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_persistent_term_get
+};
+
+static const struct Nif persistent_term_put_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_persistent_term_put_2
+};
 
 static const struct Nif process_flag_nif =
 {
@@ -362,6 +397,12 @@ static const struct Nif system_info_nif =
     .nif_ptr = nifs_erlang_system_info
 };
 
+static const struct Nif system_flag_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nifs_erlang_system_flag
+};
+
 //Ignore warning caused by gperf generated code
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
@@ -492,7 +533,7 @@ static void process_echo_mailbox(Context *ctx)
     Context *target = globalcontext_get_process(ctx->global, local_process_id);
     mailbox_send(target, val);
 
-    free(msg);
+    mailbox_destroy_message(ctx, msg);
 }
 
 static void process_console_mailbox(Context *ctx)
@@ -534,7 +575,107 @@ static void process_console_mailbox(Context *ctx)
         fprintf(stderr, "WARNING: Invalid port command.  Unable to send reply");
     }
 
-    free(message);
+    mailbox_destroy_message(ctx, message);
+}
+
+static inline int is_valid_fullsweep_after(term t)
+{
+    return term_is_integer(t) && (term_to_int32(t) >= 0);
+}
+
+static inline int is_valid_compacting_gc_threshold(term t)
+{
+    return term_is_integer(t) && (term_to_int32(t) >= 0);
+}
+
+static inline int is_valid_max_gc_pause(term t)
+{
+    return term_is_integer(t) && (term_to_int32(t) >= 0);
+}
+
+static inline int is_valid_heap_growth(term t)
+{
+    return (t == MINIMUM_ATOM) || (t == FIBONACCI_ATOM);
+}
+
+static inline enum HeapGrowthStrategy heap_growth_from_atom(term t)
+{
+    return (t == MINIMUM_ATOM) ? MinimumHeapGrowth : FibonacciHeapGrowth;
+}
+
+static inline term heap_growth_to_atom(enum HeapGrowthStrategy heap_growth)
+{
+    return (heap_growth == MinimumHeapGrowth) ? MINIMUM_ATOM : FIBONACCI_ATOM;
+}
+
+// spawn options are checked before creating the new process, so it is not leaked when they are not valid
+static int nifs_are_valid_spawn_opts(term opts_term)
+{
+    term min_heap_size_term = interop_proplist_get_value(opts_term, MIN_HEAP_SIZE_ATOM);
+    term max_heap_size_term = interop_proplist_get_value(opts_term, MAX_HEAP_SIZE_ATOM);
+    if (min_heap_size_term != term_nil() && !term_is_integer(min_heap_size_term)) {
+        return 0;
+    }
+    if (max_heap_size_term != term_nil() && !term_is_integer(max_heap_size_term)) {
+        return 0;
+    }
+    if (min_heap_size_term != term_nil() && max_heap_size_term != term_nil()) {
+        if (term_to_int32(min_heap_size_term) > term_to_int32(max_heap_size_term)) {
+            return 0;
+        }
+    }
+
+    term fullsweep_after_term = interop_proplist_get_value(opts_term, FULLSWEEP_AFTER_ATOM);
+    if (fullsweep_after_term != term_nil() && !is_valid_fullsweep_after(fullsweep_after_term)) {
+        return 0;
+    }
+
+    term heap_growth_term = interop_proplist_get_value(opts_term, HEAP_GROWTH_ATOM);
+    if (heap_growth_term != term_nil() && !is_valid_heap_growth(heap_growth_term)) {
+        return 0;
+    }
+
+    term compacting_gc_threshold_term = interop_proplist_get_value(opts_term, COMPACTING_GC_THRESHOLD_ATOM);
+    if (compacting_gc_threshold_term != term_nil() && !is_valid_compacting_gc_threshold(compacting_gc_threshold_term)) {
+        return 0;
+    }
+
+    term max_gc_pause_term = interop_proplist_get_value(opts_term, MAX_GC_PAUSE_ATOM);
+    if (max_gc_pause_term != term_nil() && !is_valid_max_gc_pause(max_gc_pause_term)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+static void nifs_set_spawn_opts(Context *new_ctx, term opts_term)
+{
+    term min_heap_size_term = interop_proplist_get_value(opts_term, MIN_HEAP_SIZE_ATOM);
+    if (min_heap_size_term != term_nil()) {
+        new_ctx->has_min_heap_size = 1;
+        new_ctx->min_heap_size = term_to_int32(min_heap_size_term);
+    }
+    term max_heap_size_term = interop_proplist_get_value(opts_term, MAX_HEAP_SIZE_ATOM);
+    if (max_heap_size_term != term_nil()) {
+        new_ctx->has_max_heap_size = 1;
+        new_ctx->max_heap_size = term_to_int32(max_heap_size_term);
+    }
+    term fullsweep_after_term = interop_proplist_get_value(opts_term, FULLSWEEP_AFTER_ATOM);
+    if (fullsweep_after_term != term_nil()) {
+        new_ctx->fullsweep_after = term_to_int32(fullsweep_after_term);
+    }
+    term heap_growth_term = interop_proplist_get_value(opts_term, HEAP_GROWTH_ATOM);
+    if (heap_growth_term != term_nil()) {
+        new_ctx->heap_growth = heap_growth_from_atom(heap_growth_term);
+    }
+    term compacting_gc_threshold_term = interop_proplist_get_value(opts_term, COMPACTING_GC_THRESHOLD_ATOM);
+    if (compacting_gc_threshold_term != term_nil()) {
+        new_ctx->compacting_gc_threshold = term_to_int32(compacting_gc_threshold_term);
+    }
+    term max_gc_pause_term = interop_proplist_get_value(opts_term, MAX_GC_PAUSE_ATOM);
+    if (max_gc_pause_term != term_nil()) {
+        new_ctx->max_gc_pause = term_to_int32(max_gc_pause_term);
+    }
 }
 
 static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
@@ -551,6 +692,10 @@ static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
         opts_term = term_nil();
     }
 
+    if (UNLIKELY(!nifs_are_valid_spawn_opts(opts_term))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
     Context *new_ctx = context_new(ctx->global);
 
     const term *boxed_value = term_to_const_term_ptr(fun_term);
@@ -565,18 +710,25 @@ static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
 
     // TODO: new process should fail with badarity if arity != 0
 
-    for (unsigned int i = arity - n_freeze; i < arity + n_freeze; i++) {
-        new_ctx->x[i] = boxed_value[i - (arity - n_freeze) + 3];
-    }
-
     new_ctx->saved_module = fun_module;
     new_ctx->saved_ip = fun_module->labels[label];
     new_ctx->cp = module_address(fun_module->module_index, fun_module->end_instruction_ii);
 
-    term max_heap_size_term = interop_proplist_get_value(opts_term, MAX_HEAP_SIZE_ATOM);
-    if (max_heap_size_term != term_nil()) {
-        new_ctx->has_max_heap_size = 1;
-        new_ctx->max_heap_size = term_to_int32(max_heap_size_term);
+    nifs_set_spawn_opts(new_ctx, opts_term);
+
+    // frozen values are copied to the new process heap, as spawn arguments
+    unsigned long frozen_size = 0;
+    for (unsigned int i = 0; i < n_freeze; i++) {
+        frozen_size += memory_estimate_usage(boxed_value[i + 3]);
+    }
+    uint32_t size = MAX((unsigned long) new_ctx->min_heap_size, frozen_size);
+    if (UNLIKELY(memory_ensure_free(new_ctx, size) != MEMORY_GC_OK)) {
+        //TODO: new process should be terminated, however a new pid is returned anyway
+        fprintf(stderr, "Unable to allocate sufficient memory to spawn process.\n");
+        abort();
+    }
+    for (unsigned int i = arity - n_freeze; i < arity; i++) {
+        new_ctx->x[i] = memory_copy_term_tree(&new_ctx->heap_ptr, boxed_value[i - (arity - n_freeze) + 3]);
     }
 
     return term_from_local_process_id(new_ctx->process_id);
@@ -600,6 +752,10 @@ static term nif_erlang_spawn(Context *ctx, int argc, term argv[])
         opts_term = term_nil();
     }
 
+    if (UNLIKELY(!nifs_are_valid_spawn_opts(opts_term))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
     Context *new_ctx = context_new(ctx->global);
 
     AtomString module_string = globalcontext_atomstring_from_term(ctx->global, argv[0]);
@@ -616,42 +772,28 @@ static term nif_erlang_spawn(Context *ctx, int argc, term argv[])
     new_ctx->saved_ip = found_module->labels[label];
     new_ctx->cp = module_address(found_module->module_index, found_module->end_instruction_ii);
 
-    term min_heap_size_term = interop_proplist_get_value(opts_term, MIN_HEAP_SIZE_ATOM);
-    term max_heap_size_term = interop_proplist_get_value(opts_term, MAX_HEAP_SIZE_ATOM);
-    if (min_heap_size_term != term_nil() && max_heap_size_term != term_nil()) {
-        if (term_to_int32(min_heap_size_term) > term_to_int32(max_heap_size_term)) {
-            RAISE_ERROR(BADARG_ATOM);
-        }
-    }
-    if (min_heap_size_term != term_nil()) {
-        new_ctx->has_min_heap_size = 1;
-        new_ctx->min_heap_size = term_to_int32(min_heap_size_term);
-    } else {
-        min_heap_size_term = term_from_int32(0);
-    }
-    if (max_heap_size_term != term_nil()) {
-        new_ctx->has_max_heap_size = 1;
-        new_ctx->max_heap_size = term_to_int32(max_heap_size_term);
-    }
+    nifs_set_spawn_opts(new_ctx, opts_term);
 
     //TODO: check available registers count
     int reg_index = 0;
-    term t = argv[2];
-    uint32_t size = MAX(term_to_int32(min_heap_size_term), memory_estimate_usage(t));
+    uint32_t size = MAX((unsigned long) new_ctx->min_heap_size, memory_estimate_usage(argv[2]));
     if (UNLIKELY(memory_ensure_free(new_ctx, size) != MEMORY_GC_OK)) {
         //TODO: new process should be terminated, however a new pid is returned anyway
         fprintf(stderr, "Unable to allocate sufficient memory to spawn process.\n");
         abort();
     }
+    // arguments list is copied at once, so subterms shared between arguments are copied once
+    term t = memory_copy_term_tree(&new_ctx->heap_ptr, argv[2]);
     while (!term_is_nil(t)) {
         term *t_ptr = term_get_list_ptr(t);
-        new_ctx->x[reg_index] = memory_copy_term_tree(&new_ctx->heap_ptr, t_ptr[1]);
+        new_ctx->x[reg_index] = t_ptr[1];
         t = *t_ptr;
         reg_index++;
     }
 
     return term_from_local_process_id(new_ctx->process_id);
 }
+
 static term nif_erlang_send_2(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -677,57 +819,119 @@ static term nif_erlang_is_process_alive_1(Context *ctx, int argc, term argv[])
     return target ? TRUE_ATOM : FALSE_ATOM;
 }
 
-static term nif_erlang_concat_2(Context *ctx, int argc, term argv[])
+/*
+ * Walks up to NIF_CHUNK_SIZE items of a list, list is updated to the first item that has not been walked.
+ * When validate_bytes is set list items must be integers in the 0..255 range.
+ * Returns the number of walked items, or -1 if an invalid item has been found.
+ */
+static int walk_list_chunk(term *list, int validate_bytes)
+{
+    term t = *list;
+    int count = 0;
+
+    while (term_is_nonempty_list(t) && (count < NIF_CHUNK_SIZE)) {
+        if (validate_bytes) {
+            term head = term_get_list_head(t);
+            if (UNLIKELY(!term_is_integer(head) || (term_to_int32(head) < 0) || (term_to_int32(head) > 255))) {
+                return -1;
+            }
+        }
+        t = term_get_list_tail(t);
+        count++;
+    }
+    *list = t;
+
+    return count;
+}
+
+// argv: list to be copied, appended list, copy of the chunks that have been copied and first items of the chunks still
+// to be copied, last one first
+static term concat_copy_continue(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
 
-    term prepend_list = argv[0];
+    do {
+        if (UNLIKELY(memory_ensure_free(ctx, NIF_CHUNK_SIZE * 2) != MEMORY_GC_OK)) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
 
-    if (UNLIKELY(!term_is_nonempty_list(prepend_list))) {
-        if (term_is_nil(prepend_list)) {
-            return argv[1];
+        // GC might have changed all pointers
+        term chunks = argv[3];
+        term t = term_get_list_head(chunks);
+        term chunk_end = t;
+        int count = walk_list_chunk(&chunk_end, 0);
+
+        // cells of a chunk are allocated together and each one references the next one, the last one references the
+        // copy of the following chunks: chunks are copied from the last one, so no cell is written once it is built
+        term *cells = memory_heap_alloc(ctx, count * 2);
+        for (int i = 0; i < count - 1; i++) {
+            term_list_init_prepend(cells + i * 2, term_get_list_head(t), term_list_from_list_ptr(cells + (i + 1) * 2));
+            t = term_get_list_tail(t);
+        }
+        term copy = term_list_init_prepend(cells + (count - 1) * 2, term_get_list_head(t), argv[2]);
+        context_consume_work(ctx, count);
 
-        } else {
-            RAISE_ERROR(BADARG_ATOM);
+        chunks = term_get_list_tail(chunks);
+        if (term_is_nil(chunks)) {
+            return copy;
         }
-    }
 
-    int len = term_list_length(prepend_list);
-    if (UNLIKELY(memory_ensure_free(ctx, len * 2) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
+        argv[2] = copy;
+        argv[3] = chunks;
+    } while (!context_time_slice_expired(ctx));
 
-    // GC might have changed all pointers
-    prepend_list = argv[0];
-    term append_list = argv[1];
+    return context_trap_nif(ctx, concat_copy_continue, 4, argv);
+}
 
-    term t = prepend_list;
-    term list_begin = term_nil();
-    term *prev_term = NULL;
+// argv: list to be copied, appended list, first item that has not been walked yet and first items of the chunks that
+// have been walked, last one first
+static term concat_split_continue(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
 
-    // TODO: handle impropers list
-    while (!term_is_nil(t)) {
-        term head = term_get_list_head(t);
+    do {
+        if (UNLIKELY(memory_ensure_free(ctx, 2) != MEMORY_GC_OK)) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
 
-        term *new_list_item = term_list_alloc(ctx);
+        // GC might have changed all pointers
+        term t = argv[2];
+        argv[3] = term_list_prepend(t, argv[3], ctx);
+        int count = walk_list_chunk(&t, 0);
+        context_consume_work(ctx, count);
 
-        if (prev_term) {
-            prev_term[0] = term_list_from_list_ptr(new_list_item);
-        } else {
-            list_begin = term_list_from_list_ptr(new_list_item);
+        if (term_is_nil(t)) {
+            argv[2] = argv[1];
+            return concat_copy_continue(ctx, 4, argv);
+        } else if (UNLIKELY(!term_is_nonempty_list(t))) {
+            RAISE_ERROR(BADARG_ATOM);
         }
+        argv[2] = t;
+    } while (!context_time_slice_expired(ctx));
 
-        prev_term = new_list_item;
-        new_list_item[1] = head;
+    return context_trap_nif(ctx, concat_split_continue, 4, argv);
+}
 
-        t = term_get_list_tail(t);
-    }
+static term nif_erlang_concat_2(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term prepend_list = argv[0];
+
+    if (UNLIKELY(!term_is_nonempty_list(prepend_list))) {
+        if (term_is_nil(prepend_list)) {
+            return argv[1];
 
-    if (prev_term) {
-        prev_term[0] = append_list;
+        } else {
+            RAISE_ERROR(BADARG_ATOM);
+        }
     }
 
-    return list_begin;
+    // the prepended list is split in chunks first, then they are copied starting from the last one
+    argv[2] = prepend_list;
+    argv[3] = term_nil();
+
+    return concat_split_continue(ctx, 4, argv);
 }
 
 term nif_erlang_make_ref_0(Context *ctx, int argc, term argv[])
@@ -829,6 +1033,7 @@ static term nif_erlang_make_tuple_2(Context *ctx, int argc, term argv[])
     if (UNLIKELY(count_elem < 0)) {
         RAISE_ERROR(BADARG_ATOM);
     }
+    context_consume_work(ctx, count_elem);
 
     if (UNLIKELY(memory_ensure_free(ctx, count_elem + 1) != MEMORY_GC_OK)) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
@@ -861,6 +1066,7 @@ static term nif_erlang_insert_element_3(Context *ctx, int argc, term argv[])
     }
 
     int new_tuple_size = old_tuple_size + 1;
+    context_consume_work(ctx, new_tuple_size);
     if (UNLIKELY(memory_ensure_free(ctx, new_tuple_size + 1) != MEMORY_GC_OK)) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
     }
@@ -900,6 +1106,7 @@ static term nif_erlang_delete_element_2(Context *ctx, int argc, term argv[])
     }
 
     int new_tuple_size = old_tuple_size - 1;
+    context_consume_work(ctx, new_tuple_size);
     if (UNLIKELY(memory_ensure_free(ctx, new_tuple_size + 1) != MEMORY_GC_OK)) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
     }
@@ -934,6 +1141,7 @@ static term nif_erlang_setelement_3(Context *ctx, int argc, term argv[])
         RAISE_ERROR(BADARG_ATOM);
     }
 
+    context_consume_work(ctx, tuple_size);
     if (UNLIKELY(memory_ensure_free(ctx, tuple_size + 1) != MEMORY_GC_OK)) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
     }
@@ -957,6 +1165,7 @@ static term nif_erlang_tuple_to_list_1(Context *ctx, int argc, term argv[])
     VALIDATE_VALUE(argv[0], term_is_tuple);
 
     int tuple_size = term_get_tuple_arity(argv[0]);
+    context_consume_work(ctx, tuple_size);
 
     if (UNLIKELY(memory_ensure_free(ctx, tuple_size * 2) != MEMORY_GC_OK)) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
@@ -1006,6 +1215,38 @@ static term nif_erlang_binary_to_integer_1(Context *ctx, int argc, term argv[])
     return term_from_int32(value);
 }
 
+// argv: binary, count of bytes that have not been converted yet and list of already converted bytes
+static term binary_to_list_continue(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    do {
+        int remaining = term_to_int32(argv[1]);
+        if (UNLIKELY(memory_ensure_free(ctx, remaining * 2) != MEMORY_GC_OK)) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+
+        const uint8_t *bin_data = (const uint8_t *) term_binary_data(argv[0]);
+
+        // list is built starting from the last byte
+        int chunk_begin = remaining > NIF_CHUNK_SIZE ? remaining - NIF_CHUNK_SIZE : 0;
+        term prev = argv[2];
+        for (int i = remaining - 1; i >= chunk_begin; i--) {
+            prev = term_list_prepend(term_from_int11(bin_data[i]), prev, ctx);
+        }
+        context_consume_work(ctx, remaining - chunk_begin);
+
+        if (chunk_begin == 0) {
+            return prev;
+        }
+
+        argv[1] = term_from_int32(chunk_begin);
+        argv[2] = prev;
+    } while (!context_time_slice_expired(ctx));
+
+    return context_trap_nif(ctx, binary_to_list_continue, 3, argv);
+}
+
 static term nif_erlang_binary_to_list_1(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -1013,19 +1254,10 @@ static term nif_erlang_binary_to_list_1(Context *ctx, int argc, term argv[])
     term value = argv[0];
     VALIDATE_VALUE(value, term_is_binary);
 
-    int bin_size = term_binary_size(value);
-    if (UNLIKELY(memory_ensure_free(ctx, bin_size * 2) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
-
-    const char *bin_data = term_binary_data(argv[0]);
-
-    term prev = term_nil();
-    for (int i = bin_size - 1; i >= 0; i--) {
-        prev = term_list_prepend(term_from_int11(bin_data[i]), prev, ctx);
-    }
+    argv[1] = term_from_int32(term_binary_size(value));
+    argv[2] = term_nil();
 
-    return prev;
+    return binary_to_list_continue(ctx, 3, argv);
 }
 
 static term nif_erlang_binary_to_existing_atom_2(Context *ctx, int argc, term argv[])
@@ -1220,30 +1452,88 @@ static term nif_erlang_integer_to_list_1(Context *ctx, int argc, term argv[])
     return prev;
 }
 
-static term nif_erlang_list_to_binary_1(Context *ctx, int argc, term argv[])
+// argv: binary, first item that has not been copied yet and its offset
+static term list_to_binary_fill_continue(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
 
-    term t = argv[0];
-    VALIDATE_VALUE(t, term_is_list);
+    term t = argv[1];
+    int offset = term_to_int32(argv[2]);
+    char *bin_data = term_binary_data_mutable(argv[0]);
 
-    int len = term_list_length(t);
+    do {
+        int chunk_begin = offset;
+        int chunk_end = offset + NIF_CHUNK_SIZE;
+        while (!term_is_nil(t) && (offset < chunk_end)) {
+            bin_data[offset] = (char) term_to_int32(term_get_list_head(t));
+            offset++;
+            t = term_get_list_tail(t);
+        }
+        context_write_barrier(ctx, argv[0]);
+        context_consume_work(ctx, offset - chunk_begin);
 
-    if (UNLIKELY(memory_ensure_free(ctx, term_binary_data_size_in_terms(len) + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
-        RAISE_ERROR(BADARG_ATOM);
-    }
+        if (term_is_nil(t)) {
+            return argv[0];
+        }
+    } while (!context_time_slice_expired(ctx));
 
-    //TODO: avoid this copy: just write to binary memory
-    char *string = interop_list_to_string(argv[0]);
-    if (IS_NULL_PTR(string)) {
-        RAISE_ERROR(BADARG_ATOM);
-    }
+    argv[1] = t;
+    argv[2] = term_from_int32(offset);
+
+    return context_trap_nif(ctx, list_to_binary_fill_continue, 3, argv);
+}
+
+// argv: list, first item that has not been validated yet and count of items
+static term list_to_binary_count_continue(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term t = argv[1];
+    int len = term_to_int32(argv[2]);
+
+    do {
+        int count = walk_list_chunk(&t, 1);
+        if (UNLIKELY(count < 0)) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        len += count;
+        context_consume_work(ctx, count);
+
+        if (term_is_nil(t)) {
+            if (UNLIKELY(memory_ensure_free(ctx, term_binary_data_size_in_terms(len) + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
+                RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+            }
+
+            // GC might have changed all pointers
+            argv[1] = argv[0];
+            argv[0] = term_create_uninitialized_binary(len, ctx);
+            argv[2] = term_from_int32(0);
+
+            return list_to_binary_fill_continue(ctx, 3, argv);
 
-    term bin_term = term_from_literal_binary(string, len, ctx);
+        } else if (UNLIKELY(!term_is_nonempty_list(t))) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+    } while (!context_time_slice_expired(ctx));
 
-    free(string);
+    argv[1] = t;
+    argv[2] = term_from_int32(len);
 
-    return bin_term;
+    return context_trap_nif(ctx, list_to_binary_count_continue, 3, argv);
+}
+
+static term nif_erlang_list_to_binary_1(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term t = argv[0];
+    VALIDATE_VALUE(t, term_is_list);
+
+    // the list is validated and counted first, then it is copied to the binary
+    argv[1] = t;
+    argv[2] = term_from_int32(0);
+
+    return list_to_binary_count_continue(ctx, 3, argv);
 }
 
 static term nif_erlang_list_to_integer_1(Context *ctx, int argc, term argv[])
@@ -1437,6 +1727,7 @@ static term nifs_erlang_processes(Context *ctx, int argc, term argv[])
     UNUSED(argc);
 
     size_t num_processes = nifs_num_processes(ctx->global);
+    context_consume_work(ctx, num_processes);
     if (memory_ensure_free(ctx, 2 * num_processes) != MEMORY_GC_OK) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
     }
@@ -1460,7 +1751,8 @@ static term nifs_erlang_process_info(Context *ctx, int argc, term argv[])
     int local_process_id = term_to_local_process_id(pid);
     Context *target = globalcontext_get_process(ctx->global, local_process_id);
 
-    if (memory_ensure_free(ctx, 3) != MEMORY_GC_OK) {
+    // garbage_collection value is a list of 2 tuples
+    if (memory_ensure_free(ctx, 3 + 2 * (3 + 2)) != MEMORY_GC_OK) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
     }
 
@@ -1485,6 +1777,29 @@ static term nifs_erlang_process_info(Context *ctx, int argc, term argv[])
         term_put_tuple_element(ret, 0, MEMORY_ATOM);
         term_put_tuple_element(ret, 1, term_from_int32(context_size(target)));
 
+    // reductions number of reductions executed by the process, saturated since there is no support for big integers
+    } else if (item == REDUCTIONS_ATOM) {
+        uint64_t reductions = context_reductions(target);
+        if (reductions > MAX_REDUCTIONS_VALUE) {
+            reductions = MAX_REDUCTIONS_VALUE;
+        }
+        term_put_tuple_element(ret, 0, REDUCTIONS_ATOM);
+        term_put_tuple_element(ret, 1, term_from_int64(reductions));
+
+    // garbage_collection list of {minor_gcs, MinorGCs} and {fullsweep_after, FullsweepAfter}
+    } else if (item == GARBAGE_COLLECTION_ATOM) {
+        term minor_gcs = term_alloc_tuple(2, ctx);
+        term_put_tuple_element(minor_gcs, 0, MINOR_GCS_ATOM);
+        term_put_tuple_element(minor_gcs, 1, term_from_int32(target->minor_gcs));
+        term fullsweep_after = term_alloc_tuple(2, ctx);
+        term_put_tuple_element(fullsweep_after, 0, FULLSWEEP_AFTER_ATOM);
+        term_put_tuple_element(fullsweep_after, 1, term_from_int32(target->fullsweep_after));
+
+        term list = term_list_prepend(fullsweep_after, term_nil(), ctx);
+        list = term_list_prepend(minor_gcs, list, ctx);
+        term_put_tuple_element(ret, 0, GARBAGE_COLLECTION_ATOM);
+        term_put_tuple_element(ret, 1, list);
+
     } else {
         RAISE_ERROR(BADARG_ATOM);
     }
@@ -1513,6 +1828,23 @@ static term nifs_erlang_system_info(Context *ctx, int argc, term argv[])
     if (key == WORDSIZE_ATOM) {
         return term_from_int32(TERM_BYTES);
     }
+    if (key == REDUCTIONS_PER_SLICE_ATOM) {
+        return term_from_int32(ctx->global->reductions_per_slice);
+    }
+    if (key == HEAP_POOL_ATOM) {
+        term stats = heappool_stats_to_term(ctx->global->heap_pool, ctx);
+        if (UNLIKELY(term_is_invalid_term(stats))) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        return stats;
+    }
+    if (key == MESSAGE_POOL_ATOM) {
+        term stats = messagepool_stats_to_term(ctx->global->message_pool, ctx);
+        if (UNLIKELY(term_is_invalid_term(stats))) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        return stats;
+    }
     if (key == SYSTEM_ARCHITECTURE_ATOM) {
         char buf[128];
         snprintf(buf, 128, "%s-%s-%s", SYSTEM_NAME, SYSTEM_VERSION, SYSTEM_ARCHITECTURE);
@@ -1522,9 +1854,104 @@ static term nifs_erlang_system_info(Context *ctx, int argc, term argv[])
         }
         return term_from_literal_binary((const uint8_t *) buf, len, ctx);
     }
+#ifdef ENABLE_OPCODE_PROFILER
+    if (key == OPCODE_STATS_ATOM) {
+        term stats = opcodestats_to_term(ctx->global->opcode_stats, ctx);
+        if (UNLIKELY(term_is_invalid_term(stats))) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        return stats;
+    }
+#ifdef ENABLE_OPCODE_PROFILER_PAIRS
+    if (key == OPCODE_PAIR_STATS_ATOM) {
+        term stats = opcodestats_pairs_to_term(ctx->global->opcode_stats, ctx);
+        if (UNLIKELY(term_is_invalid_term(stats))) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        return stats;
+    }
+#endif
+#endif
+#ifdef ENABLE_FUNCTION_PROFILER
+    if (key == FUNCTION_PROFILE_ATOM) {
+        term profile = functionprofiler_to_term(ctx);
+        if (UNLIKELY(term_is_invalid_term(profile))) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        return profile;
+    }
+#endif
     return sys_get_info(ctx, key);
 }
 
+static term nifs_erlang_system_flag(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    term flag = argv[0];
+    term value = argv[1];
+
+    if (flag == REDUCTIONS_PER_SLICE_ATOM) {
+        VALIDATE_VALUE(value, term_is_integer);
+        int32_t reductions_per_slice = term_to_int32(value);
+        // a call that uses up the time slice is run again at the beginning of the next one,
+        // so at least 2 reductions are required for making any progress
+        if (UNLIKELY(reductions_per_slice < 2)) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        int old_reductions_per_slice = ctx->global->reductions_per_slice;
+        ctx->global->reductions_per_slice = reductions_per_slice;
+        return term_from_int32(old_reductions_per_slice);
+    }
+
+    if (flag == FULLSWEEP_AFTER_ATOM) {
+        if (UNLIKELY(!is_valid_fullsweep_after(value))) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        int old_fullsweep_after = ctx->global->fullsweep_after;
+        ctx->global->fullsweep_after = term_to_int32(value);
+        return term_from_int32(old_fullsweep_after);
+    }
+
+    if (flag == HEAP_GROWTH_ATOM) {
+        if (UNLIKELY(!is_valid_heap_growth(value))) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        enum HeapGrowthStrategy old_heap_growth = ctx->global->heap_growth;
+        ctx->global->heap_growth = heap_growth_from_atom(value);
+        return heap_growth_to_atom(old_heap_growth);
+    }
+
+    if (flag == COMPACTING_GC_THRESHOLD_ATOM) {
+        if (UNLIKELY(!is_valid_compacting_gc_threshold(value))) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        unsigned long old_compacting_gc_threshold = ctx->global->compacting_gc_threshold;
+        ctx->global->compacting_gc_threshold = term_to_int32(value);
+        return term_from_int64(old_compacting_gc_threshold);
+    }
+
+    if (flag == MAX_GC_PAUSE_ATOM) {
+        if (UNLIKELY(!is_valid_max_gc_pause(value))) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        int old_max_gc_pause = ctx->global->max_gc_pause;
+        ctx->global->max_gc_pause = term_to_int32(value);
+        return term_from_int32(old_max_gc_pause);
+    }
+
+#ifdef ENABLE_FUNCTION_PROFILER
+    if (flag == FUNCTION_PROFILER_ATOM) {
+        if ((value != TRUE_ATOM) && (value != FALSE_ATOM)) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        int was_enabled = functionprofiler_set_enabled(ctx->global, value == TRUE_ATOM);
+        return was_enabled ? TRUE_ATOM : FALSE_ATOM;
+    }
+#endif
+
+    RAISE_ERROR(BADARG_ATOM);
+}
+
 static term nif_binary_at_2(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -1611,39 +2038,54 @@ static term nif_binary_part_3(Context *ctx, int argc, term argv[])
     return term_from_literal_binary(bin_data + pos, len, ctx);
 }
 
-static term nif_binary_split_2(Context *ctx, int argc, term argv[])
+// argv: binary, pattern and offset of the first byte that has not been searched yet
+static term binary_split_continue(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
 
     term bin_term = argv[0];
     term pattern_term = argv[1];
-
-    VALIDATE_VALUE(bin_term, term_is_binary);
-    VALIDATE_VALUE(pattern_term, term_is_binary);
+    int offset = term_to_int32(argv[2]);
 
     int bin_size = term_binary_size(bin_term);
     int pattern_size = term_binary_size(pattern_term);
 
-    if (UNLIKELY(pattern_size == 0)) {
-        RAISE_ERROR(BADARG_ATOM);
-    }
-
     const char *bin_data = term_binary_data(bin_term);
     const char *pattern_data = term_binary_data(pattern_term);
 
-    const char *found = (const char *) memmem(bin_data, bin_size, pattern_data, pattern_size);
+    const char *found = NULL;
+    do {
+        // chunks overlap by pattern_size - 1 bytes, so a match across two chunks is not missed
+        int chunk_size = bin_size - offset;
+        if (chunk_size > NIF_CHUNK_SIZE + pattern_size - 1) {
+            chunk_size = NIF_CHUNK_SIZE + pattern_size - 1;
+        }
+        found = (const char *) memmem(bin_data + offset, chunk_size, pattern_data, pattern_size);
+        context_consume_work(ctx, chunk_size < NIF_CHUNK_SIZE ? chunk_size : NIF_CHUNK_SIZE);
+
+        if (found || (offset + chunk_size >= bin_size)) {
+            break;
+        }
+        offset += NIF_CHUNK_SIZE;
 
-    int offset = found - bin_data;
+        if (context_time_slice_expired(ctx)) {
+            argv[2] = term_from_int32(offset);
+            return context_trap_nif(ctx, binary_split_continue, 3, argv);
+        }
+    } while (1);
 
     if (found) {
-        int tok_size = offset;
+        int tok_size = found - bin_data;
         // + 2, which is the binary header size
         int tok_size_in_terms = term_binary_data_size_in_terms(tok_size) + BINARY_HEADER_SIZE;
 
-        int rest_size = bin_size - offset - pattern_size;
+        int rest_size = bin_size - tok_size - pattern_size;
         // + 2, which is the binary header size
         int rest_size_in_terms = term_binary_data_size_in_terms(rest_size) + BINARY_HEADER_SIZE;
 
+        // the binary is copied
+        context_consume_work(ctx, tok_size + rest_size);
+
         // + 2 which is the result cons
         if (UNLIKELY(memory_ensure_free(ctx, tok_size_in_terms + rest_size_in_terms + 2) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
@@ -1652,7 +2094,7 @@ static term nif_binary_split_2(Context *ctx, int argc, term argv[])
         const char *bin_data = term_binary_data(argv[0]);
 
         term tok = term_from_literal_binary(bin_data, tok_size, ctx);
-        term rest = term_from_literal_binary(bin_data + offset + pattern_size, rest_size, ctx);
+        term rest = term_from_literal_binary(bin_data + tok_size + pattern_size, rest_size, ctx);
 
         term result_list = term_list_prepend(rest, term_nil(), ctx);
         result_list = term_list_prepend(tok, result_list, ctx);
@@ -1668,14 +2110,74 @@ static term nif_binary_split_2(Context *ctx, int argc, term argv[])
     }
 }
 
+static term nif_binary_split_2(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term bin_term = argv[0];
+    term pattern_term = argv[1];
+
+    VALIDATE_VALUE(bin_term, term_is_binary);
+    VALIDATE_VALUE(pattern_term, term_is_binary);
+
+    if (UNLIKELY(term_binary_size(pattern_term) == 0)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
+    // the binary is searched in chunks, starting from its beginning
+    argv[2] = term_from_int32(0);
+
+    return binary_split_continue(ctx, 3, argv);
+}
+
 static term nif_erts_debug_flat_size(Context *ctx, int argc, term argv[])
 {
-    UNUSED(ctx);
     UNUSED(argc);
 
     unsigned long terms_count;
 
-    terms_count = memory_estimate_usage(argv[0]);
+    terms_count = memory_flat_size(argv[0]);
+    context_consume_work(ctx, terms_count);
+
+    return term_from_int32(terms_count);
+}
+
+static term nif_erts_debug_size(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    unsigned long terms_count;
+
+    terms_count = memory_shared_size(argv[0]);
+    context_consume_work(ctx, terms_count);
 
     return term_from_int32(terms_count);
 }
+
+static term nif_persistent_term_get(Context *ctx, int argc, term argv[])
+{
+    term value = globalcontext_get_persistent_term(ctx->global, argv[0]);
+    if (term_is_invalid_term(value)) {
+        if (argc == 2) {
+            return argv[1];
+        }
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
+    // value is stored in a literal area, so it is not copied to the process heap
+    return value;
+}
+
+static term nif_persistent_term_put_2(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    unsigned long terms_count = memory_estimate_usage(argv[0]) + memory_estimate_usage(argv[1]);
+    context_consume_work(ctx, terms_count);
+
+    if (UNLIKELY(!globalcontext_put_persistent_term(ctx->global, argv[0], argv[1]))) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return OK_ATOM;
+}
@@ -99,4 +99,18 @@
 #define OP_GET_HD 162
 #define OP_GET_TL 163
 
+// Internal opcodes: these opcodes are never found in BEAM files, the code loader
+// emits them when it fuses a pair of instructions (opcodes from 240 to 244, see
+// superinstructions.h) or when it lowers select_val and select_tuple_arity to a search table.
+// int_trap_resume is emitted once per module, right after int_call_end, and it is used
+// as resume point by processes that have been scheduled out by a trapping NIF.
+// int_native replaces the first instruction of runs that have been translated to native code (see jit.h).
+#include "superinstructions.h"
+#define OP_SELECT_VAL_BINARY_SEARCH 245
+#define OP_SELECT_VAL_JUMP_TABLE 246
+#define OP_SELECT_TUPLE_ARITY_BINARY_SEARCH 247
+#define OP_SELECT_TUPLE_ARITY_JUMP_TABLE 248
+#define OP_INT_TRAP_RESUME 249
+#define OP_INT_NATIVE 250
+
 #endif
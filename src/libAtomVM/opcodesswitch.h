@@ -34,8 +34,20 @@
     #include "mailbox.h"
 #endif
 
+#if defined(IMPL_EXECUTE_LOOP) && defined(ENABLE_FUNCTION_PROFILER)
+    #include "functionprofiler.h"
+#endif
+
+#ifdef ENABLE_JIT
+    #include "jit.h"
+#endif
+
 #define ENABLE_OTP21
 
+#if defined(IMPL_EXECUTE_LOOP) && defined(__GNUC__) && !defined(DISABLE_COMPUTED_GOTO)
+    #define USE_COMPUTED_GOTO
+#endif
+
 //#define ENABLE_TRACE
 
 #include "trace.h"
@@ -54,90 +66,48 @@
 #define COMPACT_11BITS_VALUE 0x8
 #define COMPACT_NBITS_VALUE 0x18
 
+/*
+ * The code loader translates the compact BEAM encoding into a stream of fixed width words
+ * (see Module instructions): every instruction is made of an opcode word followed by one word
+ * for each operand, so the execute loop never has to decode the compact encoding.
+ * Operand words are encoded as follows:
+ * - labels, integers and dest registers keep their decoded value (dest registers are stored
+ *   as (index << 4) | type, like their compact encoding);
+ * - atoms are translated to global atom terms;
+ * - source operands are either an immediate term (integer, atom or nil) or a reference, that
+ *   can be told apart using the lower 4 bits: (index << 4) | COMPACT_XREG, (index << 4) | COMPACT_YREG,
+ *   (index << 4) | COMPACT_EXTENDED for literals and (offset << 4) | COMPACT_LARGE_INTEGER for
+ *   integers that do not fit an immediate term, such as 5 to 8 bytes integers on 32 bits builds:
+ *   they are decoded from the Code chunk offset when the instruction is executed.
+ * Extended list tags, put opcodes, label and line instructions are not emitted.
+ */
+
 #ifdef IMPL_CODE_LOADER
-#define DECODE_COMPACT_TERM(dest_term, code_chunk, base_index, off, next_operand_offset)\
-{                                                                                       \
-    uint8_t first_byte = (code_chunk[(base_index) + (off)]);                            \
-    switch (first_byte & 0xF) {                                                         \
-        case COMPACT_SMALLINT4:                                                         \
-        case COMPACT_ATOM:                                                              \
-        case COMPACT_XREG:                                                              \
-        case COMPACT_YREG:                                                              \
-            next_operand_offset += 1;                                                   \
-            break;                                                                      \
-                                                                                        \
-        case COMPACT_EXTENDED:                                                          \
-            switch (first_byte) {                                                       \
-                case COMPACT_EXTENDED_LITERAL: {                                        \
-                    uint8_t ext = (code_chunk[(base_index) + (off) + 1] & 0xF);         \
-                    if (ext == 0) {                                                     \
-                        next_operand_offset += 2;                                       \
-                    }else if (ext == 0x8) {                                             \
-                        next_operand_offset += 3;                                       \
-                    } else {                                                            \
-                        abort();                                                        \
-                    }                                                                   \
-                    break;                                                              \
-                }                                                                       \
-                default:                                                                \
-                    printf("Unexpected %i\n", (int) first_byte);                        \
-                    abort();                                                            \
-                    break;                                                              \
-            }                                                                           \
-            break;                                                                      \
-                                                                                        \
-        case COMPACT_LARGE_INTEGER:                                                     \
-        case COMPACT_LARGE_ATOM:                                                        \
-            switch (first_byte & COMPACT_LARGE_IMM_MASK) {                              \
-                case COMPACT_11BITS_VALUE:                                              \
-                    next_operand_offset += 2;                                           \
-                    break;                                                              \
-                                                                                        \
-                case COMPACT_NBITS_VALUE:                                               \
-                    /* TODO: when first_byte >> 5 is 7, a different encoding is used */ \
-                    next_operand_offset += (first_byte >> 5) + 3;                       \
-                    break;                                                              \
-                                                                                        \
-                default:                                                                \
-                    assert((first_byte & 0x30) != COMPACT_LARGE_INTEGER);               \
-                    break;                                                              \
-            }                                                                           \
-            break;                                                                      \
-                                                                                        \
-        default:                                                                        \
-            fprintf(stderr, "unknown compect term type: %i\n", ((first_byte) & 0xF));   \
-            abort();                                                                    \
-            break;                                                                      \
-    }                                                                                   \
-}
-#endif
 
-#ifdef IMPL_EXECUTE_LOOP
+#define EMIT_WORD(word) \
+    instructions[ii++] = (term) (word)
+
 #define DECODE_COMPACT_TERM(dest_term, code_chunk, base_index, off, next_operand_offset)                                \
 {                                                                                                                       \
     uint8_t first_byte = (code_chunk[(base_index) + (off)]);                                                            \
     switch (first_byte & 0xF) {                                                                                         \
         case COMPACT_SMALLINT4:                                                                                         \
-            dest_term = term_from_int4(first_byte >> 4);                                                                \
+            EMIT_WORD(term_from_int4(first_byte >> 4));                                                                 \
             next_operand_offset += 1;                                                                                   \
             break;                                                                                                      \
                                                                                                                         \
         case COMPACT_ATOM:                                                                                              \
             if (first_byte == COMPACT_ATOM) {                                                                           \
-                dest_term = term_nil();                                                                                 \
+                EMIT_WORD(term_nil());                                                                                  \
             } else {                                                                                                    \
-                dest_term = module_get_atom_term_by_id(mod, first_byte >> 4);                                           \
+                EMIT_WORD(module_get_atom_term_by_id(mod, first_byte >> 4));                                            \
             }                                                                                                           \
             next_operand_offset += 1;                                                                                   \
             break;                                                                                                      \
                                                                                                                         \
         case COMPACT_XREG:                                                                                              \
-            dest_term = ctx->x[first_byte >> 4];                                                                        \
-            next_operand_offset += 1;                                                                                   \
-            break;                                                                                                      \
-                                                                                                                        \
         case COMPACT_YREG:                                                                                              \
-            dest_term = ctx->e[first_byte >> 4];                                                                        \
+            EMIT_WORD(first_byte);                                                                                      \
             next_operand_offset += 1;                                                                                   \
             break;                                                                                                      \
                                                                                                                         \
@@ -145,21 +115,22 @@
             switch (first_byte) {                                                                                       \
                 case COMPACT_EXTENDED_LITERAL: {                                                                        \
                     uint8_t first_extended_byte = code_chunk[(base_index) + (off) + 1];                                 \
+                    uint16_t index;                                                                                     \
                     if (!(first_extended_byte & 0xF)) {                                                                 \
-                        dest_term = module_load_literal(mod, first_extended_byte >> 4, ctx);                            \
+                        index = first_extended_byte >> 4;                                                               \
                         next_operand_offset += 2;                                                                       \
                     } else if ((first_extended_byte & 0xF) == 0x8) {                                                    \
                         uint8_t byte_1 = code_chunk[(base_index) + (off) + 2];                                          \
-                        uint16_t index = (((uint16_t) first_extended_byte & 0xE0) << 3) | byte_1;                       \
-                        dest_term = module_load_literal(mod, index, ctx);                                               \
+                        index = (((uint16_t) first_extended_byte & 0xE0) << 3) | byte_1;                                \
                         next_operand_offset += 3;                                                                       \
                     } else {                                                                                            \
                         abort();                                                                                        \
                     }                                                                                                   \
-                                                                                                                        \
+                    EMIT_WORD((index << 4) | COMPACT_EXTENDED);                                                         \
                     break;                                                                                              \
                 }                                                                                                       \
                 default:                                                                                                \
+                    printf("Unexpected %i\n", (int) first_byte);                                                        \
                     abort();                                                                                            \
                     break;                                                                                              \
             }                                                                                                           \
@@ -168,10 +139,15 @@
         case COMPACT_LARGE_ATOM:                                                                                        \
             switch (first_byte & COMPACT_LARGE_IMM_MASK) {                                                              \
                 case COMPACT_11BITS_VALUE:                                                                              \
-                    dest_term = module_get_atom_term_by_id(mod, ((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1]); \
+                    EMIT_WORD(module_get_atom_term_by_id(mod, ((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1])); \
                     next_operand_offset += 2;                                                                           \
                     break;                                                                                              \
                                                                                                                         \
+                case COMPACT_NBITS_VALUE:                                                                               \
+                    EMIT_WORD(module_get_atom_term_by_id(mod,                                                           \
+                            large_integer_to_int64((code_chunk) + (base_index) + (off), &(next_operand_offset))));      \
+                    break;                                                                                              \
+                                                                                                                        \
                 default:                                                                                                \
                     abort();                                                                                            \
                     break;                                                                                              \
@@ -181,15 +157,21 @@
         case COMPACT_LARGE_INTEGER:                                                                                     \
             switch (first_byte & COMPACT_LARGE_IMM_MASK) {                                                              \
                 case COMPACT_11BITS_VALUE:                                                                              \
-                    dest_term = term_from_int11(((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1]);     \
+                    EMIT_WORD(term_from_int11(((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1]));      \
                     next_operand_offset += 2;                                                                           \
                     break;                                                                                              \
                                                                                                                         \
-                case COMPACT_NBITS_VALUE:                                                                               \
-                    dest_term = term_from_int64(                                                                        \
-                            large_integer_to_int64((code_chunk) + (base_index) + (off), &(next_operand_offset))         \
-                        );                                                                                              \
+                case COMPACT_NBITS_VALUE: {                                                                             \
+                    int large_integer_offset = (base_index) + (off);                                                    \
+                    int64_t large_integer =                                                                             \
+                        large_integer_to_int64((code_chunk) + large_integer_offset, &(next_operand_offset));            \
+                    if (int64_is_immediate(large_integer)) {                                                            \
+                        EMIT_WORD(term_from_int64(large_integer));                                                      \
+                    } else {                                                                                            \
+                        EMIT_WORD(((term) large_integer_offset << 4) | COMPACT_LARGE_INTEGER);                          \
+                    }                                                                                                   \
                     break;                                                                                              \
+                }                                                                                                       \
                                                                                                                         \
                 default:                                                                                                \
                     abort();                                                                                            \
@@ -198,11 +180,11 @@
             break;                                                                                                      \
                                                                                                                         \
         default:                                                                                                        \
+            fprintf(stderr, "unknown compect term type: %i\n", ((first_byte) & 0xF));                                   \
             abort();                                                                                                    \
+            break;                                                                                                      \
     }                                                                                                                   \
 }
-#endif
-
 
 #define DECODE_LABEL(label, code_chunk, base_index, off, next_operand_offset)                       \
 {                                                                                                   \
@@ -224,6 +206,7 @@
             abort();                                                                                \
             break;                                                                                  \
     }                                                                                               \
+    EMIT_WORD(label);                                                                               \
 }
 
 #define DECODE_ATOM(atom, code_chunk, base_index, off, next_operand_offset)                         \
@@ -246,6 +229,7 @@
             abort();                                                                                \
             break;                                                                                  \
     }                                                                                               \
+    EMIT_WORD(module_get_atom_term_by_id(mod, atom));                                               \
 }
 
 #define DECODE_INTEGER(label, code_chunk, base_index, off, next_operand_offset)                     \
@@ -268,6 +252,85 @@
             abort();                                                                                \
             break;                                                                                  \
     }                                                                                               \
+    EMIT_WORD(label);                                                                               \
+}
+
+#define DECODE_DEST_REGISTER(dreg, dreg_type, code_chunk, base_index, off, next_operand_offset)     \
+{                                                                                                   \
+    dreg_type = code_chunk[(base_index) + (off)] & 0xF;                                             \
+    dreg = code_chunk[(base_index) + (off)] >> 4;                                                   \
+    EMIT_WORD(code_chunk[(base_index) + (off)]);                                                    \
+    next_operand_offset++;                                                                          \
+}
+
+#define DECODE_EXTENDED_LIST_TAG(code_chunk, base_index, off, next_operand_offset)                  \
+{                                                                                                   \
+    next_operand_offset++;                                                                          \
+}
+
+// apply and apply_last pack their call site cache index together with the arity, so that the
+// pre-decoded instruction doesn't take more words than the source bytes it has been decoded from
+#define DECODE_CALL_SITE_ARITY(arity, call_site, code_chunk, base_index, off, next_operand_offset)  \
+{                                                                                                   \
+    DECODE_INTEGER(arity, code_chunk, base_index, off, next_operand_offset)                         \
+    if (UNLIKELY(arity > 0xFF)) {                                                                   \
+        fprintf(stderr, "Unsupported apply arity: %i\n", arity);                                    \
+        abort();                                                                                    \
+    }                                                                                               \
+    call_site = mod->call_site_caches_count++;                                                      \
+    instructions[ii - 1] = ((term) (call_site) << 8) | (arity);                                     \
+}
+
+#endif
+
+#ifdef IMPL_EXECUTE_LOOP
+
+#define DECODE_COMPACT_TERM(dest_term, code_chunk, base_index, off, next_operand_offset)            \
+{                                                                                                   \
+    term operand_word = code_chunk[(base_index) + (off)];                                           \
+    switch (operand_word & 0xF) {                                                                   \
+        case COMPACT_XREG:                                                                          \
+            dest_term = ctx->x[operand_word >> 4];                                                  \
+            break;                                                                                  \
+                                                                                                    \
+        case COMPACT_YREG:                                                                          \
+            dest_term = ctx->e[operand_word >> 4];                                                  \
+            break;                                                                                  \
+                                                                                                    \
+        case COMPACT_EXTENDED:                                                                      \
+            dest_term = module_get_literal(mod, operand_word >> 4);                                 \
+            break;                                                                                  \
+                                                                                                    \
+        case COMPACT_LARGE_INTEGER: {                                                               \
+            int large_integer_size = 0;                                                             \
+            uint8_t *large_integer = mod->code->code + (operand_word >> 4);                         \
+            dest_term = term_from_int64(large_integer_to_int64(large_integer, &large_integer_size)); \
+            break;                                                                                  \
+        }                                                                                           \
+                                                                                                    \
+        default:                                                                                    \
+            dest_term = operand_word;                                                               \
+            break;                                                                                  \
+    }                                                                                               \
+    next_operand_offset += 1;                                                                       \
+}
+
+#define DECODE_LABEL(label, code_chunk, base_index, off, next_operand_offset)                       \
+{                                                                                                   \
+    label = code_chunk[(base_index) + (off)];                                                       \
+    next_operand_offset += 1;                                                                       \
+}
+
+#define DECODE_ATOM(atom, code_chunk, base_index, off, next_operand_offset)                         \
+{                                                                                                   \
+    atom = code_chunk[(base_index) + (off)];                                                        \
+    next_operand_offset += 1;                                                                       \
+}
+
+#define DECODE_INTEGER(label, code_chunk, base_index, off, next_operand_offset)                     \
+{                                                                                                   \
+    label = code_chunk[(base_index) + (off)];                                                       \
+    next_operand_offset += 1;                                                                       \
 }
 
 #define DECODE_DEST_REGISTER(dreg, dreg_type, code_chunk, base_index, off, next_operand_offset)     \
@@ -277,6 +340,17 @@
     next_operand_offset++;                                                                          \
 }
 
+#define DECODE_EXTENDED_LIST_TAG(code_chunk, base_index, off, next_operand_offset)
+
+#define DECODE_CALL_SITE_ARITY(arity, call_site, code_chunk, base_index, off, next_operand_offset)  \
+{                                                                                                   \
+    arity = code_chunk[(base_index) + (off)] & 0xFF;                                                \
+    call_site = code_chunk[(base_index) + (off)] >> 8;                                              \
+    next_operand_offset += 1;                                                                       \
+}
+
+#endif
+
 #define READ_REGISTER(sreg_type, sreg, value)                                                       \
 {                                                                                                   \
     switch (sreg_type) {                                                                            \
@@ -309,12 +383,76 @@
 #define NEXT_INSTRUCTION(operands_size) \
     i += operands_size
 
+#ifdef USE_COMPUTED_GOTO
+    #define OPCODE_CASE(opcode) \
+        case opcode: opcode##_HANDLER
+
+    #define DISPATCH_INSTRUCTION() \
+        goto *dispatch_table[code[i]];
+#else
+    #define OPCODE_CASE(opcode) \
+        case opcode
+
+    #define DISPATCH_INSTRUCTION()
+#endif
+
+// ends each handler: each of them gets its own indirect jump to the next one, so the branch predictor can learn
+// which handlers follow which, while the switch build just goes back to the top of the loop
+#ifdef USE_COMPUTED_GOTO
+    #define DISPATCH_NEXT_INSTRUCTION() \
+        PROFILE_INSTRUCTION();          \
+        DISPATCH_INSTRUCTION()
+#else
+    #define DISPATCH_NEXT_INSTRUCTION() \
+        break
+#endif
+
+#if defined(IMPL_EXECUTE_LOOP) && defined(ENABLE_OPCODE_PROFILER)
+    #define PROFILE_INSTRUCTION() \
+        opcodestats_sample(mod->global->opcode_stats, code[i]);
+#else
+    #define PROFILE_INSTRUCTION()
+#endif
+
+#if defined(IMPL_EXECUTE_LOOP) && defined(ENABLE_FUNCTION_PROFILER)
+    #define PROFILE_CALL(target_mod, target_address) \
+        if (UNLIKELY(ctx->global->function_profiler_enabled)) { \
+            functionprofiler_call(ctx, target_mod, target_address); \
+        }
+
+    #define PROFILE_TAIL_CALL(target_mod, target_address) \
+        if (UNLIKELY(ctx->global->function_profiler_enabled)) { \
+            functionprofiler_tail_call(ctx, target_mod, target_address); \
+        }
+
+    #define PROFILE_RETURN() \
+        if (UNLIKELY(ctx->global->function_profiler_enabled)) { \
+            functionprofiler_return(ctx); \
+        }
+
+    #define PROFILE_NATIVE_BEGIN() \
+        if (UNLIKELY(ctx->global->function_profiler_enabled)) { \
+            functionprofiler_native_begin(ctx); \
+        }
+
+    #define PROFILE_NATIVE_END(import_index) \
+        if (UNLIKELY(ctx->global->function_profiler_enabled)) { \
+            functionprofiler_native_end(ctx, mod, import_index); \
+        }
+#else
+    #define PROFILE_CALL(target_mod, target_address)
+    #define PROFILE_TAIL_CALL(target_mod, target_address)
+    #define PROFILE_RETURN()
+    #define PROFILE_NATIVE_BEGIN()
+    #define PROFILE_NATIVE_END(import_index)
+#endif
+
 #ifndef TRACE_JUMP
     #define JUMP_TO_ADDRESS(address) \
-        i = ((uint8_t *) (address)) - code
+        i = ((const term *) (address)) - code
 #else
     #define JUMP_TO_ADDRESS(address) \
-        i = ((uint8_t *) (address)) - code; \
+        i = ((const term *) (address)) - code; \
         fprintf(stderr, "going to jump to %i\n", i)
 #endif
 
@@ -326,8 +464,7 @@
         Context *scheduled_context = scheduler_next(ctx->global, ctx);                            \
         ctx = scheduled_context;                                                                  \
         mod = ctx->saved_module;                                                                  \
-        code = mod->code->code;                                                                   \
-        remaining_reductions = DEFAULT_REDUCTIONS_AMOUNT;                                         \
+        code = mod->instructions;                                                                   \
         JUMP_TO_ADDRESS(scheduled_context->saved_ip);                                             \
     }
 
@@ -336,11 +473,11 @@
 
 #define DO_RETURN() \
     mod = mod->global->modules_by_index[ctx->cp >> 24]; \
-    code = mod->code->code; \
+    code = mod->instructions; \
     i = (ctx->cp & 0xFFFFFF) >> 2;
 
 #define POINTER_TO_II(instruction_pointer) \
-    (((uint8_t *) (instruction_pointer)) - code)
+    (((const term *) (instruction_pointer)) - code)
 
 #define RAISE_EXCEPTION() \
     int target_label = get_catch_label_and_change_module(ctx, &mod); \
@@ -352,40 +489,20 @@
         abort(); \
     }
 
-#ifdef IMPL_EXECUTE_LOOP
+/*
+ * A NIF that returns an invalid term after calling context_trap_nif didn't fail: the process is
+ * scheduled out and it is resumed by int_trap_resume, that calls the NIF continuation and then
+ * continues execution at resume_cp.
+ */
+#define TRAP_NIF(resume_cp) \
+    ctx->trap_cp = (resume_cp); \
+    SCHEDULE_NEXT(mod, &code[mod->end_instruction_ii + 1]);
+
 struct Int24
 {
     int32_t val24 : 24;
 };
 
-static int get_catch_label_and_change_module(Context *ctx, Module **mod)
-{
-    term *ct = ctx->e;
-    term *last_frame = ctx->e;
-
-    while (ct != ctx->stack_base) {
-        if (term_is_catch_label(*ct)) {
-            int target_module;
-            int target_label = term_to_catch_label_and_module(*ct, &target_module);
-            TRACE("- found catch: label: %i, module: %i\n", target_label, target_module);
-            *mod = ctx->global->modules_by_index[target_module];
-
-            DEBUG_DUMP_STACK(ctx);
-            ctx->e = last_frame;
-            DEBUG_DUMP_STACK(ctx);
-
-            return target_label;
-
-        } else if (term_is_cp(*ct)) {
-            last_frame = ct + 1;
-        }
-
-        ct++;
-    }
-
-    return 0;
-}
-
 static int64_t large_integer_to_int64(uint8_t *compact_term, int *next_operand_offset)
 {
     int num_bytes = (*compact_term >> 5) + 2;
@@ -412,11 +529,222 @@ static int64_t large_integer_to_int64(uint8_t *compact_term, int *next_operand_o
             return ret_val32;
         }
 
+        case 5:
+        case 6:
+        case 7:
+        case 8: {
+            *next_operand_offset += num_bytes + 1;
+            uint64_t ret_val64 = (compact_term[1] & 0x80) ? UINT64_MAX : 0;
+            for (int j = 1; j <= num_bytes; j++) {
+                ret_val64 = (ret_val64 << 8) | compact_term[j];
+            }
+            return (int64_t) ret_val64;
+        }
+
         default:
             abort();
     }
 }
 
+#ifdef IMPL_CODE_LOADER
+// integers that cannot be built at load time, they are decoded again each time they are used
+static inline int int64_is_immediate(int64_t value)
+{
+#if TERM_BITS == 32
+    return (value <= 268435455) && (value >= -268435455);
+#else
+    return (value <= 1152921504606846975) && (value >= -1152921504606846975);
+#endif
+}
+
+struct Superinstruction
+{
+    uint8_t first_opcode;
+    uint8_t second_opcode;
+    uint8_t fused_opcode;
+};
+
+/*
+ * Pairs of instructions that are replaced by a single fused instruction, the fused instruction
+ * operands are the first instruction operands followed by the second instruction operands.
+ * Pairs come from superinstructions.h, tools/dev/gen-superinstructions.sh can replace them with
+ * the most frequent ones reported by the opcode profiler.
+ */
+static const struct Superinstruction superinstructions[] = {
+    SUPERINSTRUCTIONS
+};
+
+static int superinstruction_lookup(int first_opcode, int second_opcode)
+{
+#ifdef ENABLE_OPCODE_PROFILER_PAIRS
+    // pairs are counted as they are found in BEAM files, so that they can be used to generate the table
+    UNUSED(first_opcode);
+    UNUSED(second_opcode);
+    return 0;
+#endif
+
+    for (unsigned int i = 0; i < sizeof(superinstructions) / sizeof(struct Superinstruction); i++) {
+        if ((superinstructions[i].first_opcode == first_opcode) && (superinstructions[i].second_opcode == second_opcode)) {
+            return superinstructions[i].fused_opcode;
+        }
+    }
+
+    return 0;
+}
+
+// select_val and select_tuple_arity having more pairs than this are lowered to a search table
+#define SELECT_LINEAR_SEARCH_MAX_PAIRS 4
+
+static int select_value_less_than(term a, term b, int compare_integers)
+{
+    if (compare_integers) {
+        return term_to_int32(a) < term_to_int32(b);
+    } else {
+        return a < b;
+    }
+}
+
+static void select_sort_pairs(term *pairs, int pairs_count, int compare_integers)
+{
+    // insertion sort: tables are usually small and they are sorted just once at load time
+    for (int j = 1; j < pairs_count; j++) {
+        term value = pairs[j * 2];
+        term label = pairs[j * 2 + 1];
+        int k = j - 1;
+        while ((k >= 0) && select_value_less_than(value, pairs[k * 2], compare_integers)) {
+            pairs[(k + 1) * 2] = pairs[k * 2];
+            pairs[(k + 1) * 2 + 1] = pairs[k * 2 + 1];
+            k--;
+        }
+        pairs[(k + 1) * 2] = value;
+        pairs[(k + 1) * 2 + 1] = label;
+    }
+}
+
+static int select_pairs_are_contiguous(const term *pairs, int pairs_count, int compare_integers)
+{
+    for (int j = 1; j < pairs_count; j++) {
+        if (compare_integers) {
+            if ((int64_t) term_to_int32(pairs[j * 2]) != (int64_t) term_to_int32(pairs[0]) + j) {
+                return 0;
+            }
+        } else if (pairs[j * 2] != pairs[0] + j) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int select_val_lower(term *pairs, int pairs_count)
+{
+    if (pairs_count <= SELECT_LINEAR_SEARCH_MAX_PAIRS) {
+        return OP_SELECT_VAL;
+    }
+
+    int all_integers = 1;
+    for (int j = 0; j < pairs_count; j++) {
+        term value = pairs[j * 2];
+        switch (value & 0xF) {
+            case COMPACT_XREG:
+            case COMPACT_YREG:
+            case COMPACT_EXTENDED:
+            case COMPACT_LARGE_INTEGER:
+                // registers, literals and large integers cannot be compared using their operand word
+                return OP_SELECT_VAL;
+
+            default:
+                if (!term_is_integer(value) || (term_from_int32(term_to_int32(value)) != value)) {
+                    all_integers = 0;
+                }
+        }
+    }
+
+    if (all_integers) {
+        select_sort_pairs(pairs, pairs_count, 1);
+        if (select_pairs_are_contiguous(pairs, pairs_count, 1)) {
+            return OP_SELECT_VAL_JUMP_TABLE;
+        }
+    }
+
+    // binary search just needs a total order, so raw terms are compared
+    select_sort_pairs(pairs, pairs_count, 0);
+    return OP_SELECT_VAL_BINARY_SEARCH;
+}
+
+static int select_tuple_arity_lower(term *pairs, int pairs_count)
+{
+    if (pairs_count <= SELECT_LINEAR_SEARCH_MAX_PAIRS) {
+        return OP_SELECT_TUPLE_ARITY;
+    }
+
+    select_sort_pairs(pairs, pairs_count, 0);
+    if (select_pairs_are_contiguous(pairs, pairs_count, 0)) {
+        return OP_SELECT_TUPLE_ARITY_JUMP_TABLE;
+    } else {
+        return OP_SELECT_TUPLE_ARITY_BINARY_SEARCH;
+    }
+}
+
+#endif
+
+#ifdef IMPL_EXECUTE_LOOP
+static int select_binary_search(const term *pairs, int pairs_count, term value, int default_label)
+{
+    int low = 0;
+    int high = pairs_count - 1;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        term middle_value = pairs[middle * 2];
+        if (middle_value == value) {
+            return pairs[middle * 2 + 1];
+        } else if (middle_value < value) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return default_label;
+}
+#endif
+
+#ifdef IMPL_EXECUTE_LOOP
+static int get_catch_label_and_change_module(Context *ctx, Module **mod)
+{
+    term *ct = ctx->e;
+    term *last_frame = ctx->e;
+
+    while (ct != ctx->stack_base) {
+        if (term_is_catch_label(*ct)) {
+            int target_module;
+            int target_label = term_to_catch_label_and_module(*ct, &target_module);
+            TRACE("- found catch: label: %i, module: %i\n", target_label, target_module);
+            *mod = ctx->global->modules_by_index[target_module];
+
+            DEBUG_DUMP_STACK(ctx);
+            ctx->e = last_frame;
+            DEBUG_DUMP_STACK(ctx);
+
+#ifdef ENABLE_FUNCTION_PROFILER
+            if (UNLIKELY(ctx->global->function_profiler_enabled)) {
+                functionprofiler_exception(ctx, *mod, (*mod)->labels[target_label]);
+            }
+#endif
+
+            return target_label;
+
+        } else if (term_is_cp(*ct)) {
+            last_frame = ct + 1;
+        }
+
+        ct++;
+    }
+
+    return 0;
+}
+
 term make_fun(Context *ctx, const Module *mod, int fun_index)
 {
     uint32_t n_freeze = module_get_fun_freeze(mod, fun_index);
@@ -556,6 +884,14 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
 #pragma GCC diagnostic ignored "-Wunused-but-set-variable"
 #endif
 #endif
+#ifdef USE_COMPUTED_GOTO
+#pragma GCC diagnostic ignored "-Wpedantic"
+#ifdef __clang__
+#pragma GCC diagnostic ignored "-Winitializer-overrides"
+#else
+#pragma GCC diagnostic ignored "-Woverride-init"
+#endif
+#endif
 
 #ifdef IMPL_CODE_LOADER
     int read_core_chunk(Module *mod)
@@ -567,7 +903,22 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
     #endif
 #endif
 {
-    uint8_t *code = mod->code->code;
+    #ifdef IMPL_CODE_LOADER
+        uint8_t *code = mod->code->code;
+        term *instructions = mod->instructions;
+        unsigned int ii = 0;
+        // last emitted instruction that can still be fused with the following one
+        int last_opcode = 0;
+        unsigned int last_instruction_ii = 0;
+        #ifdef ENABLE_JIT
+            // a label has been found since the last emitted instruction
+            int jump_target = 0;
+        #endif
+    #endif
+
+    #ifdef IMPL_EXECUTE_LOOP
+        const term *code = mod->instructions;
+    #endif
 
     unsigned int i = 0;
 
@@ -594,13 +945,127 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
         ctx->cp = module_address(mod->module_index, mod->end_instruction_ii);
         JUMP_TO_ADDRESS(mod->labels[label]);
 
-        int remaining_reductions = DEFAULT_REDUCTIONS_AMOUNT;
+    #endif
+
+    #ifdef USE_COMPUTED_GOTO
+        // handlers are reached without the switch range check, and each handler jumps to the
+        // following one on its own, see DISPATCH_NEXT_INSTRUCTION. Unknown opcodes end up in default.
+        static const void *const dispatch_table[256] = {
+            [0 ... 255] = &&undecoded_opcode,
+            [OP_LABEL] = &&OP_LABEL_HANDLER,
+            [OP_FUNC_INFO] = &&OP_FUNC_INFO_HANDLER,
+            [OP_INT_CALL_END] = &&OP_INT_CALL_END_HANDLER,
+            [OP_CALL] = &&OP_CALL_HANDLER,
+            [OP_CALL_LAST] = &&OP_CALL_LAST_HANDLER,
+            [OP_CALL_ONLY] = &&OP_CALL_ONLY_HANDLER,
+            [OP_CALL_EXT] = &&OP_CALL_EXT_HANDLER,
+            [OP_CALL_EXT_LAST] = &&OP_CALL_EXT_LAST_HANDLER,
+            [OP_BIF0] = &&OP_BIF0_HANDLER,
+            [OP_BIF1] = &&OP_BIF1_HANDLER,
+            [OP_BIF2] = &&OP_BIF2_HANDLER,
+            [OP_ALLOCATE] = &&OP_ALLOCATE_HANDLER,
+            [OP_ALLOCATE_HEAP] = &&OP_ALLOCATE_HEAP_HANDLER,
+            [OP_ALLOCATE_ZERO] = &&OP_ALLOCATE_ZERO_HANDLER,
+            [OP_ALLOCATE_HEAP_ZERO] = &&OP_ALLOCATE_HEAP_ZERO_HANDLER,
+            [OP_TEST_HEAP] = &&OP_TEST_HEAP_HANDLER,
+            [OP_KILL] = &&OP_KILL_HANDLER,
+            [OP_DEALLOCATE] = &&OP_DEALLOCATE_HANDLER,
+            [OP_RETURN] = &&OP_RETURN_HANDLER,
+            [OP_SEND] = &&OP_SEND_HANDLER,
+            [OP_REMOVE_MESSAGE] = &&OP_REMOVE_MESSAGE_HANDLER,
+            [OP_TIMEOUT] = &&OP_TIMEOUT_HANDLER,
+            [OP_LOOP_REC] = &&OP_LOOP_REC_HANDLER,
+            [OP_LOOP_REC_END] = &&OP_LOOP_REC_END_HANDLER,
+            [OP_WAIT] = &&OP_WAIT_HANDLER,
+            [OP_WAIT_TIMEOUT] = &&OP_WAIT_TIMEOUT_HANDLER,
+            [OP_IS_LT] = &&OP_IS_LT_HANDLER,
+            [OP_IS_GE] = &&OP_IS_GE_HANDLER,
+            [OP_IS_EQUAL] = &&OP_IS_EQUAL_HANDLER,
+            [OP_IS_NOT_EQUAL] = &&OP_IS_NOT_EQUAL_HANDLER,
+            [OP_IS_EQ_EXACT] = &&OP_IS_EQ_EXACT_HANDLER,
+            [OP_IS_NOT_EQ_EXACT] = &&OP_IS_NOT_EQ_EXACT_HANDLER,
+            [OP_IS_INTEGER] = &&OP_IS_INTEGER_HANDLER,
+            [OP_IS_NUMBER] = &&OP_IS_NUMBER_HANDLER,
+            [OP_IS_BINARY] = &&OP_IS_BINARY_HANDLER,
+            [OP_IS_LIST] = &&OP_IS_LIST_HANDLER,
+            [OP_IS_NONEMPTY_LIST] = &&OP_IS_NONEMPTY_LIST_HANDLER,
+            [OP_IS_NIL] = &&OP_IS_NIL_HANDLER,
+            [OP_IS_ATOM] = &&OP_IS_ATOM_HANDLER,
+            [OP_IS_PID] = &&OP_IS_PID_HANDLER,
+            [OP_IS_REFERENCE] = &&OP_IS_REFERENCE_HANDLER,
+            [OP_IS_PORT] = &&OP_IS_PORT_HANDLER,
+            [OP_IS_TUPLE] = &&OP_IS_TUPLE_HANDLER,
+            [OP_TEST_ARITY] = &&OP_TEST_ARITY_HANDLER,
+            [OP_SELECT_VAL] = &&OP_SELECT_VAL_HANDLER,
+            [OP_SELECT_TUPLE_ARITY] = &&OP_SELECT_TUPLE_ARITY_HANDLER,
+            [OP_JUMP] = &&OP_JUMP_HANDLER,
+            [OP_MOVE] = &&OP_MOVE_HANDLER,
+            [OP_GET_LIST] = &&OP_GET_LIST_HANDLER,
+            [OP_GET_TUPLE_ELEMENT] = &&OP_GET_TUPLE_ELEMENT_HANDLER,
+            [OP_SET_TUPLE_ELEMENT] = &&OP_SET_TUPLE_ELEMENT_HANDLER,
+            [OP_PUT_LIST] = &&OP_PUT_LIST_HANDLER,
+            [OP_PUT_TUPLE] = &&OP_PUT_TUPLE_HANDLER,
+            [OP_BADMATCH] = &&OP_BADMATCH_HANDLER,
+            [OP_IF_END] = &&OP_IF_END_HANDLER,
+            [OP_CASE_END] = &&OP_CASE_END_HANDLER,
+            [OP_CALL_FUN] = &&OP_CALL_FUN_HANDLER,
+            [OP_IS_FUNCTION] = &&OP_IS_FUNCTION_HANDLER,
+            [OP_CALL_EXT_ONLY] = &&OP_CALL_EXT_ONLY_HANDLER,
+            [OP_MAKE_FUN2] = &&OP_MAKE_FUN2_HANDLER,
+            [OP_TRY] = &&OP_TRY_HANDLER,
+            [OP_TRY_END] = &&OP_TRY_END_HANDLER,
+            [OP_TRY_CASE] = &&OP_TRY_CASE_HANDLER,
+            [OP_TRY_CASE_END] = &&OP_TRY_CASE_END_HANDLER,
+            [OP_APPLY] = &&OP_APPLY_HANDLER,
+            [OP_APPLY_LAST] = &&OP_APPLY_LAST_HANDLER,
+            [OP_IS_BOOLEAN] = &&OP_IS_BOOLEAN_HANDLER,
+            [OP_IS_FUNCTION2] = &&OP_IS_FUNCTION2_HANDLER,
+            [OP_GC_BIF1] = &&OP_GC_BIF1_HANDLER,
+            [OP_GC_BIF2] = &&OP_GC_BIF2_HANDLER,
+            [OP_TRIM] = &&OP_TRIM_HANDLER,
+            [OP_RECV_MARK] = &&OP_RECV_MARK_HANDLER,
+            [OP_RECV_SET] = &&OP_RECV_SET_HANDLER,
+            [OP_LINE] = &&OP_LINE_HANDLER,
+            [OP_IS_TAGGED_TUPLE] = &&OP_IS_TAGGED_TUPLE_HANDLER,
+#ifdef ENABLE_OTP21
+            [OP_GET_HD] = &&OP_GET_HD_HANDLER,
+            [OP_GET_TL] = &&OP_GET_TL_HANDLER,
+#endif
+            [OP_IS_TAGGED_TUPLE_GET_TUPLE_ELEMENT] = &&OP_IS_TAGGED_TUPLE_GET_TUPLE_ELEMENT_HANDLER,
+            [OP_TEST_HEAP_PUT_LIST] = &&OP_TEST_HEAP_PUT_LIST_HANDLER,
+            [OP_MOVE_CALL_ONLY] = &&OP_MOVE_CALL_ONLY_HANDLER,
+            [OP_IS_NONEMPTY_LIST_GET_LIST] = &&OP_IS_NONEMPTY_LIST_GET_LIST_HANDLER,
+            [OP_MOVE_RETURN] = &&OP_MOVE_RETURN_HANDLER,
+            [OP_SELECT_VAL_BINARY_SEARCH] = &&OP_SELECT_VAL_BINARY_SEARCH_HANDLER,
+            [OP_SELECT_VAL_JUMP_TABLE] = &&OP_SELECT_VAL_JUMP_TABLE_HANDLER,
+            [OP_SELECT_TUPLE_ARITY_BINARY_SEARCH] = &&OP_SELECT_TUPLE_ARITY_BINARY_SEARCH_HANDLER,
+            [OP_SELECT_TUPLE_ARITY_JUMP_TABLE] = &&OP_SELECT_TUPLE_ARITY_JUMP_TABLE_HANDLER,
+            [OP_INT_TRAP_RESUME] = &&OP_INT_TRAP_RESUME_HANDLER,
+            #ifdef ENABLE_JIT
+                [OP_INT_NATIVE] = &&OP_INT_NATIVE_HANDLER,
+            #endif
+        };
     #endif
 
     while(1) {
 
+        #ifdef IMPL_CODE_LOADER
+            unsigned int instruction_ii = ii;
+            int opcode = code[i];
+            int fused_opcode = superinstruction_lookup(last_opcode, opcode);
+            if (fused_opcode) {
+                // operands are appended to the previous instruction ones
+                instructions[last_instruction_ii] = fused_opcode;
+            } else {
+                EMIT_WORD(opcode);
+            }
+        #endif
+
+        PROFILE_INSTRUCTION();
+        DISPATCH_INSTRUCTION();
+
         switch (code[i]) {
-            case OP_LABEL: {
+            OPCODE_CASE(OP_LABEL): {
                 int label;
                 int next_offset = 1;
                 DECODE_LABEL(label, code, i, next_offset, next_offset)
@@ -609,28 +1074,41 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 USED_BY_TRACE(label);
 
                 #ifdef IMPL_CODE_LOADER
-                    TRACE("Mark label %i here at %i\n", label, i);
-                    module_add_label(mod, label, &code[i]);
+                    TRACE("Mark label %i here at %i\n", label, instruction_ii);
+                    module_add_label(mod, label, &instructions[instruction_ii]);
+                    // labels are not needed at runtime
+                    ii = instruction_ii;
+                    // instructions cannot be fused across a jump target
+                    last_opcode = 0;
+                    #ifdef ENABLE_JIT
+                        jump_target = 1;
+                    #endif
                 #endif
 
                 NEXT_INSTRUCTION(next_offset);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_FUNC_INFO: {
+            OPCODE_CASE(OP_FUNC_INFO): {
                 int next_offset = 1;
-                int module_atom;
+                term module_atom;
                 DECODE_ATOM(module_atom, code, i, next_offset, next_offset)
-                int function_name_atom;
+                term function_name_atom;
                 DECODE_ATOM(function_name_atom, code, i, next_offset, next_offset)
                 int arity;
                 DECODE_INTEGER(arity, code, i, next_offset, next_offset);
 
-                TRACE("func_info/3 module_name_a=%i, function_name_a=%i, arity=%i\n", module_atom, function_name_atom, arity);
+                TRACE("func_info/3 module_name_a=%lx, function_name_a=%lx, arity=%i\n", module_atom, function_name_atom, arity);
                 USED_BY_TRACE(function_name_atom);
                 USED_BY_TRACE(module_atom);
                 USED_BY_TRACE(arity);
 
+                #if defined(IMPL_CODE_LOADER) && defined(ENABLE_FUNCTION_PROFILER)
+                    if (LIKELY(mod->functions_count < (int) ENDIAN_SWAP_32(mod->code->functions_count))) {
+                        mod->function_offsets[mod->functions_count++] = instruction_ii;
+                    }
+                #endif
+
                 #ifdef IMPL_EXECUTE_LOOP
                     int target_label = get_catch_label_and_change_module(ctx, &mod);
 
@@ -639,22 +1117,24 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                         ctx->x[1] = FUNCTION_CLAUSE_ATOM;
                         JUMP_TO_ADDRESS(mod->labels[target_label]);
                     } else {
-                        fprintf(stderr, "FUNC_INFO: No function clause for module %i atom %i arity %i.\n", module_atom, function_name_atom, arity);
+                        fprintf(stderr, "FUNC_INFO: No function clause for module %i atom %i arity %i.\n",
+                            term_to_atom_index(module_atom), term_to_atom_index(function_name_atom), arity);
                         abort();
                     }
 
                 #endif
 
                 NEXT_INSTRUCTION(next_offset);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_INT_CALL_END: {
+            OPCODE_CASE(OP_INT_CALL_END): {
                 TRACE("int_call_end!\n");
 
             #ifdef IMPL_CODE_LOADER
                 TRACE("-- Code loading finished --\n");
-                return i;
+                EMIT_WORD(OP_INT_TRAP_RESUME);
+                return instruction_ii;
             #endif
 
             #ifdef IMPL_EXECUTE_LOOP
@@ -676,15 +1156,14 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
 
                 ctx = scheduled_context;
                 mod = ctx->saved_module;
-                code = mod->code->code;
-                remaining_reductions = DEFAULT_REDUCTIONS_AMOUNT;
+                code = mod->instructions;
                 JUMP_TO_ADDRESS(scheduled_context->saved_ip);
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             #endif
             }
 
-            case OP_CALL: {
+            OPCODE_CASE(OP_CALL): {
                 int next_offset = 1;
                 int arity;
                 DECODE_INTEGER(arity, code, i, next_offset, next_offset);
@@ -697,9 +1176,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #ifdef IMPL_EXECUTE_LOOP
                     NEXT_INSTRUCTION(next_offset);
                     ctx->cp = module_address(mod->module_index, i);
+                    PROFILE_CALL(mod, mod->labels[label]);
 
-                    remaining_reductions--;
-                    if (LIKELY(remaining_reductions)) {
+                    ctx->remaining_reductions--;
+                    if (LIKELY(ctx->remaining_reductions > 0)) {
                         TRACE_CALL(ctx, mod, "call", label, arity);
                         JUMP_TO_ADDRESS(mod->labels[label]);
                     } else {
@@ -711,10 +1191,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_offset);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_CALL_LAST: {
+            OPCODE_CASE(OP_CALL_LAST): {
                 int next_offset = 1;
                 int arity;
                 DECODE_INTEGER(arity, code, i, next_offset, next_offset);
@@ -733,9 +1213,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     ctx->e += (n_words + 1);
 
                     DEBUG_DUMP_STACK(ctx);
+                    PROFILE_TAIL_CALL(mod, mod->labels[label]);
 
-                    remaining_reductions--;
-                    if (LIKELY(remaining_reductions)) {
+                    ctx->remaining_reductions--;
+                    if (LIKELY(ctx->remaining_reductions > 0)) {
                         TRACE_CALL(ctx, mod, "call_last", label, arity);
                         JUMP_TO_ADDRESS(mod->labels[label]);
                     } else {
@@ -747,10 +1228,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_offset);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_CALL_ONLY: {
+            OPCODE_CASE(OP_CALL_ONLY): {
                 int next_off = 1;
                 int arity;
                 DECODE_INTEGER(arity, code, i, next_off, next_off);
@@ -764,8 +1245,9 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #ifdef IMPL_EXECUTE_LOOP
 
                     NEXT_INSTRUCTION(next_off);
-                    remaining_reductions--;
-                    if (LIKELY(remaining_reductions)) {
+                    PROFILE_TAIL_CALL(mod, mod->labels[label]);
+                    ctx->remaining_reductions--;
+                    if (LIKELY(ctx->remaining_reductions > 0)) {
                         TRACE_CALL(ctx, mod, "call_only", label, arity);
                         JUMP_TO_ADDRESS(mod->labels[label]);
                     } else {
@@ -777,10 +1259,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_CALL_EXT: {
+            OPCODE_CASE(OP_CALL_EXT): {
                 int next_off = 1;
                 int arity;
                 DECODE_INTEGER(arity, code, i, next_off, next_off);
@@ -797,8 +1279,8 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    remaining_reductions--;
-                    if (UNLIKELY(!remaining_reductions)) {
+                    ctx->remaining_reductions--;
+                    if (UNLIKELY(ctx->remaining_reductions <= 0)) {
                         SCHEDULE_NEXT(mod, INSTRUCTION_POINTER());
                         continue;
                     }
@@ -809,15 +1291,21 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
 
                     const struct ExportedFunction *func = mod->imported_funcs[index].func;
 
-                    if (func->type == UnresolvedFunctionCall) {
+                    if (UNLIKELY(func->type == UnresolvedFunctionCall)) {
                         func = module_resolve_function(mod, index);
                     }
 
                     switch (func->type) {
                         case NIFFunctionType: {
                             const struct Nif *nif = EXPORTED_FUNCTION_TO_NIF(func);
+                            PROFILE_NATIVE_BEGIN();
                             term return_value = nif->nif_ptr(ctx, arity, ctx->x);
+                            PROFILE_NATIVE_END(index);
                             if (UNLIKELY(term_is_invalid_term(return_value))) {
+                                if (ctx->trap_nif) {
+                                    TRAP_NIF(module_address(mod->module_index, i));
+                                    continue;
+                                }
                                 RAISE_EXCEPTION();
                             }
                             ctx->x[0] = return_value;
@@ -827,8 +1315,9 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                             const struct ModuleFunction *jump = EXPORTED_FUNCTION_TO_MODULE_FUNCTION(func);
 
                             ctx->cp = module_address(mod->module_index, i);
+                            PROFILE_CALL(jump->target, jump->target->labels[jump->label]);
                             mod = jump->target;
-                            code = mod->code->code;
+                            code = mod->instructions;
                             JUMP_TO_ADDRESS(mod->labels[jump->label]);
 
                             break;
@@ -840,10 +1329,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     }
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_CALL_EXT_LAST: {
+            OPCODE_CASE(OP_CALL_EXT_LAST): {
                 int next_off = 1;
                 int arity;
                 DECODE_INTEGER(arity, code, i, next_off, next_off);
@@ -858,8 +1347,8 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 USED_BY_TRACE(n_words);
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    remaining_reductions--;
-                    if (UNLIKELY(!remaining_reductions)) {
+                    ctx->remaining_reductions--;
+                    if (UNLIKELY(ctx->remaining_reductions <= 0)) {
                         SCHEDULE_NEXT(mod, INSTRUCTION_POINTER());
                         continue;
                     }
@@ -871,19 +1360,27 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
 
                     const struct ExportedFunction *func = mod->imported_funcs[index].func;
 
-                    if (func->type == UnresolvedFunctionCall) {
+                    if (UNLIKELY(func->type == UnresolvedFunctionCall)) {
                         func = module_resolve_function(mod, index);
                     }
 
                     switch (func->type) {
                         case NIFFunctionType: {
                             const struct Nif *nif = EXPORTED_FUNCTION_TO_NIF(func);
+                            PROFILE_NATIVE_BEGIN();
                             term return_value = nif->nif_ptr(ctx, arity, ctx->x);
+                            PROFILE_NATIVE_END(index);
                             if (UNLIKELY(term_is_invalid_term(return_value))) {
+                                if (ctx->trap_nif) {
+                                    PROFILE_RETURN();
+                                    TRAP_NIF(ctx->cp);
+                                    continue;
+                                }
                                 RAISE_EXCEPTION();
                             }
                             ctx->x[0] = return_value;
 
+                            PROFILE_RETURN();
                             DO_RETURN();
 
                             break;
@@ -891,8 +1388,9 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                         case ModuleFunction: {
                             const struct ModuleFunction *jump = EXPORTED_FUNCTION_TO_MODULE_FUNCTION(func);
 
+                            PROFILE_TAIL_CALL(jump->target, jump->target->labels[jump->label]);
                             mod = jump->target;
-                            code = mod->code->code;
+                            code = mod->instructions;
                             JUMP_TO_ADDRESS(mod->labels[jump->label]);
 
                             break;
@@ -908,10 +1406,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_BIF0: {
+            OPCODE_CASE(OP_BIF0): {
                 int next_off = 1;
                 int bif;
                 DECODE_INTEGER(bif, code, i, next_off, next_off);
@@ -926,17 +1424,19 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #ifdef IMPL_EXECUTE_LOOP
                     BifImpl0 func = (BifImpl0) mod->imported_funcs[bif].bif;
                     DEBUG_FAIL_NULL(func);
+                    PROFILE_NATIVE_BEGIN();
                     term ret = func(ctx);
+                    PROFILE_NATIVE_END(bif);
 
                     WRITE_REGISTER(dreg_type, dreg, ret);
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
             //TODO: implement me
-            case OP_BIF1: {
+            OPCODE_CASE(OP_BIF1): {
                 int next_off = 1;
                 int fail_label;
                 DECODE_LABEL(fail_label, code, i, next_off, next_off);
@@ -959,7 +1459,9 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #ifdef IMPL_EXECUTE_LOOP
                     BifImpl1 func = (BifImpl1) mod->imported_funcs[bif].bif;
                     DEBUG_FAIL_NULL(func);
+                    PROFILE_NATIVE_BEGIN();
                     term ret = func(ctx, arg1);
+                    PROFILE_NATIVE_END(bif);
                     if (UNLIKELY(term_is_invalid_term(ret))) {
                         RAISE_EXCEPTION();
                     }
@@ -968,11 +1470,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
             //TODO: implement me
-            case OP_BIF2: {
+            OPCODE_CASE(OP_BIF2): {
                 int next_off = 1;
                 int fail_label;
                 DECODE_LABEL(fail_label, code, i, next_off, next_off);
@@ -998,7 +1500,9 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #ifdef IMPL_EXECUTE_LOOP
                     BifImpl2 func = (BifImpl2) mod->imported_funcs[bif].bif;
                     DEBUG_FAIL_NULL(func);
+                    PROFILE_NATIVE_BEGIN();
                     term ret = func(ctx, arg1, arg2);
+                    PROFILE_NATIVE_END(bif);
                     if (UNLIKELY(term_is_invalid_term(ret))) {
                         RAISE_EXCEPTION();
                     }
@@ -1007,10 +1511,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_ALLOCATE: {
+            OPCODE_CASE(OP_ALLOCATE): {
                 int next_off = 1;
                 int stack_need;
                 DECODE_INTEGER(stack_need, code, i, next_off, next_off);
@@ -1038,10 +1542,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_ALLOCATE_HEAP: {
+            OPCODE_CASE(OP_ALLOCATE_HEAP): {
                 int next_off = 1;
                 int stack_need;
                 DECODE_INTEGER(stack_need, code, i, next_off, next_off);
@@ -1072,10 +1576,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_ALLOCATE_ZERO: {
+            OPCODE_CASE(OP_ALLOCATE_ZERO): {
                 int next_off = 1;
                 int stack_need;
                 DECODE_INTEGER(stack_need, code, i, next_off, next_off);
@@ -1107,10 +1611,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_ALLOCATE_HEAP_ZERO: {
+            OPCODE_CASE(OP_ALLOCATE_HEAP_ZERO): {
                 int next_off = 1;
                 int stack_need;
                 DECODE_INTEGER(stack_need, code, i, next_off, next_off);
@@ -1144,10 +1648,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_TEST_HEAP: {
+            OPCODE_CASE(OP_TEST_HEAP): {
                 int next_offset = 1;
                 unsigned int heap_need;
                 DECODE_INTEGER(heap_need, code, i, next_offset, next_offset);
@@ -1159,25 +1663,19 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 USED_BY_TRACE(live_registers);
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    if (context_avail_free_memory(ctx) < heap_need) {
+                    if ((context_avail_free_memory(ctx) < heap_need) || (context_avail_free_memory(ctx) > heap_need * HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF)) {
                         context_clean_registers(ctx, live_registers);
-                        if (UNLIKELY(memory_ensure_free(ctx, heap_need) != MEMORY_GC_OK)) {
-                            RAISE_ERROR(out_of_memory_atom);
-                        }
-                    } else if (context_avail_free_memory(ctx) > heap_need * HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF) {
-                        context_clean_registers(ctx, live_registers);
-                        int used_size = context_memory_size(ctx) - context_avail_free_memory(ctx);
-                        if (UNLIKELY(memory_ensure_free(ctx, used_size + heap_need * (HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF / 2)) != MEMORY_GC_OK)) {
+                        if (UNLIKELY(memory_ensure_free_opt(ctx, heap_need, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
                             RAISE_ERROR(out_of_memory_atom);
                         }
                     }
                 #endif
 
                 NEXT_INSTRUCTION(next_offset);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_KILL: {
+            OPCODE_CASE(OP_KILL): {
                 int next_offset = 1;
                 int target;
                 DECODE_INTEGER(target, code, i, next_offset, next_offset);
@@ -1190,10 +1688,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
 
                 NEXT_INSTRUCTION(next_offset);
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_DEALLOCATE: {
+            OPCODE_CASE(OP_DEALLOCATE): {
                 int next_off = 1;
                 int n_words;
                 DECODE_INTEGER(n_words, code, i, next_off, next_off);
@@ -1210,14 +1708,15 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_RETURN: {
+            OPCODE_CASE(OP_RETURN): {
                 TRACE("return/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
                     TRACE_RETURN(ctx);
+                    PROFILE_RETURN();
 
                     if ((long) ctx->cp == -1) {
                         return 0;
@@ -1229,11 +1728,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #ifdef IMPL_CODE_LOADER
                     NEXT_INSTRUCTION(1);
                 #endif
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
             //TODO: implement send/0
-            case OP_SEND: {
+            OPCODE_CASE(OP_SEND): {
                 #ifdef IMPL_CODE_LOADER
                     TRACE("send/0\n");
                 #endif
@@ -1251,11 +1750,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(1);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
             //TODO: implement remove_message/0
-            case OP_REMOVE_MESSAGE: {
+            OPCODE_CASE(OP_REMOVE_MESSAGE): {
                 TRACE("remove_message/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
@@ -1263,24 +1762,24 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(1);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
             //TODO: implement timeout/0
-            case OP_TIMEOUT: {
+            OPCODE_CASE(OP_TIMEOUT): {
                 TRACE("timeout/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
                     ctx->timeout_at.tv_sec = 0;
                     ctx->timeout_at.tv_nsec = 0;
+                    mailbox_reset(ctx);
                 #endif
 
                 NEXT_INSTRUCTION(1);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            //TODO: implemente loop_rec/2
-            case OP_LOOP_REC: {
+            OPCODE_CASE(OP_LOOP_REC): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1292,7 +1791,7 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 USED_BY_TRACE(dreg);
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    if (ctx->mailbox == NULL) {
+                    if (ctx->mailbox_save == NULL) {
                         JUMP_TO_ADDRESS(mod->labels[label]);
                     } else {
                         term ret = mailbox_peek(ctx);
@@ -1307,11 +1806,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            //TODO: stub, implement loop_rec_end/1
-            case OP_LOOP_REC_END: {
+            OPCODE_CASE(OP_LOOP_REC_END): {
                 int next_offset = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_offset, next_offset);
@@ -1319,12 +1817,28 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 TRACE("loop_rec_end/1 label=%i\n", label);
                 USED_BY_TRACE(label);
 
-                NEXT_INSTRUCTION(next_offset);
-                break;
+                #ifdef IMPL_EXECUTE_LOOP
+                    // receive keeps live terms in y registers, so x registers can only reference the skipped message
+                    context_clean_registers(ctx, 0);
+                    mailbox_next(ctx);
+
+                    ctx->remaining_reductions--;
+                    if (LIKELY(ctx->remaining_reductions > 0)) {
+                        JUMP_TO_ADDRESS(mod->labels[label]);
+                    } else {
+                        SCHEDULE_NEXT(mod, mod->labels[label]);
+                    }
+                #endif
+
+                #ifdef IMPL_CODE_LOADER
+                    NEXT_INSTRUCTION(next_offset);
+                #endif
+
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
             //TODO: implement wait/1
-            case OP_WAIT: {
+            OPCODE_CASE(OP_WAIT): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1339,7 +1853,7 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     ctx = scheduled_context;
 
                     mod = ctx->saved_module;
-                    code = mod->code->code;
+                    code = mod->instructions;
                     JUMP_TO_ADDRESS(scheduled_context->saved_ip);
                 #endif
 
@@ -1347,11 +1861,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
             //TODO: implement wait_timeout/2
-            case OP_WAIT_TIMEOUT: {
+            OPCODE_CASE(OP_WAIT_TIMEOUT): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1379,7 +1893,7 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                         Context *scheduled_context = scheduler_wait(ctx->global, ctx);
                         ctx = scheduled_context;
                         mod = ctx->saved_module;
-                        code = mod->code->code;
+                        code = mod->instructions;
                         JUMP_TO_ADDRESS(scheduled_context->saved_ip);
                     }
                 #endif
@@ -1392,11 +1906,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
 
-            case OP_IS_LT: {
+            OPCODE_CASE(OP_IS_LT): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off);
@@ -1422,10 +1936,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_GE: {
+            OPCODE_CASE(OP_IS_GE): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off);
@@ -1451,10 +1965,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_EQUAL: {
+            OPCODE_CASE(OP_IS_EQUAL): {
                 int label;
                 term arg1;
                 term arg2;
@@ -1481,10 +1995,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_NOT_EQUAL: {
+            OPCODE_CASE(OP_IS_NOT_EQUAL): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1510,10 +2024,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_EQ_EXACT: {
+            OPCODE_CASE(OP_IS_EQ_EXACT): {
                 int label;
                 term arg1;
                 term arg2;
@@ -1540,10 +2054,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_NOT_EQ_EXACT: {
+            OPCODE_CASE(OP_IS_NOT_EQ_EXACT): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1570,10 +2084,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
            }
 
-           case OP_IS_INTEGER: {
+           OPCODE_CASE(OP_IS_INTEGER): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1597,10 +2111,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-           case OP_IS_NUMBER: {
+           OPCODE_CASE(OP_IS_NUMBER): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1625,10 +2139,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_BINARY: {
+            OPCODE_CASE(OP_IS_BINARY): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1651,10 +2165,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_LIST: {
+            OPCODE_CASE(OP_IS_LIST): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1677,10 +2191,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_NONEMPTY_LIST: {
+            OPCODE_CASE(OP_IS_NONEMPTY_LIST): {
                 int label;
                 term arg1;
                 int next_off = 1;
@@ -1703,10 +2217,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_NIL: {
+            OPCODE_CASE(OP_IS_NIL): {
                 int label;
                 term arg1;
                 int next_off = 1;
@@ -1729,10 +2243,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_ATOM: {
+            OPCODE_CASE(OP_IS_ATOM): {
                 int label;
                 term arg1;
                 int next_off = 1;
@@ -1755,10 +2269,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_PID: {
+            OPCODE_CASE(OP_IS_PID): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1781,10 +2295,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_REFERENCE: {
+            OPCODE_CASE(OP_IS_REFERENCE): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1807,10 +2321,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_PORT: {
+            OPCODE_CASE(OP_IS_PORT): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1840,10 +2354,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
            }
 
-           case OP_IS_TUPLE: {
+           OPCODE_CASE(OP_IS_TUPLE): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -1867,10 +2381,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-           case OP_TEST_ARITY: {
+           OPCODE_CASE(OP_TEST_ARITY): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off);
@@ -1885,7 +2399,7 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     if (term_get_tuple_arity(arg1) == arity) {
                         NEXT_INSTRUCTION(next_off);
                     } else {
-                        i = (uint8_t *) mod->labels[label] - code;
+                        i = POINTER_TO_II(mod->labels[label]);
                     }
                 #endif
 
@@ -1896,16 +2410,16 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_SELECT_VAL: {
+            OPCODE_CASE(OP_SELECT_VAL): {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
                 int default_label;
                 DECODE_LABEL(default_label, code, i, next_off, next_off)
-                next_off++; //skip extended list tag
+                DECODE_EXTENDED_LIST_TAG(code, i, next_off, next_off);
                 int size;
                 DECODE_INTEGER(size, code, i, next_off, next_off)
 
@@ -1947,19 +2461,20 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 #ifdef IMPL_CODE_LOADER
+                    instructions[instruction_ii] = select_val_lower(&instructions[ii - size], size / 2);
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_SELECT_TUPLE_ARITY: {
+            OPCODE_CASE(OP_SELECT_TUPLE_ARITY): {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
                 int default_label;
                 DECODE_LABEL(default_label, code, i, next_off, next_off)
-                next_off++; //skip extended list tag
+                DECODE_EXTENDED_LIST_TAG(code, i, next_off, next_off);
                 int size;
                 DECODE_INTEGER(size, code, i, next_off, next_off)
 
@@ -2001,13 +2516,14 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 #ifdef IMPL_CODE_LOADER
+                    instructions[instruction_ii] = select_tuple_arity_lower(&instructions[ii - size], size / 2);
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_JUMP: {
+            OPCODE_CASE(OP_JUMP): {
                 int label;
                 int next_offset = 1;
                 DECODE_LABEL(label, code, i, next_offset, next_offset)
@@ -2016,8 +2532,8 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 USED_BY_TRACE(label);
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    remaining_reductions--;
-                    if (LIKELY(remaining_reductions)) {
+                    ctx->remaining_reductions--;
+                    if (LIKELY(ctx->remaining_reductions > 0)) {
                         JUMP_TO_ADDRESS(mod->labels[label]);
                     } else {
                         SCHEDULE_NEXT(mod, mod->labels[label]);
@@ -2028,10 +2544,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_offset);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_MOVE: {
+            OPCODE_CASE(OP_MOVE): {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off);
@@ -2051,10 +2567,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_GET_LIST: {
+            OPCODE_CASE(OP_GET_LIST): {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
@@ -2081,10 +2597,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_GET_TUPLE_ELEMENT: {
+            OPCODE_CASE(OP_GET_TUPLE_ELEMENT): {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off);
@@ -2107,10 +2623,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_SET_TUPLE_ELEMENT: {
+            OPCODE_CASE(OP_SET_TUPLE_ELEMENT): {
                 int next_off = 1;
                 term new_element;
                 DECODE_COMPACT_TERM(new_element, code, i, next_off, next_off);
@@ -2123,6 +2639,7 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
 
 #ifdef IMPL_EXECUTE_LOOP
                 term_put_tuple_element(tuple, position, new_element);
+                context_write_barrier(ctx, tuple);
 #endif
 
 #ifdef IMPL_CODE_LOADER
@@ -2131,10 +2648,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 UNUSED(new_element);
 #endif
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_PUT_LIST: {
+            OPCODE_CASE(OP_PUT_LIST): {
 
                 int next_off = 1;
                 term head;
@@ -2162,10 +2679,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_PUT_TUPLE: {
+            OPCODE_CASE(OP_PUT_TUPLE): {
                 int next_off = 1;
                 int size;
                 DECODE_INTEGER(size, code, i, next_off, next_off);
@@ -2188,11 +2705,13 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 for (int j = 0; j < size; j++) {
-                    if (code[i + next_off] != OP_PUT) {
-                        fprintf(stderr, "Expected put, got opcode: %i\n", code[i + next_off]);
-                        abort();
-                    }
-                    next_off++;
+                    #ifdef IMPL_CODE_LOADER
+                        if (code[i + next_off] != OP_PUT) {
+                            fprintf(stderr, "Expected put, got opcode: %i\n", code[i + next_off]);
+                            abort();
+                        }
+                        next_off++;
+                    #endif
                     term put_value;
                     DECODE_COMPACT_TERM(put_value, code, i, next_off, next_off);
                     #ifdef IMPL_CODE_LOADER
@@ -2210,10 +2729,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 }
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_BADMATCH: {
+            OPCODE_CASE(OP_BADMATCH): {
                 int next_off = 1;
                 term arg1;
                 DECODE_COMPACT_TERM(arg1, code, i, next_off, next_off)
@@ -2240,10 +2759,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IF_END: {
+            OPCODE_CASE(OP_IF_END): {
                 TRACE("if_end/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
@@ -2261,10 +2780,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(1);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_CASE_END: {
+            OPCODE_CASE(OP_CASE_END): {
                 int next_off = 1;
                 term arg1;
                 DECODE_COMPACT_TERM(arg1, code, i, next_off, next_off)
@@ -2291,10 +2810,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_CALL_FUN: {
+            OPCODE_CASE(OP_CALL_FUN): {
                 int next_off = 1;
                 unsigned int args_count;
                 DECODE_INTEGER(args_count, code, i, next_off, next_off)
@@ -2352,12 +2871,13 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
 
                     NEXT_INSTRUCTION(next_off);
                     ctx->cp = module_address(mod->module_index, i);
+                    PROFILE_CALL(fun_module, fun_module->labels[label]);
 
                     mod = fun_module;
-                    code = mod->code->code;
+                    code = mod->instructions;
 
-                    remaining_reductions--;
-                    if (LIKELY(remaining_reductions)) {
+                    ctx->remaining_reductions--;
+                    if (LIKELY(ctx->remaining_reductions > 0)) {
                         JUMP_TO_ADDRESS(mod->labels[label]);
                     } else {
                         SCHEDULE_NEXT(mod, mod->labels[label]);
@@ -2369,10 +2889,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-           case OP_IS_FUNCTION: {
+           OPCODE_CASE(OP_IS_FUNCTION): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -2396,10 +2916,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_CALL_EXT_ONLY: {
+            OPCODE_CASE(OP_CALL_EXT_ONLY): {
                 int next_off = 1;
                 int arity;
                 DECODE_INTEGER(arity, code, i, next_off, next_off);
@@ -2415,8 +2935,8 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    remaining_reductions--;
-                    if (UNLIKELY(!remaining_reductions)) {
+                    ctx->remaining_reductions--;
+                    if (UNLIKELY(ctx->remaining_reductions <= 0)) {
                         SCHEDULE_NEXT(mod, INSTRUCTION_POINTER());
                         continue;
                     }
@@ -2425,18 +2945,26 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
 
                     const struct ExportedFunction *func = mod->imported_funcs[index].func;
 
-                    if (func->type == UnresolvedFunctionCall) {
+                    if (UNLIKELY(func->type == UnresolvedFunctionCall)) {
                         func = module_resolve_function(mod, index);
                     }
 
                     switch (func->type) {
                         case NIFFunctionType: {
                             const struct Nif *nif = EXPORTED_FUNCTION_TO_NIF(func);
+                            PROFILE_NATIVE_BEGIN();
                             term return_value = nif->nif_ptr(ctx, arity, ctx->x);
+                            PROFILE_NATIVE_END(index);
                             if (UNLIKELY(term_is_invalid_term(return_value))) {
+                                if (ctx->trap_nif) {
+                                    PROFILE_RETURN();
+                                    TRAP_NIF(ctx->cp);
+                                    continue;
+                                }
                                 RAISE_EXCEPTION();
                             }
                             ctx->x[0] = return_value;
+                            PROFILE_RETURN();
                             if ((long) ctx->cp == -1) {
                                 return 0;
                             }
@@ -2448,8 +2976,9 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                         case ModuleFunction: {
                             const struct ModuleFunction *jump = EXPORTED_FUNCTION_TO_MODULE_FUNCTION(func);
 
+                            PROFILE_TAIL_CALL(jump->target, jump->target->labels[jump->label]);
                             mod = jump->target;
-                            code = mod->code->code;
+                            code = mod->instructions;
 
                             JUMP_TO_ADDRESS(mod->labels[jump->label]);
 
@@ -2461,10 +2990,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     }
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_MAKE_FUN2: {
+            OPCODE_CASE(OP_MAKE_FUN2): {
                 int next_off = 1;
                 int fun_index;
                 DECODE_LABEL(fun_index, code, i, next_off, next_off)
@@ -2480,11 +3009,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
 
             }
 
-            case OP_TRY: {
+            OPCODE_CASE(OP_TRY): {
                 int next_off = 1;
                 int dreg;
                 uint8_t dreg_type;
@@ -2501,10 +3030,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_TRY_END: {
+            OPCODE_CASE(OP_TRY_END): {
                 int next_off = 1;
                 int dreg;
                 uint8_t dreg_type;
@@ -2518,11 +3047,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
             //TODO: implement
-            case OP_TRY_CASE: {
+            OPCODE_CASE(OP_TRY_CASE): {
                 int next_off = 1;
                 int dreg;
                 uint8_t dreg_type;
@@ -2531,10 +3060,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 TRACE("try_case/1, reg=%c%i\n", reg_type_c(dreg_type), dreg);
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_TRY_CASE_END: {
+            OPCODE_CASE(OP_TRY_CASE_END): {
                 #ifdef IMPL_EXECUTE_LOOP
                     if (UNLIKELY(memory_ensure_free(ctx, 3) != MEMORY_GC_OK)) {
                         RAISE_ERROR(out_of_memory_atom);
@@ -2568,63 +3097,69 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_APPLY: {
+            OPCODE_CASE(OP_APPLY): {
                 int next_off = 1;
                 int arity;
-                DECODE_INTEGER(arity, code, i, next_off, next_off)
+                unsigned int call_site;
+                DECODE_CALL_SITE_ARITY(arity, call_site, code, i, next_off, next_off)
 #ifdef IMPL_EXECUTE_LOOP
                 term module = ctx->x[arity];
                 term function = ctx->x[arity+1];
                 TRACE("apply/1, module=%lu, function=%lu arity=%i\n", module, function, arity);
 
-                remaining_reductions--;
-                if (UNLIKELY(!remaining_reductions)) {
+                ctx->remaining_reductions--;
+                if (UNLIKELY(ctx->remaining_reductions <= 0)) {
                     SCHEDULE_NEXT(mod, INSTRUCTION_POINTER());
                     continue;
                 }
                 NEXT_INSTRUCTION(next_off);
 
-                AtomString module_name = globalcontext_atomstring_from_term(mod->global, module);
-                AtomString function_name = globalcontext_atomstring_from_term(mod->global, function);
+                TRACE_APPLY(ctx, "apply", globalcontext_atomstring_from_term(mod->global, module),
+                    globalcontext_atomstring_from_term(mod->global, function), arity);
 
-                TRACE_APPLY(ctx, "apply", module_name, function_name, arity);
+                struct CallSiteCache *cache = &mod->call_site_caches[call_site];
+                const struct CallSiteCacheEntry *target = module_call_site_cache_lookup(cache, module, function);
+                if (UNLIKELY(!target)) {
+                    target = module_call_site_cache_resolve(mod, cache, module, function, arity);
+                    if (IS_NULL_PTR(target)) {
+                        RAISE_EXCEPTION();
+                    }
+                }
 
-                struct Nif *nif = (struct Nif *) nifs_get(module_name, function_name, arity);
-                if (!IS_NULL_PTR(nif)) {
-                    term return_value = nif->nif_ptr(ctx, arity, ctx->x);
+                if (target->nif) {
+                    term return_value = target->nif->nif_ptr(ctx, arity, ctx->x);
                     if (UNLIKELY(term_is_invalid_term(return_value))) {
+                        if (ctx->trap_nif) {
+                            TRAP_NIF(module_address(mod->module_index, i));
+                            continue;
+                        }
                         RAISE_EXCEPTION();
                     }
                     ctx->x[0] = return_value;
                 } else {
-                    Module *target_module = globalcontext_get_module(ctx->global, module_name);
-                    if (IS_NULL_PTR(target_module)) {
-                        RAISE_EXCEPTION();
-                    }
-                    int target_label = module_search_exported_function(target_module, function_name, arity);
-                    if (target_label == 0) {
-                        RAISE_EXCEPTION();
-                    }
                     ctx->cp = module_address(mod->module_index, i);
-                    mod = target_module;
-                    code = mod->code->code;
-                    JUMP_TO_ADDRESS(mod->labels[target_label]);
+                    PROFILE_CALL(target->target_module, target->target_module->labels[target->target_label]);
+                    mod = target->target_module;
+                    code = mod->instructions;
+                    JUMP_TO_ADDRESS(mod->labels[target->target_label]);
                 }
 #endif
 #ifdef IMPL_CODE_LOADER
                 TRACE("apply/1 arity=%i\n", arity);
+                UNUSED(call_site);
                 NEXT_INSTRUCTION(next_off);
 #endif
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_APPLY_LAST: {
+            OPCODE_CASE(OP_APPLY_LAST): {
                 int next_off = 1;
                 int arity;
-                DECODE_INTEGER(arity, code, i, next_off, next_off)
+                unsigned int call_site;
+                DECODE_CALL_SITE_ARITY(arity, call_site, code, i, next_off, next_off)
                 int n_words;
                 DECODE_INTEGER(n_words, code, i, next_off, next_off);
 #ifdef IMPL_EXECUTE_LOOP
@@ -2632,8 +3167,8 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 term function = ctx->x[arity+1];
                 TRACE("apply_last/1, module=%lu, function=%lu arity=%i deallocate=%i\n", module, function, arity, n_words);
 
-                remaining_reductions--;
-                if (UNLIKELY(!remaining_reductions)) {
+                ctx->remaining_reductions--;
+                if (UNLIKELY(ctx->remaining_reductions <= 0)) {
                     SCHEDULE_NEXT(mod, INSTRUCTION_POINTER());
                     continue;
                 }
@@ -2641,41 +3176,47 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 ctx->cp = ctx->e[n_words];
                 ctx->e += (n_words + 1);
 
-                AtomString module_name = globalcontext_atomstring_from_term(mod->global, module);
-                AtomString function_name = globalcontext_atomstring_from_term(mod->global, function);
+                TRACE_APPLY(ctx, "apply_last", globalcontext_atomstring_from_term(mod->global, module),
+                    globalcontext_atomstring_from_term(mod->global, function), arity);
 
-                TRACE_APPLY(ctx, "apply_last", module_name, function_name, arity);
+                struct CallSiteCache *cache = &mod->call_site_caches[call_site];
+                const struct CallSiteCacheEntry *target = module_call_site_cache_lookup(cache, module, function);
+                if (UNLIKELY(!target)) {
+                    target = module_call_site_cache_resolve(mod, cache, module, function, arity);
+                    if (IS_NULL_PTR(target)) {
+                        RAISE_EXCEPTION();
+                    }
+                }
 
-                struct Nif *nif = (struct Nif *) nifs_get(module_name, function_name, arity);
-                if (!IS_NULL_PTR(nif)) {
-                    term return_value = nif->nif_ptr(ctx, arity, ctx->x);
+                if (target->nif) {
+                    term return_value = target->nif->nif_ptr(ctx, arity, ctx->x);
                     if (UNLIKELY(term_is_invalid_term(return_value))) {
+                        if (ctx->trap_nif) {
+                            PROFILE_RETURN();
+                            TRAP_NIF(ctx->cp);
+                            continue;
+                        }
                         RAISE_EXCEPTION();
                     }
                     ctx->x[0] = return_value;
+                    PROFILE_RETURN();
                     DO_RETURN();
                 } else {
-                    Module *target_module = globalcontext_get_module(ctx->global, module_name);
-                    if (IS_NULL_PTR(target_module)) {
-                        RAISE_EXCEPTION();
-                    }
-                    int target_label = module_search_exported_function(target_module, function_name, arity);
-                    if (target_label == 0) {
-                        RAISE_EXCEPTION();
-                    }
-                    mod = target_module;
-                    code = mod->code->code;
-                    JUMP_TO_ADDRESS(mod->labels[target_label]);
+                    PROFILE_TAIL_CALL(target->target_module, target->target_module->labels[target->target_label]);
+                    mod = target->target_module;
+                    code = mod->instructions;
+                    JUMP_TO_ADDRESS(mod->labels[target->target_label]);
                 }
 #endif
 #ifdef IMPL_CODE_LOADER
                 TRACE("apply_last/1 arity=%i deallocate=%i\n", arity, n_words);
+                UNUSED(call_site);
                 NEXT_INSTRUCTION(next_off);
 #endif
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_BOOLEAN: {
+            OPCODE_CASE(OP_IS_BOOLEAN): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -2705,10 +3246,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_FUNCTION2: {
+            OPCODE_CASE(OP_IS_FUNCTION2): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -2749,10 +3290,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_GC_BIF1: {
+            OPCODE_CASE(OP_GC_BIF1): {
                 int next_off = 1;
                 int f_label;
                 DECODE_LABEL(f_label, code, i, next_off, next_off);
@@ -2770,7 +3311,9 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     TRACE("gc_bif1/5 fail_lbl=%i, live=%i, bif=%i, arg1=0x%lx, dest=r%i\n", f_label, live, bif, arg1, dreg);
 
                     GCBifImpl1 func = (GCBifImpl1) mod->imported_funcs[bif].bif;
+                    PROFILE_NATIVE_BEGIN();
                     term ret = func(ctx, live, arg1);
+                    PROFILE_NATIVE_END(bif);
                     if (UNLIKELY(term_is_invalid_term(ret))) {
                         RAISE_EXCEPTION();
                     }
@@ -2791,10 +3334,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 UNUSED(f_label)
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_GC_BIF2: {
+            OPCODE_CASE(OP_GC_BIF2): {
                 int next_off = 1;
                 int f_label;
                 DECODE_LABEL(f_label, code, i, next_off, next_off);
@@ -2814,7 +3357,9 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     TRACE("gc_bif2/6 fail_lbl=%i, live=%i, bif=%i, arg1=0x%lx, arg2=0x%lx, dest=r%i\n", f_label, live, bif, arg1, arg2, dreg);
 
                     GCBifImpl2 func = (GCBifImpl2) mod->imported_funcs[bif].bif;
+                    PROFILE_NATIVE_BEGIN();
                     term ret = func(ctx, live, arg1, arg2);
+                    PROFILE_NATIVE_END(bif);
                     if (UNLIKELY(term_is_invalid_term(ret))) {
                         RAISE_EXCEPTION();
                     }
@@ -2836,10 +3381,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 UNUSED(f_label)
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_TRIM: {
+            OPCODE_CASE(OP_TRIM): {
                 int next_offset = 1;
                 int n_words;
                 DECODE_INTEGER(n_words, code, i, next_offset, next_offset);
@@ -2859,12 +3404,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 UNUSED(n_remaining)
 
                 NEXT_INSTRUCTION(next_offset);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            //TODO: stub, implement recv_mark/1
-            //it looks like it can be safely left unimplemented
-            case OP_RECV_MARK: {
+            OPCODE_CASE(OP_RECV_MARK): {
                 int next_offset = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_offset, next_offset);
@@ -2872,13 +3415,15 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 TRACE("recv_mark/1 label=%i\n", label);
                 USED_BY_TRACE(label);
 
+                #ifdef IMPL_EXECUTE_LOOP
+                    mailbox_mark(ctx, mod->labels[label]);
+                #endif
+
                 NEXT_INSTRUCTION(next_offset);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            //TODO: stub, implement recv_set/1
-            //it looks like it can be safely left unimplemented
-            case OP_RECV_SET: {
+            OPCODE_CASE(OP_RECV_SET): {
                 int next_offset = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_offset, next_offset);
@@ -2886,22 +3431,30 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 TRACE("recv_set/1 label=%i\n", label);
                 USED_BY_TRACE(label);
 
+                #ifdef IMPL_EXECUTE_LOOP
+                    mailbox_set_to_mark(ctx, mod->labels[label]);
+                #endif
+
                 NEXT_INSTRUCTION(next_offset);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_LINE: {
+            OPCODE_CASE(OP_LINE): {
                 int next_offset = 1;
                 int line_number;
                 DECODE_INTEGER(line_number, code, i, next_offset, next_offset);
 
                 TRACE("line/1: %i\n", line_number);
 
+                #ifdef IMPL_CODE_LOADER
+                    ii = instruction_ii;
+                #endif
+
                 NEXT_INSTRUCTION(next_offset);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_IS_TAGGED_TUPLE: {
+            OPCODE_CASE(OP_IS_TAGGED_TUPLE): {
                 int next_off = 1;
                 int label;
                 DECODE_LABEL(label, code, i, next_off, next_off)
@@ -2909,13 +3462,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 DECODE_COMPACT_TERM(arg1, code, i, next_off, next_off)
                 int arity;
                 DECODE_INTEGER(arity, code, i, next_off, next_off)
-                int tag_atom_id;
-                DECODE_ATOM(tag_atom_id, code, i, next_off, next_off)
+                term tag_atom;
+                DECODE_ATOM(tag_atom, code, i, next_off, next_off)
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    TRACE("is_tagged_tuple/2, label=%i, arg1=%lx, arity=%i, atom_id=%i\n", label, arg1, arity, tag_atom_id);
-
-                    term tag_atom = module_get_atom_term_by_id(mod, tag_atom_id);
+                    TRACE("is_tagged_tuple/2, label=%i, arg1=%lx, arity=%i, tag_atom=%lx\n", label, arg1, arity, tag_atom);
 
                     if (term_is_tuple(arg1) && (term_get_tuple_arity(arg1) == arity) && (term_get_tuple_element(arg1, 0) == tag_atom)) {
                         NEXT_INSTRUCTION(next_off);
@@ -2931,11 +3482,11 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
 #ifdef ENABLE_OTP21
-            case OP_GET_HD: {
+            OPCODE_CASE(OP_GET_HD): {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
@@ -2957,10 +3508,10 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 
-            case OP_GET_TL: {
+            OPCODE_CASE(OP_GET_TL): {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
@@ -2982,12 +3533,280 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 #endif
 
                 NEXT_INSTRUCTION(next_off);
-                break;
+                DISPATCH_NEXT_INSTRUCTION();
             }
 #endif
 
+#ifdef IMPL_EXECUTE_LOOP
+            OPCODE_CASE(OP_IS_TAGGED_TUPLE_GET_TUPLE_ELEMENT): {
+                int next_off = 1;
+                int label;
+                DECODE_LABEL(label, code, i, next_off, next_off)
+                term arg1;
+                DECODE_COMPACT_TERM(arg1, code, i, next_off, next_off)
+                int arity;
+                DECODE_INTEGER(arity, code, i, next_off, next_off)
+                term tag_atom;
+                DECODE_ATOM(tag_atom, code, i, next_off, next_off)
+
+                TRACE("is_tagged_tuple/2+get_tuple_element/3, label=%i, arg1=%lx, arity=%i, tag_atom=%lx\n", label, arg1, arity, tag_atom);
+
+                if (!(term_is_tuple(arg1) && (term_get_tuple_arity(arg1) == arity) && (term_get_tuple_element(arg1, 0) == tag_atom))) {
+                    i = POINTER_TO_II(mod->labels[label]);
+                    break;
+                }
+
+                term src_value;
+                DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off);
+                int element;
+                DECODE_INTEGER(element, code, i, next_off, next_off);
+                int dreg;
+                uint8_t dreg_type;
+                DECODE_DEST_REGISTER(dreg, dreg_type, code, i, next_off, next_off);
+
+                WRITE_REGISTER(dreg_type, dreg, term_get_tuple_element(src_value, element));
+
+                NEXT_INSTRUCTION(next_off);
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+            OPCODE_CASE(OP_TEST_HEAP_PUT_LIST): {
+                int next_off = 1;
+                unsigned int heap_need;
+                DECODE_INTEGER(heap_need, code, i, next_off, next_off);
+                int live_registers;
+                DECODE_INTEGER(live_registers, code, i, next_off, next_off);
+
+                TRACE("test_heap/2+put_list/3 heap_need=%i, live_registers=%i\n", heap_need, live_registers);
+
+                if ((context_avail_free_memory(ctx) < heap_need) || (context_avail_free_memory(ctx) > heap_need * HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF)) {
+                    context_clean_registers(ctx, live_registers);
+                    if (UNLIKELY(memory_ensure_free_opt(ctx, heap_need, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
+                        RAISE_ERROR(out_of_memory_atom);
+                    }
+                }
+
+                // put_list operands must be decoded after garbage collection
+                term head;
+                DECODE_COMPACT_TERM(head, code, i, next_off, next_off);
+                term tail;
+                DECODE_COMPACT_TERM(tail, code, i, next_off, next_off);
+                int dreg;
+                uint8_t dreg_type;
+                DECODE_DEST_REGISTER(dreg, dreg_type, code, i, next_off, next_off);
+
+                term *list_elem = term_list_alloc(ctx);
+                WRITE_REGISTER(dreg_type, dreg, term_list_init_prepend(list_elem, head, tail));
+
+                NEXT_INSTRUCTION(next_off);
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+            OPCODE_CASE(OP_MOVE_CALL_ONLY): {
+                int next_off = 1;
+                term src_value;
+                DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off);
+                int dreg;
+                uint8_t dreg_type;
+                DECODE_DEST_REGISTER(dreg, dreg_type, code, i, next_off, next_off);
+                int arity;
+                DECODE_INTEGER(arity, code, i, next_off, next_off);
+                int label;
+                DECODE_LABEL(label, code, i, next_off, next_off)
+
+                TRACE("move/2+call_only/2 %lx, %c%i, arity=%i, label=%i\n", src_value, reg_type_c(dreg_type), dreg, arity, label);
+                USED_BY_TRACE(arity);
+
+                WRITE_REGISTER(dreg_type, dreg, src_value);
+
+                NEXT_INSTRUCTION(next_off);
+                PROFILE_TAIL_CALL(mod, mod->labels[label]);
+                ctx->remaining_reductions--;
+                if (LIKELY(ctx->remaining_reductions > 0)) {
+                    TRACE_CALL(ctx, mod, "call_only", label, arity);
+                    JUMP_TO_ADDRESS(mod->labels[label]);
+                } else {
+                    SCHEDULE_NEXT(mod, mod->labels[label]);
+                }
+
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+            OPCODE_CASE(OP_IS_NONEMPTY_LIST_GET_LIST): {
+                int next_off = 1;
+                int label;
+                DECODE_LABEL(label, code, i, next_off, next_off)
+                term arg1;
+                DECODE_COMPACT_TERM(arg1, code, i, next_off, next_off)
+
+                TRACE("is_nonempty_list/2+get_list/3, label=%i, arg1=%lx\n", label, arg1);
+
+                if (!term_is_nonempty_list(arg1)) {
+                    i = POINTER_TO_II(mod->labels[label]);
+                    break;
+                }
+
+                term src_value;
+                DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
+                int head_dreg;
+                uint8_t head_dreg_type;
+                DECODE_DEST_REGISTER(head_dreg, head_dreg_type, code, i, next_off, next_off);
+                int tail_dreg;
+                uint8_t tail_dreg_type;
+                DECODE_DEST_REGISTER(tail_dreg, tail_dreg_type, code, i, next_off, next_off);
+
+                term head = term_get_list_head(src_value);
+                term tail = term_get_list_tail(src_value);
+
+                WRITE_REGISTER(head_dreg_type, head_dreg, head);
+                WRITE_REGISTER(tail_dreg_type, tail_dreg, tail);
+
+                NEXT_INSTRUCTION(next_off);
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+            OPCODE_CASE(OP_MOVE_RETURN): {
+                int next_off = 1;
+                term src_value;
+                DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off);
+                int dreg;
+                uint8_t dreg_type;
+                DECODE_DEST_REGISTER(dreg, dreg_type, code, i, next_off, next_off);
+
+                TRACE("move/2+return/0 %lx, %c%i\n", src_value, reg_type_c(dreg_type), dreg);
+
+                WRITE_REGISTER(dreg_type, dreg, src_value);
+
+                TRACE_RETURN(ctx);
+                PROFILE_RETURN();
+
+                if ((long) ctx->cp == -1) {
+                    return 0;
+                }
+
+                DO_RETURN();
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+            OPCODE_CASE(OP_SELECT_VAL_BINARY_SEARCH): {
+                int next_off = 1;
+                term src_value;
+                DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
+                int default_label;
+                DECODE_LABEL(default_label, code, i, next_off, next_off)
+                int size;
+                DECODE_INTEGER(size, code, i, next_off, next_off)
+
+                TRACE("select_val/3 (binary search), default_label=%i, vals=%i\n", default_label, size);
+
+                int label = select_binary_search(&code[i + next_off], size / 2, src_value, default_label);
+                JUMP_TO_ADDRESS(mod->labels[label]);
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+            OPCODE_CASE(OP_SELECT_VAL_JUMP_TABLE): {
+                int next_off = 1;
+                term src_value;
+                DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
+                int default_label;
+                DECODE_LABEL(default_label, code, i, next_off, next_off)
+                int size;
+                DECODE_INTEGER(size, code, i, next_off, next_off)
+
+                TRACE("select_val/3 (jump table), default_label=%i, vals=%i\n", default_label, size);
+
+                // values are sorted and contiguous, so the first one is used as base
+                const term *pairs = &code[i + next_off];
+                int label = default_label;
+                if (term_is_integer(src_value)) {
+                    int64_t index = (int64_t) term_to_int32(src_value) - (int64_t) term_to_int32(pairs[0]);
+                    if ((index >= 0) && (index < size / 2) && (pairs[index * 2] == src_value)) {
+                        label = pairs[index * 2 + 1];
+                    }
+                }
+                JUMP_TO_ADDRESS(mod->labels[label]);
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+            OPCODE_CASE(OP_SELECT_TUPLE_ARITY_BINARY_SEARCH): {
+                int next_off = 1;
+                term src_value;
+                DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
+                int default_label;
+                DECODE_LABEL(default_label, code, i, next_off, next_off)
+                int size;
+                DECODE_INTEGER(size, code, i, next_off, next_off)
+
+                TRACE("select_tuple_arity/3 (binary search), default_label=%i, vals=%i\n", default_label, size);
+
+                int label = select_binary_search(&code[i + next_off], size / 2, term_get_tuple_arity(src_value), default_label);
+                JUMP_TO_ADDRESS(mod->labels[label]);
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+            OPCODE_CASE(OP_SELECT_TUPLE_ARITY_JUMP_TABLE): {
+                int next_off = 1;
+                term src_value;
+                DECODE_COMPACT_TERM(src_value, code, i, next_off, next_off)
+                int default_label;
+                DECODE_LABEL(default_label, code, i, next_off, next_off)
+                int size;
+                DECODE_INTEGER(size, code, i, next_off, next_off)
+
+                TRACE("select_tuple_arity/3 (jump table), default_label=%i, vals=%i\n", default_label, size);
+
+                const term *pairs = &code[i + next_off];
+                int label = default_label;
+                term index = term_get_tuple_arity(src_value) - pairs[0];
+                if (index < (term) (size / 2)) {
+                    label = pairs[index * 2 + 1];
+                }
+                JUMP_TO_ADDRESS(mod->labels[label]);
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+            OPCODE_CASE(OP_INT_TRAP_RESUME): {
+                TRACE("int_trap_resume/0, argc=%i\n", ctx->trap_argc);
+
+                NifImpl continuation = ctx->trap_nif;
+                ctx->trap_nif = NULL;
+                term return_value = continuation(ctx, ctx->trap_argc, ctx->x);
+                if (UNLIKELY(term_is_invalid_term(return_value))) {
+                    if (ctx->trap_nif) {
+                        // trapped again, trap_cp is left untouched
+                        SCHEDULE_NEXT(mod, INSTRUCTION_POINTER());
+                        continue;
+                    }
+                    RAISE_EXCEPTION();
+                }
+                ctx->x[0] = return_value;
+
+                if ((long) ctx->trap_cp == -1) {
+                    return 0;
+                }
+                mod = mod->global->modules_by_index[ctx->trap_cp >> 24];
+                code = mod->instructions;
+                i = (ctx->trap_cp & 0xFFFFFF) >> 2;
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+
+#ifdef ENABLE_JIT
+            OPCODE_CASE(OP_INT_NATIVE): {
+                NativeCode native_code = (NativeCode) code[i + 1];
+
+                TRACE("int_native/1 %p\n", (void *) native_code);
+
+                // native code never leaves the current module, it returns where the interpreter continues
+                i = native_code(ctx);
+                DISPATCH_NEXT_INSTRUCTION();
+            }
+#endif
+#endif
+
             default:
-                printf("Undecoded opcode: %i\n", code[i]);
+            #ifdef USE_COMPUTED_GOTO
+            undecoded_opcode:
+            #endif
+                printf("Undecoded opcode: %i\n", (int) code[i]);
                 #ifdef IMPL_EXECUTE_LOOP
                     fprintf(stderr, "failed at %i\n", i);
                 #endif
@@ -2995,6 +3814,20 @@ static const char *const out_of_memory_atom = "\xD" "out_of_memory";
                 abort();
                 return 1;
         }
+
+        #ifdef IMPL_CODE_LOADER
+            if (fused_opcode) {
+                // fused instructions are not fused again
+                last_opcode = 0;
+            } else if (ii > instruction_ii) {
+                last_opcode = opcode;
+                last_instruction_ii = instruction_ii;
+                #ifdef ENABLE_JIT
+                    jit_add_instruction(mod, instruction_ii, jump_target);
+                    jump_target = 0;
+                #endif
+            }
+        #endif
     }
 }
 
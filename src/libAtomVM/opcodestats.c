@@ -0,0 +1,332 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "opcodestats.h"
+
+#include <stdlib.h>
+
+#include "memory.h"
+#include "opcodes.h"
+#include "utils.h"
+
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+#if !defined(__x86_64__) && !defined(__i386__)
+#include <time.h>
+#endif
+#endif
+
+struct OpcodePairCount
+{
+    uint64_t count;
+    uint8_t first_opcode;
+    uint8_t second_opcode;
+};
+
+static const char *const opcode_names[OPCODE_STATS_SIZE] = {
+    [OP_LABEL] = "label",
+    [OP_FUNC_INFO] = "func_info",
+    [OP_INT_CALL_END] = "int_call_end",
+    [OP_CALL] = "call",
+    [OP_CALL_LAST] = "call_last",
+    [OP_CALL_ONLY] = "call_only",
+    [OP_CALL_EXT] = "call_ext",
+    [OP_CALL_EXT_LAST] = "call_ext_last",
+    [OP_BIF0] = "bif0",
+    [OP_BIF1] = "bif1",
+    [OP_BIF2] = "bif2",
+    [OP_ALLOCATE] = "allocate",
+    [OP_ALLOCATE_HEAP] = "allocate_heap",
+    [OP_ALLOCATE_ZERO] = "allocate_zero",
+    [OP_ALLOCATE_HEAP_ZERO] = "allocate_heap_zero",
+    [OP_TEST_HEAP] = "test_heap",
+    [OP_KILL] = "kill",
+    [OP_DEALLOCATE] = "deallocate",
+    [OP_RETURN] = "return",
+    [OP_SEND] = "send",
+    [OP_REMOVE_MESSAGE] = "remove_message",
+    [OP_TIMEOUT] = "timeout",
+    [OP_LOOP_REC] = "loop_rec",
+    [OP_LOOP_REC_END] = "loop_rec_end",
+    [OP_WAIT] = "wait",
+    [OP_WAIT_TIMEOUT] = "wait_timeout",
+    [OP_IS_LT] = "is_lt",
+    [OP_IS_GE] = "is_ge",
+    [OP_IS_EQUAL] = "is_equal",
+    [OP_IS_NOT_EQUAL] = "is_not_equal",
+    [OP_IS_EQ_EXACT] = "is_eq_exact",
+    [OP_IS_NOT_EQ_EXACT] = "is_not_eq_exact",
+    [OP_IS_INTEGER] = "is_integer",
+    [OP_IS_NUMBER] = "is_number",
+    [OP_IS_ATOM] = "is_atom",
+    [OP_IS_PID] = "is_pid",
+    [OP_IS_REFERENCE] = "is_reference",
+    [OP_IS_PORT] = "is_port",
+    [OP_IS_NIL] = "is_nil",
+    [OP_IS_BINARY] = "is_binary",
+    [OP_IS_LIST] = "is_list",
+    [OP_IS_NONEMPTY_LIST] = "is_nonempty_list",
+    [OP_IS_TUPLE] = "is_tuple",
+    [OP_TEST_ARITY] = "test_arity",
+    [OP_SELECT_VAL] = "select_val",
+    [OP_SELECT_TUPLE_ARITY] = "select_tuple_arity",
+    [OP_JUMP] = "jump",
+    [OP_MOVE] = "move",
+    [OP_GET_LIST] = "get_list",
+    [OP_GET_TUPLE_ELEMENT] = "get_tuple_element",
+    [OP_SET_TUPLE_ELEMENT] = "set_tuple_element",
+    [OP_PUT_LIST] = "put_list",
+    [OP_PUT_TUPLE] = "put_tuple",
+    [OP_PUT] = "put",
+    [OP_BADMATCH] = "badmatch",
+    [OP_IF_END] = "if_end",
+    [OP_CASE_END] = "case_end",
+    [OP_CALL_FUN] = "call_fun",
+    [OP_IS_FUNCTION] = "is_function",
+    [OP_CALL_EXT_ONLY] = "call_ext_only",
+    [OP_MAKE_FUN2] = "make_fun2",
+    [OP_TRY] = "try",
+    [OP_TRY_END] = "try_end",
+    [OP_TRY_CASE] = "try_case",
+    [OP_TRY_CASE_END] = "try_case_end",
+    [OP_APPLY] = "apply",
+    [OP_APPLY_LAST] = "apply_last",
+    [OP_IS_BOOLEAN] = "is_boolean",
+    [OP_IS_FUNCTION2] = "is_function2",
+    [OP_GC_BIF1] = "gc_bif1",
+    [OP_GC_BIF2] = "gc_bif2",
+    [OP_TRIM] = "trim",
+    [OP_RECV_MARK] = "recv_mark",
+    [OP_RECV_SET] = "recv_set",
+    [OP_LINE] = "line",
+    [OP_IS_TAGGED_TUPLE] = "is_tagged_tuple",
+    [OP_GET_HD] = "get_hd",
+    [OP_GET_TL] = "get_tl",
+    SUPERINSTRUCTION_NAMES
+    [OP_SELECT_VAL_BINARY_SEARCH] = "select_val_binary_search",
+    [OP_SELECT_VAL_JUMP_TABLE] = "select_val_jump_table",
+    [OP_SELECT_TUPLE_ARITY_BINARY_SEARCH] = "select_tuple_arity_binary_search",
+    [OP_SELECT_TUPLE_ARITY_JUMP_TABLE] = "select_tuple_arity_jump_table",
+    [OP_INT_TRAP_RESUME] = "int_trap_resume",
+    [OP_INT_NATIVE] = "int_native",
+};
+
+struct OpcodeStats *opcodestats_new()
+{
+    return calloc(1, sizeof(struct OpcodeStats));
+}
+
+void opcodestats_destroy(struct OpcodeStats *stats)
+{
+    free(stats);
+}
+
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+#if !defined(__x86_64__) && !defined(__i386__)
+uint64_t opcodestats_timestamp()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+#endif
+
+const char *opcodestats_opcode_name(int opcode)
+{
+    if ((opcode < 0) || (opcode >= OPCODE_STATS_SIZE)) {
+        return NULL;
+    }
+
+    return opcode_names[opcode];
+}
+
+term opcodestats_to_term(const struct OpcodeStats *stats, Context *ctx)
+{
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+    const int tuple_arity = 3;
+#else
+    const int tuple_arity = 2;
+#endif
+
+    int executed_count = 0;
+    for (int i = 0; i < OPCODE_STATS_SIZE; i++) {
+        if (stats->counts[i]) {
+            executed_count++;
+        }
+    }
+
+    if (UNLIKELY(memory_ensure_free(ctx, executed_count * (tuple_arity + 1 + 2)) != MEMORY_GC_OK)) {
+        return term_invalid_term();
+    }
+
+    term list = term_nil();
+    for (int i = OPCODE_STATS_SIZE - 1; i >= 0; i--) {
+        if (!stats->counts[i]) {
+            continue;
+        }
+        term stats_tuple = term_alloc_tuple(tuple_arity, ctx);
+        term_put_tuple_element(stats_tuple, 0, term_from_int32(i));
+        term_put_tuple_element(stats_tuple, 1, term_from_counter(stats->counts[i]));
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+        term_put_tuple_element(stats_tuple, 2, term_from_counter(stats->cycles[i]));
+#endif
+        list = term_list_prepend(stats_tuple, list, ctx);
+    }
+
+    return list;
+}
+
+#ifdef ENABLE_OPCODE_PROFILER_PAIRS
+term opcodestats_pairs_to_term(const struct OpcodeStats *stats, Context *ctx)
+{
+    int executed_count = 0;
+    for (int i = 0; i < OPCODE_STATS_SIZE; i++) {
+        for (int j = 0; j < OPCODE_STATS_SIZE; j++) {
+            if (stats->pair_counts[i][j]) {
+                executed_count++;
+            }
+        }
+    }
+
+    if (UNLIKELY(memory_ensure_free(ctx, executed_count * (3 + 3 + 2)) != MEMORY_GC_OK)) {
+        return term_invalid_term();
+    }
+
+    term list = term_nil();
+    for (int i = OPCODE_STATS_SIZE - 1; i >= 0; i--) {
+        for (int j = OPCODE_STATS_SIZE - 1; j >= 0; j--) {
+            if (!stats->pair_counts[i][j]) {
+                continue;
+            }
+            term pair_tuple = term_alloc_tuple(2, ctx);
+            term_put_tuple_element(pair_tuple, 0, term_from_int32(i));
+            term_put_tuple_element(pair_tuple, 1, term_from_int32(j));
+
+            term stats_tuple = term_alloc_tuple(2, ctx);
+            term_put_tuple_element(stats_tuple, 0, pair_tuple);
+            term_put_tuple_element(stats_tuple, 1, term_from_counter(stats->pair_counts[i][j]));
+            list = term_list_prepend(stats_tuple, list, ctx);
+        }
+    }
+
+    return list;
+}
+
+static int pair_count_compare(const void *a, const void *b)
+{
+    const struct OpcodePairCount *pair_a = a;
+    const struct OpcodePairCount *pair_b = b;
+
+    return (pair_a->count < pair_b->count) - (pair_a->count > pair_b->count);
+}
+#endif
+
+static void opcode_name_to_buf(int opcode, char *buf, int buf_size)
+{
+    const char *name = opcode_names[opcode];
+    if (name) {
+        snprintf(buf, buf_size, "%s", name);
+    } else {
+        snprintf(buf, buf_size, "opcode_%i", opcode);
+    }
+}
+
+void opcodestats_dump(const struct OpcodeStats *stats, FILE *out)
+{
+    uint64_t total_count = 0;
+    int sorted_opcodes[OPCODE_STATS_SIZE];
+    int executed_count = 0;
+
+    // sorted by count using insertion sort, there are just a few opcodes
+    for (int i = 0; i < OPCODE_STATS_SIZE; i++) {
+        if (!stats->counts[i]) {
+            continue;
+        }
+        total_count += stats->counts[i];
+        int j = executed_count - 1;
+        while ((j >= 0) && (stats->counts[sorted_opcodes[j]] < stats->counts[i])) {
+            sorted_opcodes[j + 1] = sorted_opcodes[j];
+            j--;
+        }
+        sorted_opcodes[j + 1] = i;
+        executed_count++;
+    }
+
+    fprintf(out, "# opcode name count percentage");
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+    fprintf(out, " cycles cycles_per_execution");
+#endif
+    fprintf(out, "\n");
+
+    for (int i = 0; i < executed_count; i++) {
+        int opcode = sorted_opcodes[i];
+        char name[64];
+        opcode_name_to_buf(opcode, name, sizeof(name));
+        fprintf(out, "%i %s %llu %.2f", opcode, name, (unsigned long long) stats->counts[opcode],
+            (stats->counts[opcode] * 100.0) / total_count);
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+        fprintf(out, " %llu %.1f", (unsigned long long) stats->cycles[opcode],
+            (double) stats->cycles[opcode] / stats->counts[opcode]);
+#endif
+        fprintf(out, "\n");
+    }
+
+#ifdef ENABLE_OPCODE_PROFILER_PAIRS
+    int pairs_count = 0;
+    for (int i = 0; i < OPCODE_STATS_SIZE; i++) {
+        for (int j = 0; j < OPCODE_STATS_SIZE; j++) {
+            if (stats->pair_counts[i][j]) {
+                pairs_count++;
+            }
+        }
+    }
+
+    struct OpcodePairCount *pairs = malloc(pairs_count * sizeof(struct OpcodePairCount));
+    if (IS_NULL_PTR(pairs)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        return;
+    }
+
+    int pair_index = 0;
+    for (int i = 0; i < OPCODE_STATS_SIZE; i++) {
+        for (int j = 0; j < OPCODE_STATS_SIZE; j++) {
+            if (stats->pair_counts[i][j]) {
+                pairs[pair_index].count = stats->pair_counts[i][j];
+                pairs[pair_index].first_opcode = i;
+                pairs[pair_index].second_opcode = j;
+                pair_index++;
+            }
+        }
+    }
+    qsort(pairs, pairs_count, sizeof(struct OpcodePairCount), pair_count_compare);
+
+    fprintf(out, "\n# first_opcode second_opcode first_name second_name count percentage\n");
+    for (int i = 0; i < pairs_count; i++) {
+        char first_name[64];
+        char second_name[64];
+        opcode_name_to_buf(pairs[i].first_opcode, first_name, sizeof(first_name));
+        opcode_name_to_buf(pairs[i].second_opcode, second_name, sizeof(second_name));
+        fprintf(out, "%i %i %s %s %llu %.2f\n", pairs[i].first_opcode, pairs[i].second_opcode, first_name, second_name,
+            (unsigned long long) pairs[i].count, (pairs[i].count * 100.0) / total_count);
+    }
+
+    free(pairs);
+#endif
+}
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+/**
+ * @file opcodestats.h
+ * @brief Per opcode execution counters.
+ *
+ * @details When AtomVM is built with ENABLE_OPCODE_PROFILER the execute loop counts how many times each opcode
+ * is executed. ENABLE_OPCODE_PROFILER_PAIRS also counts how many times each opcode is followed by another one and
+ * ENABLE_OPCODE_PROFILER_CYCLES accounts the time spent on each opcode (TSC cycles on x86, nanoseconds elsewhere).
+ */
+
+#ifndef _OPCODESTATS_H_
+#define _OPCODESTATS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+    #if defined(__x86_64__) || defined(__i386__)
+        #include <x86intrin.h>
+    #endif
+#endif
+
+#include "term.h"
+
+#ifndef TYPEDEF_CONTEXT
+#define TYPEDEF_CONTEXT
+typedef struct Context Context;
+#endif
+
+#define OPCODE_STATS_SIZE 256
+
+struct OpcodeStats
+{
+    uint64_t counts[OPCODE_STATS_SIZE];
+    int last_opcode;
+
+#ifdef ENABLE_OPCODE_PROFILER_PAIRS
+    uint64_t pair_counts[OPCODE_STATS_SIZE][OPCODE_STATS_SIZE];
+#endif
+
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+    uint64_t cycles[OPCODE_STATS_SIZE];
+    uint64_t last_timestamp;
+#endif
+};
+
+/**
+ * @brief Creates a new zeroed OpcodeStats struct.
+ *
+ * @returns a newly allocated OpcodeStats or NULL if memory cannot be allocated.
+ */
+struct OpcodeStats *opcodestats_new();
+
+/**
+ * @brief Frees an OpcodeStats struct.
+ *
+ * @param stats the struct that will be freed.
+ */
+void opcodestats_destroy(struct OpcodeStats *stats);
+
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t opcodestats_timestamp()
+{
+    return __rdtsc();
+}
+#else
+uint64_t opcodestats_timestamp();
+#endif
+#endif
+
+/**
+ * @brief Accounts an opcode that is going to be executed.
+ *
+ * @details This function is called by the execute loop before dispatching each instruction, so when cycles are
+ * enabled the time elapsed since the previous call is accounted to the previous opcode.
+ * @param stats the stats struct that will be updated.
+ * @param opcode the opcode that is going to be executed.
+ */
+static inline void opcodestats_sample(struct OpcodeStats *stats, int opcode)
+{
+    stats->counts[opcode]++;
+
+#ifdef ENABLE_OPCODE_PROFILER_PAIRS
+    if (stats->last_opcode) {
+        stats->pair_counts[stats->last_opcode][opcode]++;
+    }
+#endif
+
+#ifdef ENABLE_OPCODE_PROFILER_CYCLES
+    uint64_t timestamp = opcodestats_timestamp();
+    if (stats->last_timestamp) {
+        stats->cycles[stats->last_opcode] += timestamp - stats->last_timestamp;
+    }
+    stats->last_timestamp = timestamp;
+#endif
+
+    stats->last_opcode = opcode;
+}
+
+/**
+ * @brief Returns the name of an opcode.
+ *
+ * @param opcode an opcode number.
+ * @returns the lowercase opcode name or NULL if the opcode is not known.
+ */
+const char *opcodestats_opcode_name(int opcode);
+
+/**
+ * @brief Makes a list with execution stats of all executed opcodes.
+ *
+ * @details Returns a list of {Opcode, Count} tuples, or {Opcode, Count, Cycles} tuples when cycles are enabled.
+ * @param stats the opcode stats.
+ * @param ctx the context that owns the returned list.
+ * @returns the list or an invalid term if memory cannot be allocated.
+ */
+term opcodestats_to_term(const struct OpcodeStats *stats, Context *ctx);
+
+#ifdef ENABLE_OPCODE_PROFILER_PAIRS
+/**
+ * @brief Makes a list with execution counts of all executed opcode pairs.
+ *
+ * @details Returns a list of {{FirstOpcode, SecondOpcode}, Count} tuples.
+ * @param stats the opcode stats.
+ * @param ctx the context that owns the returned list.
+ * @returns the list or an invalid term if memory cannot be allocated.
+ */
+term opcodestats_pairs_to_term(const struct OpcodeStats *stats, Context *ctx);
+#endif
+
+/**
+ * @brief Writes a human readable report.
+ *
+ * @details Writes executed opcodes (and opcode pairs) sorted by execution count.
+ * @param stats the opcode stats.
+ * @param out the stream where the report is written.
+ */
+void opcodestats_dump(const struct OpcodeStats *stats, FILE *out);
+
+#endif
@@ -18,6 +18,7 @@
  ***************************************************************************/
 
 #include "debug.h"
+#include "functionprofiler.h"
 #include "list.h"
 #include "scheduler.h"
 #include "sys.h"
@@ -32,11 +33,33 @@ static int scheduler_find_min_timeout(const GlobalContext *global, struct timesp
 static inline int before_than(const struct timespec *a, const struct timespec *b);
 static int make_ready_expired_contexts(GlobalContext *global);
 
+static void scheduler_end_slice(Context *c)
+{
+    c->reductions += c->slice_reductions - c->remaining_reductions;
+    c->slice_reductions = c->remaining_reductions;
+}
+
+static void scheduler_begin_slice(GlobalContext *global, Context *c)
+{
+    c->remaining_reductions = global->reductions_per_slice;
+    c->slice_reductions = global->reductions_per_slice;
+
+    if (c->max_gc_pause) {
+        memory_incremental_gc_slice(c);
+    }
+}
+
 Context *scheduler_wait(GlobalContext *global, Context *c)
 {
     #ifdef DEBUG_PRINT_READY_PROCESSES
         debug_print_processes_list(global->ready_processes);
     #endif
+    #ifdef ENABLE_FUNCTION_PROFILER
+        if (UNLIKELY(global->function_profiler_enabled)) {
+            functionprofiler_schedule_out(c);
+        }
+    #endif
+    scheduler_end_slice(c);
     scheduler_make_waiting(global, c);
 
     do {
@@ -96,12 +119,26 @@ Context *scheduler_wait(GlobalContext *global, Context *c)
     list_remove(next_ready);
     list_append(&global->ready_processes, next_ready);
 
-    return GET_LIST_ENTRY(next_ready, Context, processes_list_head);
+    Context *next_context = GET_LIST_ENTRY(next_ready, Context, processes_list_head);
+    scheduler_begin_slice(global, next_context);
+    #ifdef ENABLE_FUNCTION_PROFILER
+        if (UNLIKELY(global->function_profiler_enabled)) {
+            functionprofiler_schedule_in(next_context);
+        }
+    #endif
+
+    return next_context;
 }
 
 Context *scheduler_next(GlobalContext *global, Context *c)
 {
-    c->reductions += DEFAULT_REDUCTIONS_AMOUNT;
+    scheduler_end_slice(c);
+
+    #ifdef ENABLE_FUNCTION_PROFILER
+        if (UNLIKELY(global->function_profiler_enabled)) {
+            functionprofiler_schedule_out(c);
+        }
+    #endif
 
     sys_consume_pending_events(global);
 
@@ -110,16 +147,25 @@ Context *scheduler_next(GlobalContext *global, Context *c)
     }
 
     //TODO: improve scheduling here
+    Context *scheduled_context = c;
     struct ListHead *item;
     struct ListHead *tmp;
     MUTABLE_LIST_FOR_EACH(item, tmp, &global->ready_processes) {
         Context *next_context = GET_LIST_ENTRY(item, Context, processes_list_head);
         if (!next_context->native_handler && (next_context != c)) {
-            return next_context;
+            scheduled_context = next_context;
+            break;
         }
     }
+    scheduler_begin_slice(global, scheduled_context);
+
+    #ifdef ENABLE_FUNCTION_PROFILER
+        if (UNLIKELY(global->function_profiler_enabled)) {
+            functionprofiler_schedule_in(scheduled_context);
+        }
+    #endif
 
-    return c;
+    return scheduled_context;
 }
 
 void scheduler_make_ready(GlobalContext *global, Context *c)
@@ -0,0 +1,30 @@
+// The pairs in this file have been picked by hand, as common pairs in compiler output: no opcode profile has been
+// collected for them yet. tools/dev/gen-superinstructions.sh replaces this file with the most executed pairs of an
+// opcode_stats.txt dump.
+
+#ifndef _SUPERINSTRUCTIONS_H_
+#define _SUPERINSTRUCTIONS_H_
+
+// Fused opcodes.
+#define OP_IS_TAGGED_TUPLE_GET_TUPLE_ELEMENT 240
+#define OP_TEST_HEAP_PUT_LIST 241
+#define OP_MOVE_CALL_ONLY 242
+#define OP_IS_NONEMPTY_LIST_GET_LIST 243
+#define OP_MOVE_RETURN 244
+
+// first opcode, second opcode, fused opcode
+#define SUPERINSTRUCTIONS \
+    { OP_IS_TAGGED_TUPLE, OP_GET_TUPLE_ELEMENT, OP_IS_TAGGED_TUPLE_GET_TUPLE_ELEMENT }, \
+    { OP_TEST_HEAP, OP_PUT_LIST, OP_TEST_HEAP_PUT_LIST }, \
+    { OP_MOVE, OP_CALL_ONLY, OP_MOVE_CALL_ONLY }, \
+    { OP_IS_NONEMPTY_LIST, OP_GET_LIST, OP_IS_NONEMPTY_LIST_GET_LIST }, \
+    { OP_MOVE, OP_RETURN, OP_MOVE_RETURN }, \
+
+#define SUPERINSTRUCTION_NAMES \
+    [OP_IS_TAGGED_TUPLE_GET_TUPLE_ELEMENT] = "is_tagged_tuple_get_tuple_element", \
+    [OP_TEST_HEAP_PUT_LIST] = "test_heap_put_list", \
+    [OP_MOVE_CALL_ONLY] = "move_call_only", \
+    [OP_IS_NONEMPTY_LIST_GET_LIST] = "is_nonempty_list_get_list", \
+    [OP_MOVE_RETURN] = "move_return", \
+
+#endif
@@ -51,6 +51,30 @@ struct EventListener {
     unsigned int one_shot : 1;
 };
 
+/**
+ * @brief a function that performs a dirty job
+ *
+ * @details it runs on a worker thread, so it must not access terms, contexts or the global context: any input
+ * should be copied into data before the job is submitted, and any result should be stored into data.
+ */
+typedef void (*dirty_job_run_t)(void *data);
+
+/**
+ * @brief a function that delivers the result of a dirty job
+ *
+ * @details it runs on the scheduler thread once the job has been performed, usually it sends a message using
+ * port_send_reply or mailbox_send, and it frees data.
+ */
+typedef void (*dirty_job_complete_t)(GlobalContext *glb, void *data);
+
+/**
+ * @brief a function that frees the data of a dirty job that is discarded
+ *
+ * @details it runs on the scheduler thread instead of the complete function, when dirty jobs are stopped before the
+ * job has been delivered.
+ */
+typedef void (*dirty_job_discard_t)(void *data);
+
 /**
  * @brief waits platform events
  *
@@ -67,6 +91,31 @@ void sys_waitevents(GlobalContext *glb);
  */
 void sys_consume_pending_events(GlobalContext *glb);
 
+/**
+ * @brief hands a blocking or long running job to a worker thread
+ *
+ * @details this function should be used by NIFs and port drivers for jobs such as file reads, compression, hashing
+ * or name resolution, so they do not stall all other processes. run is called on a worker thread, then complete is
+ * called from the scheduler when pending events are processed.
+ * @param glb the global context.
+ * @param run the function that performs the job.
+ * @param complete the function that delivers the result.
+ * @param discard the function that frees data when the job is discarded.
+ * @param data opaque data passed to all functions.
+ * @returns 1 if the job has been queued, 0 if it could not be queued and the caller should run it on its own.
+ */
+int sys_submit_dirty_job(GlobalContext *glb, dirty_job_run_t run, dirty_job_complete_t complete, dirty_job_discard_t discard, void *data);
+
+/**
+ * @brief stops the worker threads used for dirty jobs
+ *
+ * @details waits for running jobs to end and frees dirty jobs resources. Jobs that have not been completed yet are
+ * discarded: their complete functions are not called, since processes might have been already destroyed, and their
+ * discard functions are called instead.
+ * @param glb the global context.
+ */
+void sys_stop_dirty_jobs(GlobalContext *glb);
+
 /**
  * @brief sets the timestamp for a future event
  *
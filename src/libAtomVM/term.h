@@ -500,6 +500,28 @@ static inline term term_from_int64(int64_t value)
 #endif
 }
 
+/**
+ * @brief Term from a statistics counter
+ *
+ * @details Returns an integer term for a given counter value. Counters are saturated to the biggest integer that fits
+ * in a term, since there is no support for big integers.
+ * @param value the counter value that will be converted to a term.
+ * @return a term that encapsulates the counter value.
+ */
+static inline term term_from_counter(uint64_t value)
+{
+#if TERM_BITS == 32
+    const uint64_t max_value = 0x0FFFFFFF;
+#else
+    const uint64_t max_value = 0x0FFFFFFFFFFFFFFF;
+#endif
+    if (value > max_value) {
+        value = max_value;
+    }
+
+    return term_from_int64(value);
+}
+
 static inline term term_from_catch_label(unsigned int module_index, unsigned int label)
 {
     return (term) ((module_index << 24) | (label << 6) | TERM_CATCH_TAG);
@@ -536,15 +558,15 @@ static inline int term_binary_data_size_in_terms(uint32_t size)
 }
 
 /**
- * @brief Term from binary data
+ * @brief Allocates an uninitialized binary
  *
- * @details Allocates a binary on the heap, and returns a term pointing to it.
- * @param data binary data.
+ * @details Allocates a binary on the heap, and returns a term pointing to it. Binary data must be
+ * initialized by the caller using term_binary_data_mutable.
  * @param size size of binary data buffer.
  * @param ctx the context that owns the memory that will be allocated.
  * @return a term pointing to the boxed binary pointer.
  */
-static inline term term_from_literal_binary(const void *data, uint32_t size, Context *ctx)
+static inline term term_create_uninitialized_binary(uint32_t size, Context *ctx)
 {
     int size_in_terms = term_binary_data_size_in_terms(size);
 
@@ -552,11 +574,26 @@ static inline term term_from_literal_binary(const void *data, uint32_t size, Con
     boxed_value[0] = (size_in_terms << 6) | 0x24; // heap binary
     boxed_value[1] = size;
 
-    memcpy(boxed_value + 2, data, size);
-
     return ((term) boxed_value) | TERM_BOXED_VALUE_TAG;
 }
 
+/**
+ * @brief Term from binary data
+ *
+ * @details Allocates a binary on the heap, and returns a term pointing to it.
+ * @param data binary data.
+ * @param size size of binary data buffer.
+ * @param ctx the context that owns the memory that will be allocated.
+ * @return a term pointing to the boxed binary pointer.
+ */
+static inline term term_from_literal_binary(const void *data, uint32_t size, Context *ctx)
+{
+    term binary = term_create_uninitialized_binary(size, ctx);
+    memcpy(term_to_term_ptr(binary) + 2, data, size);
+
+    return binary;
+}
+
 /**
  * @brief Gets binary size
  *
@@ -591,6 +628,23 @@ static inline const char *term_binary_data(term t)
     }
 }
 
+/**
+ * @brief Gets mutable binary data
+ *
+ * @details Returns a pointer to stored binary data, it should be used only to fill a newly created binary.
+ * @param t a term pointing to binary data. Fails if t is not a binary term.
+ * @return a char * pointing to binary internal data.
+ */
+static inline char *term_binary_data_mutable(term t)
+{
+    term *boxed_value = term_to_term_ptr(t);
+    if (boxed_value[0] & 0x3F) {
+        return (char *) (boxed_value + 2);
+    } else {
+        abort();
+    }
+}
+
 /**
  * @brief Get a ref term from ref ticks
  *
@@ -839,6 +893,25 @@ static inline term term_list_prepend(term head, term tail, Context *ctx)
     return term_list_init_prepend(l, head, tail);
 }
 
+/**
+ * @brief Prepends a {Key, Value} tuple to an existing proplist
+ *
+ * @details Allocates a 2 elements tuple and a new list item, 5 terms are used.
+ * @param key the first tuple element.
+ * @param value the second tuple element.
+ * @param tail either nil or next list item.
+ * @param ctx the context that owns the memory that will be allocated.
+ * @return a term pointing to the newly created list item.
+ */
+static inline term term_list_prepend_pair(term key, term value, term tail, Context *ctx)
+{
+    term pair = term_alloc_tuple(2, ctx);
+    term_put_tuple_element(pair, 0, key);
+    term_put_tuple_element(pair, 1, value);
+
+    return term_list_prepend(pair, tail, ctx);
+}
+
 /**
  * @brief Returns list length
  *
@@ -35,6 +35,24 @@
 
 static const char *ok_a = "\x2" "ok";
 
+#ifdef ENABLE_OPCODE_PROFILER
+static void dump_opcode_stats(GlobalContext *glb)
+{
+    const char *stats_filename = getenv("AVM_OPCODE_STATS_FILE");
+    if (!stats_filename) {
+        stats_filename = "opcode_stats.txt";
+    }
+
+    FILE *stats_file = fopen(stats_filename, "w");
+    if (IS_NULL_PTR(stats_file)) {
+        fprintf(stderr, "Cannot write opcode stats to %s.\n", stats_filename);
+        return;
+    }
+    opcodestats_dump(glb->opcode_stats, stats_file);
+    fclose(stats_file);
+}
+#endif
+
 int main(int argc, char **argv)
 {
     if (argc < 2) {
@@ -47,6 +65,9 @@ int main(int argc, char **argv)
     }
 
     GlobalContext *glb = globalcontext_new();
+#ifdef ENABLE_JIT
+    glb->jit_modules = getenv("AVM_JIT_MODULES");
+#endif
 
     const void *startup_beam;
     uint32_t startup_beam_size;
@@ -80,6 +101,14 @@ int main(int argc, char **argv)
     }
     globalcontext_insert_module_with_filename(glb, mod, startup_module_name);
     mod->module_platform_data = NULL;
+
+#ifdef ENABLE_LINK_ON_LOAD
+    int unresolved_count = globalcontext_link_modules(glb);
+    if (unresolved_count) {
+        fprintf(stderr, "Warning: %i imported functions cannot be resolved.\n", unresolved_count);
+    }
+#endif
+
     Context *ctx = context_new(glb);
     ctx->leader = 1;
 
@@ -92,6 +121,10 @@ int main(int argc, char **argv)
 
     term ok_atom = context_make_atom(ctx, ok_a);
 
+#ifdef ENABLE_OPCODE_PROFILER
+    dump_opcode_stats(glb);
+#endif
+
     context_destroy(ctx);
     globalcontext_destroy(glb);
     module_destroy(mod);
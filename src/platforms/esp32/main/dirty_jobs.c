@@ -0,0 +1,273 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "sys.h"
+#include "esp32_sys.h"
+
+#include "list.h"
+#include "utils.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "trace.h"
+
+#ifndef DIRTY_JOBS_WORKERS
+    #define DIRTY_JOBS_WORKERS 2
+#endif
+#define DIRTY_JOBS_QUEUE_LEN 16
+#define DIRTY_JOBS_WORKER_STACK_SIZE 4096
+#define DIRTY_JOBS_WORKER_PRIORITY (tskIDLE_PRIORITY + 1)
+
+struct DirtyJob
+{
+    struct ListHead jobs_list_head;
+
+    dirty_job_run_t run;
+    dirty_job_complete_t complete;
+    dirty_job_discard_t discard;
+    void *data;
+};
+
+struct DirtyJobs
+{
+    xQueueHandle queued_jobs;
+
+    // completed_jobs and wakeup_pending are shared with worker tasks and protected by mutex
+    SemaphoreHandle_t mutex;
+    struct ListHead completed_jobs;
+    int wakeup_pending;
+
+    int workers_count;
+    // given by each worker when it exits
+    SemaphoreHandle_t stopped_workers;
+
+    // workers post event_descriptor to event_queue when a job is completed
+    int event_descriptor;
+
+    // the listener is registered only while there are pending jobs, so hang detection keeps working
+    EventListener listener;
+    int listening;
+    int pending_jobs;
+};
+
+static void dirty_jobs_worker(void *arg)
+{
+    struct DirtyJobs *dirty_jobs = (struct DirtyJobs *) arg;
+
+    while (1) {
+        struct DirtyJob *job;
+        if (xQueueReceive(dirty_jobs->queued_jobs, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        // a NULL job is queued by sys_stop_dirty_jobs
+        if (!job) {
+            break;
+        }
+
+        job->run(job->data);
+
+        xSemaphoreTake(dirty_jobs->mutex, portMAX_DELAY);
+        list_append(&dirty_jobs->completed_jobs, &job->jobs_list_head);
+        int wakeup = !dirty_jobs->wakeup_pending;
+        dirty_jobs->wakeup_pending = 1;
+        xSemaphoreGive(dirty_jobs->mutex);
+
+        if (wakeup) {
+            xQueueSend(event_queue, &dirty_jobs->event_descriptor, portMAX_DELAY);
+        }
+    }
+
+    xSemaphoreGive(dirty_jobs->stopped_workers);
+    vTaskDelete(NULL);
+}
+
+static void dirty_jobs_completed_callback(EventListener *listener)
+{
+    GlobalContext *glb = (GlobalContext *) listener->data;
+    struct DirtyJobs *dirty_jobs = (struct DirtyJobs *) glb->dirty_jobs;
+
+    struct ListHead completed_jobs;
+    list_init(&completed_jobs);
+
+    xSemaphoreTake(dirty_jobs->mutex, portMAX_DELAY);
+    while (!list_is_empty(&dirty_jobs->completed_jobs)) {
+        struct ListHead *item = list_first(&dirty_jobs->completed_jobs);
+        list_remove(item);
+        list_append(&completed_jobs, item);
+    }
+    dirty_jobs->wakeup_pending = 0;
+    xSemaphoreGive(dirty_jobs->mutex);
+
+    struct ListHead *item;
+    struct ListHead *tmp;
+    MUTABLE_LIST_FOR_EACH(item, tmp, &completed_jobs) {
+        struct DirtyJob *job = GET_LIST_ENTRY(item, struct DirtyJob, jobs_list_head);
+        job->complete(glb, job->data);
+        free(job);
+        dirty_jobs->pending_jobs--;
+    }
+
+    if (dirty_jobs->pending_jobs == 0) {
+        linkedlist_remove(&glb->listeners, &listener->listeners_list_head);
+        dirty_jobs->listening = 0;
+    }
+}
+
+static void dirty_job_discard(struct DirtyJob *job)
+{
+    job->discard(job->data);
+    free(job);
+}
+
+static struct DirtyJobs *dirty_jobs_start(GlobalContext *glb)
+{
+    struct DirtyJobs *dirty_jobs = malloc(sizeof(struct DirtyJobs));
+    if (IS_NULL_PTR(dirty_jobs)) {
+        return NULL;
+    }
+
+    dirty_jobs->queued_jobs = xQueueCreate(DIRTY_JOBS_QUEUE_LEN, sizeof(struct DirtyJob *));
+    dirty_jobs->mutex = xSemaphoreCreateMutex();
+    dirty_jobs->stopped_workers = xSemaphoreCreateCounting(DIRTY_JOBS_WORKERS, 0);
+    dirty_jobs->event_descriptor = open_event_descriptor(dirty_jobs);
+    if (UNLIKELY(!dirty_jobs->queued_jobs || !dirty_jobs->mutex || !dirty_jobs->stopped_workers
+            || (dirty_jobs->event_descriptor < 0))) {
+        if (dirty_jobs->queued_jobs) {
+            vQueueDelete(dirty_jobs->queued_jobs);
+        }
+        if (dirty_jobs->mutex) {
+            vSemaphoreDelete(dirty_jobs->mutex);
+        }
+        if (dirty_jobs->stopped_workers) {
+            vSemaphoreDelete(dirty_jobs->stopped_workers);
+        }
+        if (dirty_jobs->event_descriptor >= 0) {
+            close_event_descriptor(dirty_jobs->event_descriptor);
+        }
+        free(dirty_jobs);
+        return NULL;
+    }
+
+    list_init(&dirty_jobs->completed_jobs);
+    dirty_jobs->wakeup_pending = 0;
+
+    dirty_jobs->listener.fd = dirty_jobs->event_descriptor;
+    dirty_jobs->listener.expires = 0;
+    dirty_jobs->listener.expiral_timestamp.tv_sec = 0;
+    dirty_jobs->listener.expiral_timestamp.tv_nsec = 0;
+    dirty_jobs->listener.one_shot = 0;
+    dirty_jobs->listener.data = glb;
+    dirty_jobs->listener.handler = dirty_jobs_completed_callback;
+    dirty_jobs->listening = 0;
+    dirty_jobs->pending_jobs = 0;
+
+    dirty_jobs->workers_count = 0;
+    for (int i = 0; i < DIRTY_JOBS_WORKERS; i++) {
+        if (xTaskCreate(dirty_jobs_worker, "dirty_jobs", DIRTY_JOBS_WORKER_STACK_SIZE, dirty_jobs,
+                DIRTY_JOBS_WORKER_PRIORITY, NULL) != pdPASS) {
+            break;
+        }
+        dirty_jobs->workers_count++;
+    }
+
+    glb->dirty_jobs = dirty_jobs;
+
+    if (UNLIKELY(dirty_jobs->workers_count == 0)) {
+        fprintf(stderr, "Cannot start dirty jobs worker tasks.\n");
+        sys_stop_dirty_jobs(glb);
+        return NULL;
+    }
+
+    TRACE("dirty_jobs: started %i worker tasks.\n", dirty_jobs->workers_count);
+
+    return dirty_jobs;
+}
+
+int sys_submit_dirty_job(GlobalContext *glb, dirty_job_run_t run, dirty_job_complete_t complete, dirty_job_discard_t discard, void *data)
+{
+    struct DirtyJobs *dirty_jobs = (struct DirtyJobs *) glb->dirty_jobs;
+    if (!dirty_jobs) {
+        dirty_jobs = dirty_jobs_start(glb);
+        if (IS_NULL_PTR(dirty_jobs)) {
+            return 0;
+        }
+    }
+
+    struct DirtyJob *job = malloc(sizeof(struct DirtyJob));
+    if (IS_NULL_PTR(job)) {
+        return 0;
+    }
+    job->run = run;
+    job->complete = complete;
+    job->discard = discard;
+    job->data = data;
+
+    // the scheduler must not block here, so the caller runs the job on its own when the queue is full
+    if (xQueueSend(dirty_jobs->queued_jobs, &job, 0) != pdTRUE) {
+        free(job);
+        return 0;
+    }
+
+    if (!dirty_jobs->listening) {
+        linkedlist_append(&glb->listeners, &dirty_jobs->listener.listeners_list_head);
+        dirty_jobs->listening = 1;
+    }
+    dirty_jobs->pending_jobs++;
+
+    return 1;
+}
+
+void sys_stop_dirty_jobs(GlobalContext *glb)
+{
+    struct DirtyJobs *dirty_jobs = (struct DirtyJobs *) glb->dirty_jobs;
+
+    // queued jobs are discarded, then workers exit as soon as they end their current job
+    struct DirtyJob *job;
+    while (xQueueReceive(dirty_jobs->queued_jobs, &job, 0) == pdTRUE) {
+        dirty_job_discard(job);
+    }
+    job = NULL;
+    for (int i = 0; i < dirty_jobs->workers_count; i++) {
+        xQueueSend(dirty_jobs->queued_jobs, &job, portMAX_DELAY);
+    }
+    for (int i = 0; i < dirty_jobs->workers_count; i++) {
+        xSemaphoreTake(dirty_jobs->stopped_workers, portMAX_DELAY);
+    }
+    struct ListHead *item;
+    struct ListHead *tmp;
+    MUTABLE_LIST_FOR_EACH(item, tmp, &dirty_jobs->completed_jobs) {
+        dirty_job_discard(GET_LIST_ENTRY(item, struct DirtyJob, jobs_list_head));
+    }
+
+    if (dirty_jobs->listening) {
+        linkedlist_remove(&glb->listeners, &dirty_jobs->listener.listeners_list_head);
+    }
+
+    close_event_descriptor(dirty_jobs->event_descriptor);
+    vQueueDelete(dirty_jobs->queued_jobs);
+    vSemaphoreDelete(dirty_jobs->mutex);
+    vSemaphoreDelete(dirty_jobs->stopped_workers);
+    free(dirty_jobs);
+
+    glb->dirty_jobs = NULL;
+}
@@ -108,22 +108,26 @@ static void receive_events(GlobalContext *glb, TickType_t wait_ticks)
     int event_descriptor;
     if (xQueueReceive(event_queue, &event_descriptor, wait_ticks) == pdTRUE) {
         struct ListHead *listeners_list = glb->listeners;
-        EventListener *listeners = GET_LIST_ENTRY(listeners_list, EventListener, listeners_list_head);
-        EventListener *last_listener = GET_LIST_ENTRY(listeners_list->prev, EventListener, listeners_list_head);
-        EventListener *listener = listeners;
 
-        if (!listener) {
+        if (!listeners_list) {
             fprintf(stderr, "warning: no listeners.\n");
             return;
         }
 
+        EventListener *listener = GET_LIST_ENTRY(listeners_list, EventListener, listeners_list_head);
+        EventListener *last_listener = GET_LIST_ENTRY(listeners_list->prev, EventListener, listeners_list_head);
+
+        int done;
         do {
+            //handlers might remove their own listener
+            EventListener *next_listener = GET_LIST_ENTRY(listener->listeners_list_head.next, EventListener, listeners_list_head);
+            done = (listener == last_listener);
             if (listener->fd == event_descriptor) {
                 listener->handler(listener);
             }
 
-            listener = GET_LIST_ENTRY(listener->listeners_list_head.next, EventListener, listeners_list_head);
-        } while (listeners != NULL && listener != last_listener);
+            listener = next_listener;
+        } while (!done && glb->listeners != NULL);
     }
 }
 
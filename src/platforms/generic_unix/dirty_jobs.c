@@ -0,0 +1,271 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "sys.h"
+
+#include "list.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+#ifndef DIRTY_JOBS_WORKERS
+    #define DIRTY_JOBS_WORKERS 4
+#endif
+
+struct DirtyJob
+{
+    struct ListHead jobs_list_head;
+
+    dirty_job_run_t run;
+    dirty_job_complete_t complete;
+    dirty_job_discard_t discard;
+    void *data;
+};
+
+struct DirtyJobs
+{
+    // queued_jobs, completed_jobs and stopping are shared with worker threads and protected by mutex
+    pthread_mutex_t mutex;
+    pthread_cond_t job_queued;
+    struct ListHead queued_jobs;
+    struct ListHead completed_jobs;
+    int stopping;
+
+    pthread_t workers[DIRTY_JOBS_WORKERS];
+    int workers_count;
+
+    // workers write a byte to wakeup_pipe[1] when a job is completed, so the scheduler can poll wakeup_pipe[0]
+    int wakeup_pipe[2];
+
+    // the listener is registered only while there are pending jobs, so hang detection keeps working
+    EventListener listener;
+    int listening;
+    int pending_jobs;
+};
+
+static void *dirty_jobs_worker(void *arg)
+{
+    struct DirtyJobs *dirty_jobs = (struct DirtyJobs *) arg;
+
+    pthread_mutex_lock(&dirty_jobs->mutex);
+    while (1) {
+        while (list_is_empty(&dirty_jobs->queued_jobs) && !dirty_jobs->stopping) {
+            pthread_cond_wait(&dirty_jobs->job_queued, &dirty_jobs->mutex);
+        }
+        if (dirty_jobs->stopping) {
+            break;
+        }
+
+        struct ListHead *item = list_first(&dirty_jobs->queued_jobs);
+        list_remove(item);
+        pthread_mutex_unlock(&dirty_jobs->mutex);
+
+        struct DirtyJob *job = GET_LIST_ENTRY(item, struct DirtyJob, jobs_list_head);
+        job->run(job->data);
+
+        pthread_mutex_lock(&dirty_jobs->mutex);
+        list_append(&dirty_jobs->completed_jobs, item);
+
+        // the pipe is non blocking: when it is full the scheduler has not been woken up yet, so a byte can be dropped
+        char wakeup = 0;
+        if (UNLIKELY(write(dirty_jobs->wakeup_pipe[1], &wakeup, 1) < 0 && errno != EAGAIN)) {
+            fprintf(stderr, "Failed to wake up scheduler: %s:%i.\n", __FILE__, __LINE__);
+        }
+    }
+    pthread_mutex_unlock(&dirty_jobs->mutex);
+
+    return NULL;
+}
+
+static void dirty_jobs_completed_callback(EventListener *listener)
+{
+    GlobalContext *glb = (GlobalContext *) listener->data;
+    struct DirtyJobs *dirty_jobs = (struct DirtyJobs *) glb->dirty_jobs;
+
+    char buf[64];
+    while (read(dirty_jobs->wakeup_pipe[0], buf, sizeof(buf)) > 0) {
+    }
+
+    struct ListHead completed_jobs;
+    list_init(&completed_jobs);
+
+    pthread_mutex_lock(&dirty_jobs->mutex);
+    while (!list_is_empty(&dirty_jobs->completed_jobs)) {
+        struct ListHead *item = list_first(&dirty_jobs->completed_jobs);
+        list_remove(item);
+        list_append(&completed_jobs, item);
+    }
+    pthread_mutex_unlock(&dirty_jobs->mutex);
+
+    struct ListHead *item;
+    struct ListHead *tmp;
+    MUTABLE_LIST_FOR_EACH(item, tmp, &completed_jobs) {
+        struct DirtyJob *job = GET_LIST_ENTRY(item, struct DirtyJob, jobs_list_head);
+        job->complete(glb, job->data);
+        free(job);
+        dirty_jobs->pending_jobs--;
+    }
+
+    if (dirty_jobs->pending_jobs == 0) {
+        linkedlist_remove(&glb->listeners, &listener->listeners_list_head);
+        dirty_jobs->listening = 0;
+    }
+}
+
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return (flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) >= 0);
+}
+
+static void dirty_job_discard(struct DirtyJob *job)
+{
+    job->discard(job->data);
+    free(job);
+}
+
+static struct DirtyJobs *dirty_jobs_start(GlobalContext *glb)
+{
+    struct DirtyJobs *dirty_jobs = malloc(sizeof(struct DirtyJobs));
+    if (IS_NULL_PTR(dirty_jobs)) {
+        return NULL;
+    }
+
+    if (UNLIKELY(pipe(dirty_jobs->wakeup_pipe))) {
+        free(dirty_jobs);
+        return NULL;
+    }
+    if (UNLIKELY(!set_nonblocking(dirty_jobs->wakeup_pipe[0]) || !set_nonblocking(dirty_jobs->wakeup_pipe[1]))) {
+        close(dirty_jobs->wakeup_pipe[0]);
+        close(dirty_jobs->wakeup_pipe[1]);
+        free(dirty_jobs);
+        return NULL;
+    }
+
+    pthread_mutex_init(&dirty_jobs->mutex, NULL);
+    pthread_cond_init(&dirty_jobs->job_queued, NULL);
+    list_init(&dirty_jobs->queued_jobs);
+    list_init(&dirty_jobs->completed_jobs);
+    dirty_jobs->stopping = 0;
+
+    dirty_jobs->listener.fd = dirty_jobs->wakeup_pipe[0];
+    dirty_jobs->listener.expires = 0;
+    dirty_jobs->listener.expiral_timestamp.tv_sec = 0;
+    dirty_jobs->listener.expiral_timestamp.tv_nsec = 0;
+    dirty_jobs->listener.one_shot = 0;
+    dirty_jobs->listener.data = glb;
+    dirty_jobs->listener.handler = dirty_jobs_completed_callback;
+    dirty_jobs->listening = 0;
+    dirty_jobs->pending_jobs = 0;
+
+    dirty_jobs->workers_count = 0;
+    for (int i = 0; i < DIRTY_JOBS_WORKERS; i++) {
+        if (pthread_create(&dirty_jobs->workers[i], NULL, dirty_jobs_worker, dirty_jobs)) {
+            break;
+        }
+        dirty_jobs->workers_count++;
+    }
+
+    glb->dirty_jobs = dirty_jobs;
+
+    if (UNLIKELY(dirty_jobs->workers_count == 0)) {
+        fprintf(stderr, "Cannot start dirty jobs worker threads.\n");
+        sys_stop_dirty_jobs(glb);
+        return NULL;
+    }
+
+    TRACE("dirty_jobs: started %i worker threads.\n", dirty_jobs->workers_count);
+
+    return dirty_jobs;
+}
+
+int sys_submit_dirty_job(GlobalContext *glb, dirty_job_run_t run, dirty_job_complete_t complete, dirty_job_discard_t discard, void *data)
+{
+    struct DirtyJobs *dirty_jobs = (struct DirtyJobs *) glb->dirty_jobs;
+    if (!dirty_jobs) {
+        dirty_jobs = dirty_jobs_start(glb);
+        if (IS_NULL_PTR(dirty_jobs)) {
+            return 0;
+        }
+    }
+
+    struct DirtyJob *job = malloc(sizeof(struct DirtyJob));
+    if (IS_NULL_PTR(job)) {
+        return 0;
+    }
+    job->run = run;
+    job->complete = complete;
+    job->discard = discard;
+    job->data = data;
+
+    if (!dirty_jobs->listening) {
+        linkedlist_append(&glb->listeners, &dirty_jobs->listener.listeners_list_head);
+        dirty_jobs->listening = 1;
+    }
+    dirty_jobs->pending_jobs++;
+
+    pthread_mutex_lock(&dirty_jobs->mutex);
+    list_append(&dirty_jobs->queued_jobs, &job->jobs_list_head);
+    pthread_cond_signal(&dirty_jobs->job_queued);
+    pthread_mutex_unlock(&dirty_jobs->mutex);
+
+    return 1;
+}
+
+void sys_stop_dirty_jobs(GlobalContext *glb)
+{
+    struct DirtyJobs *dirty_jobs = (struct DirtyJobs *) glb->dirty_jobs;
+
+    pthread_mutex_lock(&dirty_jobs->mutex);
+    dirty_jobs->stopping = 1;
+    pthread_cond_broadcast(&dirty_jobs->job_queued);
+    pthread_mutex_unlock(&dirty_jobs->mutex);
+
+    for (int i = 0; i < dirty_jobs->workers_count; i++) {
+        pthread_join(dirty_jobs->workers[i], NULL);
+    }
+
+    struct ListHead *item;
+    struct ListHead *tmp;
+    MUTABLE_LIST_FOR_EACH(item, tmp, &dirty_jobs->queued_jobs) {
+        dirty_job_discard(GET_LIST_ENTRY(item, struct DirtyJob, jobs_list_head));
+    }
+    MUTABLE_LIST_FOR_EACH(item, tmp, &dirty_jobs->completed_jobs) {
+        dirty_job_discard(GET_LIST_ENTRY(item, struct DirtyJob, jobs_list_head));
+    }
+
+    if (dirty_jobs->listening) {
+        linkedlist_remove(&glb->listeners, &dirty_jobs->listener.listeners_list_head);
+    }
+
+    close(dirty_jobs->wakeup_pipe[0]);
+    close(dirty_jobs->wakeup_pipe[1]);
+    pthread_cond_destroy(&dirty_jobs->job_queued);
+    pthread_mutex_destroy(&dirty_jobs->mutex);
+    free(dirty_jobs);
+
+    glb->dirty_jobs = NULL;
+}
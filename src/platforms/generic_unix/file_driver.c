@@ -0,0 +1,198 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "file_driver.h"
+
+#include "context.h"
+#include "globalcontext.h"
+#include "interop.h"
+#include "mailbox.h"
+#include "platform_defaultatoms.h"
+#include "port.h"
+#include "sys.h"
+#include "term.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+#define READ_BUFFER_SIZE 4096
+
+struct FileReadJob
+{
+    // the port is looked up again when the job is completed, since it might have exited in the meantime
+    int32_t port_process_id;
+    term pid;
+    uint64_t ref_ticks;
+
+    char *path;
+
+    char *buf;
+    size_t size;
+    term syscall;
+    int error;
+};
+
+static void file_read_run(void *data)
+{
+    struct FileReadJob *job = (struct FileReadJob *) data;
+
+    int fd = open(job->path, O_RDONLY);
+    if (fd < 0) {
+        job->syscall = OPEN_ATOM;
+        job->error = errno;
+        return;
+    }
+
+    size_t capacity = 0;
+    while (1) {
+        if (job->size == capacity) {
+            capacity += READ_BUFFER_SIZE;
+            char *new_buf = realloc(job->buf, capacity);
+            if (IS_NULL_PTR(new_buf)) {
+                job->syscall = READ_ATOM;
+                job->error = ENOMEM;
+                break;
+            }
+            job->buf = new_buf;
+        }
+
+        ssize_t len = read(fd, job->buf + job->size, capacity - job->size);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            job->syscall = READ_ATOM;
+            job->error = errno;
+            break;
+        } else if (len == 0) {
+            break;
+        }
+        job->size += len;
+    }
+
+    close(fd);
+}
+
+static void file_read_destroy(void *data)
+{
+    struct FileReadJob *job = (struct FileReadJob *) data;
+
+    free(job->buf);
+    free(job->path);
+    free(job);
+}
+
+static void file_read_complete(GlobalContext *glb, void *data)
+{
+    struct FileReadJob *job = (struct FileReadJob *) data;
+
+    // the port or the requesting process might have exited while the file was read
+    Context *ctx = globalcontext_get_process(glb, job->port_process_id);
+    if (ctx && globalcontext_get_process(glb, term_to_local_process_id(job->pid))) {
+        if (job->error) {
+            // {Ref, {error, {SysCall, Errno}}}
+            // tuple arity 2:       3
+            // tuple arity 2:       3
+            // tuple arity 2:       3
+            // ref:                 3 (max)
+            port_ensure_available(ctx, 12);
+            term ref = term_from_ref_ticks(job->ref_ticks, ctx);
+            port_send_reply(ctx, job->pid, ref, port_create_sys_error_tuple(ctx, job->syscall, job->error));
+        } else {
+            // {Ref, {ok, Binary}}
+            // tuple arity 2:       3
+            // tuple arity 2:       3
+            // ref:                 3 (max)
+            // binary:              2 + len(binary)/WORD_SIZE + 1
+            port_ensure_available(ctx, 9 + BINARY_HEADER_SIZE + term_binary_data_size_in_terms(job->size));
+            term ref = term_from_ref_ticks(job->ref_ticks, ctx);
+            term binary = term_from_literal_binary(job->buf, job->size, ctx);
+            port_send_reply(ctx, job->pid, ref, port_create_ok_tuple(ctx, binary));
+        }
+    }
+
+    file_read_destroy(job);
+}
+
+static void filedriver_do_read(Context *ctx, term pid, term ref, term path)
+{
+    char *path_string = interop_term_to_string(path);
+    if (IS_NULL_PTR(path_string)) {
+        port_send_reply(ctx, pid, ref, port_create_error_tuple(ctx, BADARG_ATOM));
+        return;
+    }
+
+    struct FileReadJob *job = malloc(sizeof(struct FileReadJob));
+    if (IS_NULL_PTR(job)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        abort();
+    }
+    job->port_process_id = ctx->process_id;
+    job->pid = pid;
+    job->ref_ticks = term_to_ref_ticks(ref);
+    job->path = path_string;
+    job->buf = NULL;
+    job->size = 0;
+    job->syscall = READ_ATOM;
+    job->error = 0;
+
+    if (!sys_submit_dirty_job(ctx->global, file_read_run, file_read_complete, file_read_destroy, job)) {
+        file_read_run(job);
+        file_read_complete(ctx->global, job);
+    }
+}
+
+static void filedriver_consume_mailbox(Context *ctx)
+{
+    TRACE("START filedriver_consume_mailbox\n");
+
+    // commands are cheap to dispatch since reads are performed by dirty jobs, so all queued commands are handled
+    while (ctx->mailbox) {
+        port_ensure_available(ctx, 16);
+
+        Message *message = mailbox_dequeue(ctx);
+        term msg = message->message;
+
+        if (port_is_standard_port_command(msg)) {
+            term pid = term_get_tuple_element(msg, 0);
+            term ref = term_get_tuple_element(msg, 1);
+            term cmd = term_get_tuple_element(msg, 2);
+
+            if (term_is_tuple(cmd) && term_get_tuple_arity(cmd) == 2 && term_get_tuple_element(cmd, 0) == READ_ATOM) {
+                filedriver_do_read(ctx, pid, ref, term_get_tuple_element(cmd, 1));
+            } else {
+                port_send_reply(ctx, pid, ref, port_create_error_tuple(ctx, BADARG_ATOM));
+            }
+        }
+
+        mailbox_destroy_message(ctx, message);
+    }
+
+    TRACE("END filedriver_consume_mailbox\n");
+}
+
+void filedriver_init(Context *ctx)
+{
+    ctx->native_handler = filedriver_consume_mailbox;
+}
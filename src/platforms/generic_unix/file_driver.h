@@ -0,0 +1,35 @@
+/***************************************************************************
+ *   Copyright 2019 by Davide Bettio <davide@uninstall.it>                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef _FILE_DRIVER_H_
+#define _FILE_DRIVER_H_
+
+#include "context.h"
+
+/**
+ * @brief Initializes a file port driver
+ *
+ * @details The file driver handles {Pid, Ref, {read, Path}} commands and replies with {Ref, {ok, Binary}} or
+ * {Ref, {error, {SysCall, Errno}}}. Files are read on a dirty job worker thread, so other processes keep running
+ * while the file is read.
+ * @param ctx the port context.
+ */
+void filedriver_init(Context *ctx);
+
+#endif
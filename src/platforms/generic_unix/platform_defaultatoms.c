@@ -32,6 +32,9 @@ static const char *const sendto_atom = "\x6" "sendto";
 static const char *const sta_got_ip_atom = "\xA" "sta_got_ip";
 static const char *const sta_connected_atom = "\xD" "sta_connected";
 
+static const char *const open_atom = "\x4" "open";
+static const char *const read_atom = "\x4" "read";
+
 void platform_defaultatoms_init(GlobalContext *glb)
 {
     int ok = 1;
@@ -49,6 +52,9 @@ void platform_defaultatoms_init(GlobalContext *glb)
     ok &= globalcontext_insert_atom(glb, sta_got_ip_atom) == STA_GOT_IP_ATOM_INDEX;
     ok &= globalcontext_insert_atom(glb, sta_connected_atom) == STA_CONNECTED_ATOM_INDEX;
 
+    ok &= globalcontext_insert_atom(glb, open_atom) == OPEN_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, read_atom) == READ_ATOM_INDEX;
+
     if (!ok) {
         abort();
     }
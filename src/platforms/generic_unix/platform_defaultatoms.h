@@ -35,6 +35,9 @@
 #define STA_GOT_IP_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 9)
 #define STA_CONNECTED_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 10)
 
+#define OPEN_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 11)
+#define READ_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 12)
+
 #define PROTO_ATOM term_from_atom_index(PROTO_ATOM_INDEX)
 #define UDP_ATOM term_from_atom_index(UDP_ATOM_INDEX)
 #define TCP_ATOM term_from_atom_index(TCP_ATOM_INDEX)
@@ -48,4 +51,7 @@
 #define STA_GOT_IP_ATOM term_from_atom_index(STA_GOT_IP_ATOM_INDEX)
 #define STA_CONNECTED_ATOM term_from_atom_index(STA_CONNECTED_ATOM_INDEX)
 
+#define OPEN_ATOM term_from_atom_index(OPEN_ATOM_INDEX)
+#define READ_ATOM term_from_atom_index(READ_ATOM_INDEX)
+
 #endif
@@ -20,6 +20,7 @@
 #include "sys.h"
 
 #include "avmpack.h"
+#include "file_driver.h"
 #include "iff.h"
 #include "mapped_file.h"
 #include "scheduler.h"
@@ -111,9 +112,9 @@ extern void sys_waitevents(GlobalContext *glb)
                 fds[poll_fd_index].fd = listener->fd;
                 fds[poll_fd_index].events = POLLIN;
                 fds[poll_fd_index].revents = 0;
-            }
 
-            poll_fd_index++;
+                poll_fd_index++;
+            }
 
             listener = GET_LIST_ENTRY(listener->listeners_list_head.next, EventListener, listeners_list_head);
         } while (listener != listeners);
@@ -159,11 +160,15 @@ extern void sys_waitevents(GlobalContext *glb)
     }
 
     //third: execute handlers for expiered timers
-    if (min_timeout != INT_MAX) {
-        listener = listeners;
+    if ((min_timeout != INT_MAX) && glb->listeners) {
+        //fd handlers might have removed listeners, so the list is scanned again up to its current last item
+        listener = GET_LIST_ENTRY(glb->listeners, EventListener, listeners_list_head);
+        last_listener = GET_LIST_ENTRY(glb->listeners->prev, EventListener, listeners_list_head);
         clock_gettime(CLOCK_MONOTONIC, &now);
+        int done;
         do {
             EventListener *next_listener = GET_LIST_ENTRY(listener->listeners_list_head.next, EventListener, listeners_list_head);
+            done = (listener == last_listener);
             if (listener->expires) {
                 int wait_ms = timespec_diff_to_ms(&listener->expiral_timestamp, &now);
                 if (wait_ms <= 0) {
@@ -174,58 +179,50 @@ extern void sys_waitevents(GlobalContext *glb)
             }
 
             listener = next_listener;
-            listeners = GET_LIST_ENTRY(glb->listeners, EventListener, listeners_list_head);
-        } while (listeners != NULL && listener != last_listener);
+        } while (!done && glb->listeners != NULL);
     }
 }
 
 void sys_consume_pending_events(GlobalContext *glb)
 {
-    struct ListHead *listeners_list = glb->listeners;
-
     if (!glb->listeners) {
         return;
     }
 
-    EventListener *listeners = GET_LIST_ENTRY(listeners_list, EventListener, listeners_list_head);
-    EventListener *last_listener = GET_LIST_ENTRY(listeners_list->prev, EventListener, listeners_list_head);
-
+    EventListener *listeners = GET_LIST_ENTRY(glb->listeners, EventListener, listeners_list_head);
     EventListener *listener = listeners;
 
     int fds_count = 0;
 
     do {
-        int listener_fd = listener->fd;
-        if (listener_fd >= 0) {
+        if (listener->fd >= 0) {
             fds_count++;
         }
-    } while (listeners != NULL && listener != last_listener);
+        listener = GET_LIST_ENTRY(listener->listeners_list_head.next, EventListener, listeners_list_head);
+    } while (listener != listeners);
 
     if (fds_count == 0) {
         return;
     }
 
-    listeners = GET_LIST_ENTRY(listeners_list, EventListener, listeners_list_head);
-    last_listener = GET_LIST_ENTRY(listeners_list->prev, EventListener, listeners_list_head);
-
-    listener = listeners;
-
     struct pollfd *fds = malloc(fds_count * sizeof(struct pollfd));
+    if (IS_NULL_PTR(fds)) {
+        fprintf(stderr, "Cannot allocate memory for pollfd, aborting.\n");
+        abort();
+    }
     int fd_index = 0;
 
+    listener = listeners;
     do {
-        int listener_fd = listener->fd;
-        if (listener_fd >= 0) {
-            fds[fd_index].fd = listener_fd;
+        if (listener->fd >= 0) {
+            fds[fd_index].fd = listener->fd;
             fds[fd_index].events = POLLIN;
             fds[fd_index].revents = 0;
 
             fd_index++;
         }
-    } while (listeners != NULL && listener != last_listener);
-
-    listeners = GET_LIST_ENTRY(listeners_list, EventListener, listeners_list_head);
-    last_listener = GET_LIST_ENTRY(listeners_list->prev, EventListener, listeners_list_head);
+        listener = GET_LIST_ENTRY(listener->listeners_list_head.next, EventListener, listeners_list_head);
+    } while (listener != listeners);
 
     if (poll(fds, fd_index, 0) > 0) {
         for (int i = 0; i < fd_index; i++) {
@@ -233,23 +230,20 @@ void sys_consume_pending_events(GlobalContext *glb)
                 continue;
             }
 
-            int current_fd = fds[i].fd;
-
-            EventListener *listener = listeners;
-
-            if (!listener) {
-                fprintf(stderr, "warning: no listeners.\n");
-                free(fds);
-                return;
+            //handlers might remove their own listener, so the list is looked up again for each ready fd
+            if (!glb->listeners) {
+                break;
             }
+            listeners = GET_LIST_ENTRY(glb->listeners, EventListener, listeners_list_head);
+            listener = listeners;
 
             do {
-                if (listener->fd == current_fd) {
+                if (listener->fd == fds[i].fd) {
                     listener->handler(listener);
                     break;
                 }
                 listener = GET_LIST_ENTRY(listener->listeners_list_head.next, EventListener, listeners_list_head);
-            } while (listeners != NULL && listener != last_listener);
+            } while (listener != listeners);
         }
     }
 
@@ -318,6 +312,8 @@ Context *sys_create_port(GlobalContext *glb, const char *driver_name, term opts)
         network_init(new_ctx, opts);
     } else if (!strcmp(driver_name, "gpio")) {
         gpiodriver_init(new_ctx);
+    } else if (!strcmp(driver_name, "file")) {
+        filedriver_init(new_ctx);
     } else {
         context_destroy(new_ctx);
         return NULL;
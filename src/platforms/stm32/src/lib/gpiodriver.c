@@ -99,7 +99,7 @@ static void consume_gpio_mailbox(Context *ctx)
         ret = ERROR_ATOM;
     }
 
-    free(message);
+    mailbox_destroy_message(ctx, message);
 
     mailbox_send(target, ret);
 }
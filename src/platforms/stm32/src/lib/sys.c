@@ -109,6 +109,23 @@ void sys_consume_pending_events(GlobalContext *glb)
     UNUSED(glb);
 }
 
+// there are no worker threads, so the caller runs dirty jobs on its own
+int sys_submit_dirty_job(GlobalContext *glb, dirty_job_run_t run, dirty_job_complete_t complete, dirty_job_discard_t discard, void *data)
+{
+    UNUSED(glb);
+    UNUSED(run);
+    UNUSED(complete);
+    UNUSED(discard);
+    UNUSED(data);
+
+    return 0;
+}
+
+void sys_stop_dirty_jobs(GlobalContext *glb)
+{
+    UNUSED(glb);
+}
+
 void sys_set_timestamp_from_relative_to_abs(struct timespec *t, int32_t millis)
 {
     sys_clock_gettime(t);
@@ -0,0 +1,52 @@
+-module(test_compacting_gc).
+
+-export([start/0, worker/1]).
+
+start() ->
+    1048576 = erlang:system_flag(compacting_gc_threshold, 0),
+    0 = erlang:system_flag(compacting_gc_threshold, 1048576),
+    error = try_spawn([{compacting_gc_threshold, -1}]),
+    error = try_spawn([{compacting_gc_threshold, always}]),
+    Count1 = run([{compacting_gc_threshold, 0}]),
+    Count2 = run([{compacting_gc_threshold, 0}, {heap_growth, minimum}]),
+    Count3 = run([{compacting_gc_threshold, 1000}, {fullsweep_after, 2}]),
+    Count1 + Count2 + Count3.
+
+try_spawn(Opts) ->
+    try spawn_opt(?MODULE, worker, [self()], Opts) of
+        _Pid -> ok
+    catch
+        error:badarg -> error
+    end.
+
+run(Opts) ->
+    spawn_opt(?MODULE, worker, [self()], Opts),
+    receive
+        Count -> Count
+    end.
+
+worker(Parent) ->
+    State = make_state(500, []),
+    Shared = {State, State},
+    Fun = fun(Acc) -> count(State, Acc) end,
+    make_garbage(100),
+    {State1, State2} = Shared,
+    Count = count(State1, 0),
+    Count = count(State2, 0),
+    Parent ! Fun(0).
+
+make_state(0, Acc) ->
+    Acc;
+make_state(N, Acc) ->
+    make_state(N - 1, [{N, N * 2} | Acc]).
+
+make_garbage(0) ->
+    ok;
+make_garbage(N) ->
+    count(make_state(100, []), 0),
+    make_garbage(N - 1).
+
+count([], Acc) ->
+    Acc;
+count([{N, Double} | T], Acc) when Double == N * 2 ->
+    count(T, Acc + 1).
@@ -0,0 +1,16 @@
+-module(test_dirty_file_read).
+-export([start/0]).
+
+start() ->
+    Port = open_port({spawn, "file"}, []),
+    {error, badarg} = call(Port, {write, "test_dirty_file_read.beam"}),
+    {error, {open, _Errno}} = call(Port, {read, "non_existing_file.beam"}),
+    {ok, Bin} = call(Port, {read, "test_dirty_file_read.beam"}),
+    binary:first(Bin) + binary:at(Bin, 8).
+
+call(Port, Command) ->
+    Ref = make_ref(),
+    Port ! {self(), Ref, Command},
+    receive
+        {Ref, Reply} -> Reply
+    end.
@@ -0,0 +1,41 @@
+-module(test_dispatch).
+-export([start/0, worker/1, count/2, id/1]).
+
+start() ->
+    Self = self(),
+    % both processes run for longer than a time slice, so they are scheduled out while dispatching
+    Pid = spawn(?MODULE, worker, [Self]),
+    Pid ! {Self, go},
+    A = count(50000, 0),
+    B =
+        receive
+            {Pid, Result} -> Result
+        end,
+    C = safe_add(id(a), 1) + safe_add(id(1), 1),
+    D =
+        receive
+            _Any -> 0
+        after 1 -> 4
+        end,
+    A + B + C + D.
+
+worker(Pid) ->
+    receive
+        {Pid, go} ->
+            Pid ! {self(), count(30000, 0)}
+    end.
+
+count(0, Acc) ->
+    Acc;
+count(N, Acc) ->
+    count(N - 1, Acc + 1).
+
+safe_add(A, B) ->
+    try A + B of
+        Sum -> Sum
+    catch
+        error:badarith -> 10
+    end.
+
+id(X) ->
+    X.
@@ -0,0 +1,29 @@
+-module(test_dynamic_call_cache).
+-export([start/0, f1/1, f2/1, f3/1, f4/1, f5/1]).
+
+start() ->
+    Targets = [{?MODULE, f1}, {?MODULE, f2}, {?MODULE, f3}, {?MODULE, f4}, {?MODULE, f5}, {erlang, list_to_integer}],
+    call_all(Targets, 0) + call_all(Targets, 0) + tail_call_all(Targets, 0).
+
+call_all([], Acc) ->
+    Acc;
+call_all([{M, F} | T], Acc) ->
+    R = M:F(arg(M)),
+    call_all(T, Acc + R).
+
+tail_call_all([], Acc) ->
+    Acc;
+tail_call_all([{M, F} | T], Acc) ->
+    tail_call_all(T, Acc + tail_call(M, F)).
+
+tail_call(M, F) ->
+    M:F(arg(M)).
+
+arg(erlang) -> "7";
+arg(_) -> 10.
+
+f1(N) -> N + 1.
+f2(N) -> N + 2.
+f3(N) -> N + 3.
+f4(N) -> N + 4.
+f5(N) -> N + 5.
@@ -0,0 +1,22 @@
+-module(test_function_profiler).
+-export([start/0, fact/1]).
+
+start() ->
+    false = erlang:system_flag(function_profiler, true),
+    120 = fact(5),
+    true = erlang:system_flag(function_profiler, false),
+    720 = fact(6),
+    Profile = erlang:system_info(function_profile),
+    calls(Profile, {?MODULE, fact, 1}) * 10 + calls(Profile, {erlang, '*', 2}).
+
+calls([], _MFA) ->
+    0;
+calls([{MFA, Calls, _Own, _Total} | _T], MFA) ->
+    Calls;
+calls([_H | T], MFA) ->
+    calls(T, MFA).
+
+fact(0) ->
+    1;
+fact(N) ->
+    N * fact(N - 1).
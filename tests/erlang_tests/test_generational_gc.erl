@@ -0,0 +1,44 @@
+-module(test_generational_gc).
+
+-export([start/0, worker/1]).
+
+start() ->
+    65535 = erlang:system_flag(fullsweep_after, 65535),
+    {Count1, MinorGCs1, 65535} = run([]),
+    true = MinorGCs1 > 0,
+    {Count2, 0, 0} = run([{fullsweep_after, 0}]),
+    {Count3, MinorGCs3, 3} = run([{fullsweep_after, 3}]),
+    true = MinorGCs3 =< 3,
+    Count1 + Count2 + Count3.
+
+run(Opts) ->
+    spawn_opt(?MODULE, worker, [self()], Opts),
+    receive
+        Result -> Result
+    end.
+
+worker(Parent) ->
+    State = make_state(2000, []),
+    make_garbage(300),
+    % copied in chunks, collections in between promote items that are written later
+    Appended = State ++ [{2001, 4002}],
+    make_garbage(10),
+    {garbage_collection, [{minor_gcs, MinorGCs}, {fullsweep_after, FullsweepAfter}]} =
+        process_info(self(), garbage_collection),
+    Parent ! {count(Appended, 0), MinorGCs, FullsweepAfter}.
+
+make_state(0, Acc) ->
+    Acc;
+make_state(N, Acc) ->
+    make_state(N - 1, [{N, N * 2} | Acc]).
+
+make_garbage(0) ->
+    ok;
+make_garbage(N) ->
+    count(make_state(200, []), 0),
+    make_garbage(N - 1).
+
+count([], Acc) ->
+    Acc;
+count([{N, Double} | T], Acc) when Double == N * 2 ->
+    count(T, Acc + 1).
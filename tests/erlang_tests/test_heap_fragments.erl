@@ -0,0 +1,41 @@
+-module(test_heap_fragments).
+
+-export([start/0, sender/2]).
+
+start() ->
+    spawn(?MODULE, sender, [self(), 2000]),
+    Received = receive_all(2000, []),
+    make_garbage(100),
+    check(Received, 0).
+
+sender(_Parent, 0) ->
+    ok;
+sender(Parent, N) ->
+    Doubled = [N, N * 2],
+    Parent ! {N, Doubled, Doubled},
+    sender(Parent, N - 1).
+
+receive_all(0, Acc) ->
+    Acc;
+receive_all(N, Acc) ->
+    receive
+        {_, _, _} = Message ->
+            make_garbage(N rem 3),
+            receive_all(N - 1, [Message | Acc])
+    end.
+
+make_garbage(0) ->
+    ok;
+make_garbage(N) ->
+    make_list(20, []),
+    make_garbage(N - 1).
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [N | Acc]).
+
+check([], Acc) ->
+    Acc;
+check([{N, [N, Double], [N, Double]} | T], Acc) when Double == N * 2 ->
+    check(T, Acc + 1).
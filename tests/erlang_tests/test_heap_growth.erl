@@ -0,0 +1,61 @@
+-module(test_heap_growth).
+
+-export([start/0, worker/1]).
+
+start() ->
+    fibonacci = erlang:system_flag(heap_growth, minimum),
+    minimum = erlang:system_flag(heap_growth, fibonacci),
+    error = try_spawn([{heap_growth, unknown}]),
+    error = try_spawn([{min_heap_size, 200}, {max_heap_size, 100}]),
+    Count1 = run([{heap_growth, minimum}]),
+    Count2 = run([{heap_growth, fibonacci}]),
+    Count3 = run_fun([{heap_growth, minimum}, {min_heap_size, 1000}]),
+    Count1 + Count2 + Count3.
+
+try_spawn(Opts) ->
+    try spawn_opt(?MODULE, worker, [self()], Opts) of
+        _Pid -> ok
+    catch
+        error:badarg -> error
+    end.
+
+run(Opts) ->
+    spawn_opt(?MODULE, worker, [self()], Opts),
+    receive
+        Count -> Count
+    end.
+
+run_fun(Opts) ->
+    Parent = self(),
+    spawn_opt(
+        fun() ->
+            {memory, Memory} = process_info(self(), memory),
+            true = Memory >= 1000 * erlang:system_info(wordsize),
+            worker(Parent)
+        end,
+        Opts
+    ),
+    receive
+        Count -> Count
+    end.
+
+worker(Parent) ->
+    State = make_state(500, []),
+    make_garbage(100),
+    Parent ! count(State, 0).
+
+make_state(0, Acc) ->
+    Acc;
+make_state(N, Acc) ->
+    make_state(N - 1, [{N, N * 2} | Acc]).
+
+make_garbage(0) ->
+    ok;
+make_garbage(N) ->
+    count(make_state(100, []), 0),
+    make_garbage(N - 1).
+
+count([], Acc) ->
+    Acc;
+count([{N, Double} | T], Acc) when Double == N * 2 ->
+    count(T, Acc + 1).
@@ -0,0 +1,43 @@
+-module(test_heap_pool).
+
+-export([start/0, worker/1]).
+
+start() ->
+    Count = spawn_workers(50, 0),
+    [
+        {live_words, LiveWords},
+        {cached_words, CachedWords},
+        {fragmentation, Fragmentation},
+        {allocs, Allocs},
+        {pool_hits, PoolHits},
+        {classes, Classes}
+    ] = erlang:system_info(heap_pool),
+    true = LiveWords > 0,
+    true = CachedWords >= 0,
+    true = (Fragmentation >= 0) andalso (Fragmentation =< 100),
+    true = PoolHits > 0,
+    true = Allocs >= PoolHits,
+    {0, _LargeLive, _LargeCached} = lists_last(Classes),
+    Count.
+
+spawn_workers(0, Count) ->
+    Count;
+spawn_workers(N, Count) ->
+    spawn(?MODULE, worker, [self()]),
+    receive
+        done -> spawn_workers(N - 1, Count + 1)
+    end.
+
+worker(Parent) ->
+    make_list(200, []),
+    Parent ! done.
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [{N} | Acc]).
+
+lists_last([Last]) ->
+    Last;
+lists_last([_H | T]) ->
+    lists_last(T).
@@ -0,0 +1,56 @@
+-module(test_incremental_gc).
+
+-export([start/0, worker/1]).
+
+start() ->
+    0 = erlang:system_flag(max_gc_pause, 1000),
+    1000 = erlang:system_flag(max_gc_pause, 0),
+    error = try_spawn([{max_gc_pause, -1}]),
+    error = try_spawn([{max_gc_pause, infinity}]),
+    Count1 = run([{max_gc_pause, 1}]),
+    Count2 = run([{max_gc_pause, 1}, {heap_growth, minimum}]),
+    Count3 = run([{max_gc_pause, 500}, {fullsweep_after, 2}]),
+    Count1 + Count2 + Count3.
+
+try_spawn(Opts) ->
+    try spawn_opt(?MODULE, worker, [self()], Opts) of
+        _Pid -> ok
+    catch
+        error:badarg -> error
+    end.
+
+run(Opts) ->
+    spawn_opt(?MODULE, worker, [self()], Opts),
+    receive
+        Count -> Count
+    end.
+
+worker(Parent) ->
+    State = make_state(2000, []),
+    make_garbage(200),
+    Doubled = State ++ State,
+    make_garbage(100),
+    Bin = list_to_binary(make_bytes(5000, [])),
+    make_garbage(100),
+    Parent ! count(Doubled, 0) + byte_size(Bin).
+
+make_state(0, Acc) ->
+    Acc;
+make_state(N, Acc) ->
+    make_state(N - 1, [{N, N * 2} | Acc]).
+
+make_bytes(0, Acc) ->
+    Acc;
+make_bytes(N, Acc) ->
+    make_bytes(N - 1, [N rem 256 | Acc]).
+
+make_garbage(0) ->
+    ok;
+make_garbage(N) ->
+    count(make_state(100, []), 0),
+    make_garbage(N - 1).
+
+count([], Acc) ->
+    Acc;
+count([{N, Double} | T], Acc) when Double == N * 2 ->
+    count(T, Acc + 1).
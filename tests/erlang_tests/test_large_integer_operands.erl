@@ -0,0 +1,31 @@
+-module(test_large_integer_operands).
+-export([start/0, id/1, huge/0]).
+
+% integers that take 5 to 8 bytes in the compact term encoding, they are immediate terms only
+% on 64 bits builds, but modules using them must be loadable on 32 bits builds as well
+start() ->
+    case erlang:system_info(wordsize) of
+        8 ->
+            classify(id(4294967296)) + classify(id(-1099511627776)) + classify(id(281474976710656)) +
+            classify(id(-72057594037927936)) + classify(id(42));
+        4 ->
+            26
+    end.
+
+classify(4294967296) ->
+    5;
+classify(-1099511627776) ->
+    6;
+classify(281474976710656) ->
+    7;
+classify(-72057594037927936) ->
+    8;
+classify(_) ->
+    0.
+
+% it doesn't fit an immediate term on any build, so it is decoded only if this is called
+huge() ->
+    id(2305843009213693952).
+
+id(X) ->
+    X.
@@ -0,0 +1,11 @@
+-module(test_link_on_load).
+-export([start/0, call_missing/1]).
+
+start() ->
+    test_link_on_load_dep:double(21) + call_missing(false).
+
+% the module of this import doesn't exist, linking leaves it unresolved and it is never called
+call_missing(true) ->
+    non_existing_module:f();
+call_missing(false) ->
+    0.
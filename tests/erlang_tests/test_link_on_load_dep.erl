@@ -0,0 +1,6 @@
+-module(test_link_on_load_dep).
+-export([double/1]).
+
+% modc imports moda, so linking has to load modules imported by modules it loaded
+double(X) ->
+    modc:test(X) + 1.
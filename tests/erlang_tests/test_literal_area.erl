@@ -0,0 +1,43 @@
+-module(test_literal_area).
+
+-export([start/0, echo/0]).
+
+start() ->
+    Pid = spawn(?MODULE, echo, []),
+    Pid ! {self(), literal()},
+    Echoed =
+        receive
+            Reply -> Reply
+        end,
+    HeapSize1 = heap_size(),
+    Literals = collect(1000, []),
+    HeapSize2 = heap_size(),
+    % literals are not copied to the heap, so just list cells are allocated
+    true = HeapSize2 - HeapSize1 < 1000 * erts_debug:flat_size(Echoed),
+    count_same(Literals, Echoed, 0).
+
+heap_size() ->
+    {heap_size, HeapSize} = process_info(self(), heap_size),
+    HeapSize.
+
+echo() ->
+    receive
+        {From, Term} ->
+            From ! Term,
+            echo()
+    end.
+
+collect(0, Acc) ->
+    Acc;
+collect(N, Acc) ->
+    collect(N - 1, [literal() | Acc]).
+
+count_same([], _Term, Acc) ->
+    Acc;
+count_same([H | T], Term, Acc) when H =:= Term ->
+    count_same(T, Term, Acc + 1);
+count_same([_H | T], Term, Acc) ->
+    count_same(T, Term, Acc).
+
+literal() ->
+    {literal, [1, 2, 3], <<"binary">>, {nested, "string"}}.
@@ -0,0 +1,45 @@
+-module(test_message_pool).
+
+-export([start/0, echo/0]).
+
+start() ->
+    Pid = spawn(?MODULE, echo, []),
+    Count = ping(Pid, 1000, 0),
+    Pid ! stop,
+    [
+        {live_words, LiveWords},
+        {cached_words, CachedWords},
+        {fragmentation, Fragmentation},
+        {allocs, Allocs},
+        {pool_hits, PoolHits},
+        {classes, Classes}
+    ] = erlang:system_info(message_pool),
+    true = LiveWords >= 0,
+    true = CachedWords >= 0,
+    true = (Fragmentation >= 0) andalso (Fragmentation =< 100),
+    true = PoolHits > 0,
+    true = Allocs >= PoolHits,
+    {0, _LargeLive, 0} = lists_last(Classes),
+    Count.
+
+ping(_Pid, 0, Count) ->
+    Count;
+ping(Pid, N, Count) ->
+    Pid ! {self(), N, N * 2},
+    receive
+        {N, Double} -> ping(Pid, N - 1, Count + Double - N)
+    end.
+
+echo() ->
+    receive
+        {Parent, N, Double} ->
+            Parent ! {N, Double},
+            echo();
+        stop ->
+            ok
+    end.
+
+lists_last([Last]) ->
+    Last;
+lists_last([_H | T]) ->
+    lists_last(T).
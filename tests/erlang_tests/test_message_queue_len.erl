@@ -0,0 +1,52 @@
+-module(test_message_queue_len).
+
+-export([start/0]).
+
+start() ->
+    0 = queue_len(),
+    send_many(self(), 100),
+    100 = queue_len(),
+    ok = receive_match(50),
+    99 = queue_len(),
+    ok = receive_any(9),
+    90 = queue_len(),
+    ok = receive_any(90),
+    0 = queue_len(),
+    Self = self(),
+    Pid = spawn(fun() -> worker(Self) end),
+    send_many(Pid, 20),
+    Pid ! {report, Self},
+    receive
+        {len, Len} -> Len
+    end.
+
+queue_len() ->
+    {message_queue_len, Len} = process_info(self(), message_queue_len),
+    Len.
+
+worker(Parent) ->
+    receive
+        {report, Parent} -> ok
+    end,
+    Len = queue_len(),
+    ok = receive_any(1),
+    Parent ! {len, Len * 10 + queue_len()}.
+
+send_many(_Pid, 0) ->
+    ok;
+send_many(Pid, N) ->
+    Pid ! {msg, N, lists:seq(1, N rem 10)},
+    send_many(Pid, N - 1).
+
+receive_match(N) ->
+    receive
+        {msg, N, _} -> ok
+    end.
+
+receive_any(0) ->
+    ok;
+receive_any(N) ->
+    receive
+        {msg, _, _} -> receive_any(N - 1)
+    end,
+    ok.
@@ -0,0 +1,49 @@
+-module(test_opcode_stats).
+-export([start/0, count/2]).
+
+% opcode_stats is undefined when AtomVM is built without AVM_OPCODE_PROFILER, test-erlang runs
+% this test only when it is built with it
+start() ->
+    Before = erlang:system_info(opcode_stats),
+    1000 = count(1000, 0),
+    After = erlang:system_info(opcode_stats),
+    true = sorted(After, -1),
+    true = not_decreasing(Before, After),
+    true = executed(After) - executed(Before) >= 3000,
+    % each iteration of count/2 ends with a tail call: call_only, or move_call_only (242) when it
+    % is fused with the move before it
+    true = tail_calls(After) - tail_calls(Before) >= 1000,
+    1.
+
+count(0, Acc) ->
+    Acc;
+count(N, Acc) ->
+    count(N - 1, Acc + 1).
+
+% each opcode is reported once, sorted, with a counter that is not 0
+sorted([], _Last) ->
+    true;
+sorted([Stats | T], Last) ->
+    Opcode = element(1, Stats),
+    Opcode > Last andalso Opcode < 256 andalso element(2, Stats) > 0 andalso sorted(T, Opcode).
+
+not_decreasing([], _After) ->
+    true;
+not_decreasing([Stats | T], After) ->
+    count_of(element(1, Stats), After) >= element(2, Stats) andalso not_decreasing(T, After).
+
+count_of(_Opcode, []) ->
+    0;
+count_of(Opcode, [Stats | T]) ->
+    case element(1, Stats) of
+        Opcode -> element(2, Stats);
+        _Other -> count_of(Opcode, T)
+    end.
+
+executed([]) ->
+    0;
+executed([Stats | T]) ->
+    element(2, Stats) + executed(T).
+
+tail_calls(Stats) ->
+    count_of(6, Stats) + count_of(242, Stats).
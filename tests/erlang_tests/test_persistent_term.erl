@@ -0,0 +1,65 @@
+-module(test_persistent_term).
+
+-export([start/0, echo/0]).
+
+start() ->
+    ok = persistent_term:put(routes, make_routes(100, [])),
+    default = persistent_term:get(missing, default),
+    Missing =
+        try persistent_term:get(missing) of
+            _Value -> 0
+        catch
+            error:badarg -> 1000
+        end,
+    Pid = spawn(?MODULE, echo, []),
+    Pid ! {self(), persistent_term:get(routes)},
+    Echoed =
+        receive
+            Reply -> Reply
+        end,
+    Shared = is_same(Echoed, persistent_term:get(routes)),
+    HeapSize1 = heap_size(),
+    Gets = get_many(routes, 100, []),
+    HeapSize2 = heap_size(),
+    % the value is not copied to the heap, so just list cells are allocated
+    true = HeapSize2 - HeapSize1 < 100 * erts_debug:flat_size(Echoed),
+    100 = length(Gets),
+    ok = persistent_term:put(routes, replaced),
+    replaced = persistent_term:get(routes),
+    ok = put_many(routes, 1000),
+    1000 = persistent_term:get(routes),
+    % replaced values are still valid
+    100 = length(hd(Gets)),
+    Missing + Shared + erts_debug:flat_size(Echoed) + length(Echoed).
+
+heap_size() ->
+    {heap_size, HeapSize} = process_info(self(), heap_size),
+    HeapSize.
+
+put_many(_Key, 0) ->
+    ok;
+put_many(Key, N) ->
+    ok = persistent_term:put(Key, 1001 - N),
+    put_many(Key, N - 1).
+
+get_many(_Key, 0, Acc) ->
+    Acc;
+get_many(Key, N, Acc) ->
+    get_many(Key, N - 1, [persistent_term:get(Key) | Acc]).
+
+echo() ->
+    receive
+        {From, Term} ->
+            From ! Term,
+            echo()
+    end.
+
+make_routes(0, Acc) ->
+    Acc;
+make_routes(N, Acc) ->
+    make_routes(N - 1, [{N, N * 2} | Acc]).
+
+is_same(A, B) when A =:= B ->
+    1;
+is_same(_A, _B) ->
+    0.
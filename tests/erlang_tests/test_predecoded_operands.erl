@@ -0,0 +1,53 @@
+-module(test_predecoded_operands).
+-export([start/0, id/1, many_args/16]).
+
+start() ->
+    integers() + atoms() + many_args(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16) +
+    y_registers(10) + literals().
+
+% integers of every compact term size
+integers() ->
+    sum([id(7), id(300), id(-5), id(70000), id(-70000), id(67108863), id(-67108864)]).
+
+% atom operands with an index that doesn't fit the short encoding
+atoms() ->
+    L = [id(alpha01), id(alpha02), id(alpha03), id(alpha04), id(alpha05), id(alpha06), id(alpha07), id(alpha08),
+         id(alpha09), id(alpha10), id(alpha11), id(alpha12), id(alpha13), id(alpha14), id(alpha15), id(alpha16),
+         id(alpha17), id(alpha18), id(alpha19), id(alpha20)],
+    [alpha01 | _] = L,
+    alpha20 = last(L),
+    length(L).
+
+% every x register
+many_args(A1, _A2, _A3, _A4, _A5, _A6, _A7, _A8, A9, _A10, _A11, _A12, _A13, _A14, A15, A16) ->
+    A16 * 1000 + A15 * 100 + A9 * 10 + A1.
+
+y_registers(N) ->
+    A = id(N),
+    B = id(N + 1),
+    C = id(N + 2),
+    D = id(N + 3),
+    E = id(N + 4),
+    F = id(N + 5),
+    G = id(N + 6),
+    H = id(N + 7),
+    I = id(N + 8),
+    J = id(N + 9),
+    A + B + C + D + E + F + G + H + I + J.
+
+literals() ->
+    {tuple, Str, List, Bin} = id({tuple, "string", [1, 2, 3], <<"bin">>}),
+    length(Str) + sum(List) + byte_size(Bin).
+
+sum([]) ->
+    0;
+sum([H | T]) ->
+    H + sum(T).
+
+last([X]) ->
+    X;
+last([_H | T]) ->
+    last(T).
+
+id(X) ->
+    X.
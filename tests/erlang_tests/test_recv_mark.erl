@@ -0,0 +1,58 @@
+-module(test_recv_mark).
+
+-export([start/0, echo/0]).
+
+start() ->
+    Echo = spawn(?MODULE, echo, []),
+    send_junk(self(), 1000),
+    Reply1 = call(Echo, 10),
+    % messages queued before the mark are skipped, not received
+    1001 = queue_len(),
+    Reply2 = call(Echo, 20),
+    1002 = queue_len(),
+    Echo ! stop,
+    Drained = drain_junk(1000, 0),
+    {junk, 10} = receive_first(),
+    {junk, 20} = receive_first(),
+    0 = queue_len(),
+    Reply1 + Reply2 + Drained + 2.
+
+queue_len() ->
+    {message_queue_len, Len} = process_info(self(), message_queue_len),
+    Len.
+
+receive_first() ->
+    receive
+        Message -> Message
+    after 0 -> empty
+    end.
+
+call(Pid, Value) ->
+    Ref = make_ref(),
+    Pid ! {self(), Ref, Value},
+    receive
+        {Ref, Reply} -> Reply
+    end.
+
+echo() ->
+    receive
+        {Pid, Ref, Value} ->
+            Pid ! {junk, Value},
+            Pid ! {Ref, Value * 2},
+            echo();
+        stop ->
+            ok
+    end.
+
+send_junk(_Pid, 0) ->
+    ok;
+send_junk(Pid, N) ->
+    Pid ! {junk, N},
+    send_junk(Pid, N - 1).
+
+% junk messages are still queued in the order they have been sent
+drain_junk(0, Acc) ->
+    Acc;
+drain_junk(N, Acc) ->
+    {junk, N} = receive_first(),
+    drain_junk(N - 1, Acc + 1).
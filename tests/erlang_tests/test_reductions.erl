@@ -0,0 +1,30 @@
+-module(test_reductions).
+-export([start/0]).
+
+start() ->
+    Default = erlang:system_info(reductions_per_slice),
+    Default = erlang:system_flag(reductions_per_slice, 100),
+    100 = erlang:system_flag(reductions_per_slice, Default),
+    error = try_set_slice(0),
+    L = make_list(4096, []),
+    {reductions, R0} = process_info(self(), reductions),
+    Bin = list_to_binary(L),
+    {reductions, R1} = process_info(self(), reductions),
+    cost(R1 - R0) + byte_size(Bin).
+
+try_set_slice(Value) ->
+    try erlang:system_flag(reductions_per_slice, Value) of
+        _Any -> ok
+    catch
+        error:badarg -> error
+    end.
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [N rem 256 | Acc]).
+
+cost(Reductions) when Reductions >= 256 ->
+    1;
+cost(_Reductions) ->
+    0.
@@ -0,0 +1,61 @@
+-module(test_select_table).
+-export([start/0, weekday/1, digit/1, sparse/1, arity/1, sparse_arity/1, kind/1]).
+
+start() ->
+    weekday(mon) + weekday(sun) + weekday(holiday) + weekday([]) +
+    digit(-2) + digit(5) + digit(9) + digit(foo) + digit(-3) + digit(6) + digit([]) + digit(134217727) +
+    sparse(-100) + sparse(1000) + sparse(8) + sparse(65535) + sparse(-101) + sparse([]) +
+    arity({a}) + arity({a, b, c, d, e, f}) + arity({a, b, c, d, e, f, g}) + arity({}) +
+    sparse_arity({a}) + sparse_arity({a, b, c, d, e, f, g, h, i}) + sparse_arity({}) +
+    sparse_arity({a, b, c, d}) + sparse_arity({a, b, c, d, e, f, g, h, i, j}) +
+    kind([]) + kind(d) + kind(f) + kind("x") + kind(z).
+
+weekday(mon) -> 1;
+weekday(tue) -> 2;
+weekday(wed) -> 3;
+weekday(thu) -> 4;
+weekday(fri) -> 5;
+weekday(sat) -> 6;
+weekday(sun) -> 7;
+weekday(_) -> 0.
+
+digit(-2) -> 1;
+digit(-1) -> 2;
+digit(0) -> 3;
+digit(1) -> 4;
+digit(2) -> 5;
+digit(3) -> 6;
+digit(4) -> 7;
+digit(5) -> 8;
+digit(_) -> 0.
+
+sparse(-100) -> 1;
+sparse(7) -> 2;
+sparse(42) -> 3;
+sparse(1000) -> 4;
+sparse(65535) -> 5;
+sparse(_) -> 0.
+
+arity({_}) -> 1;
+arity({_, _}) -> 2;
+arity({_, _, _}) -> 3;
+arity({_, _, _, _}) -> 4;
+arity({_, _, _, _, _}) -> 5;
+arity({_, _, _, _, _, _}) -> 6;
+arity(_) -> 0.
+
+sparse_arity({_}) -> 1;
+sparse_arity({_, _, _}) -> 3;
+sparse_arity({_, _, _, _, _}) -> 5;
+sparse_arity({_, _, _, _, _, _, _}) -> 7;
+sparse_arity({_, _, _, _, _, _, _, _, _}) -> 9;
+sparse_arity(_) -> 0.
+
+kind([]) -> 10;
+kind(a) -> 20;
+kind(b) -> 30;
+kind(c) -> 40;
+kind(d) -> 50;
+kind(e) -> 60;
+kind(f) -> 70;
+kind(_) -> 0.
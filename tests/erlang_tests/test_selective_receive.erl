@@ -0,0 +1,38 @@
+-module(test_selective_receive).
+
+-export([start/0, sender/2]).
+
+start() ->
+    send_all(self(), 100),
+    self() ! last,
+    receive
+        last -> ok
+    end,
+    Sum = receive_in_order(1, 100, 0),
+    spawn(?MODULE, sender, [self(), 50]),
+    receive
+        {reply, Reply} -> Sum + Reply + drain(0)
+    end.
+
+sender(Parent, N) ->
+    send_all(Parent, N),
+    Parent ! {reply, N}.
+
+send_all(_Pid, 0) ->
+    ok;
+send_all(Pid, N) ->
+    Pid ! {N, [N, N * 2]},
+    send_all(Pid, N - 1).
+
+receive_in_order(N, Max, Acc) when N > Max ->
+    Acc;
+receive_in_order(N, Max, Acc) ->
+    receive
+        {N, [N, Double]} -> receive_in_order(N + 1, Max, Acc + Double)
+    end.
+
+drain(Acc) ->
+    receive
+        {N, [N, _Double]} -> drain(Acc + 1)
+    after 0 -> Acc
+    end.
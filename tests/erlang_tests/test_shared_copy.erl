@@ -0,0 +1,28 @@
+-module(test_shared_copy).
+
+-export([start/0, worker/3]).
+
+start() ->
+    Shared = make_shared(16),
+    327677 = erts_debug:flat_size(Shared),
+    Size = erts_debug:size(Shared),
+    self() ! Shared,
+    ReceivedSize =
+        receive
+            Received -> erts_debug:size(Received)
+        end,
+    spawn(?MODULE, worker, [self(), Shared, Shared]),
+    WorkerSize =
+        receive
+            {size, S} -> S
+        end,
+    Size + ReceivedSize + WorkerSize.
+
+worker(Parent, A, B) ->
+    Parent ! {size, erts_debug:size({A, B})}.
+
+make_shared(0) ->
+    {self()};
+make_shared(N) ->
+    S = make_shared(N - 1),
+    {S, S}.
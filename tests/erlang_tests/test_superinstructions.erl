@@ -0,0 +1,58 @@
+-module(test_superinstructions).
+-export([start/0, id/1]).
+
+start() ->
+    tagged_tuples() + lists() + tail_calls() + returns().
+
+% is_tagged_tuple followed by get_tuple_element, including every way of failing the test
+tagged_tuples() ->
+    x({point, 3, 4}) + x({point, 3}) + x({other, 3, 4}) + x(point) + x([point, 3, 4]).
+
+x({point, X, _Y}) ->
+    X;
+x(_Any) ->
+    100.
+
+% test_heap followed by put_list, is_nonempty_list followed by get_list, failing on the empty list and on non lists
+lists() ->
+    L = make_list(10, []),
+    sum(L) + length(L) + first(L) + first([]) + first(id(not_a_list)).
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [N | Acc]).
+
+sum([H | T]) ->
+    H + sum(T);
+sum([]) ->
+    0.
+
+first([H | _T]) ->
+    H;
+first(_Any) ->
+    1000.
+
+% move followed by call_only
+tail_calls() ->
+    countdown(id(5)).
+
+countdown(0) ->
+    done(10000);
+countdown(N) ->
+    countdown(N - 1).
+
+done(N) ->
+    N.
+
+% move followed by return
+returns() ->
+    answer(id(a)) + answer(id(b)).
+
+answer(a) ->
+    20000;
+answer(_Any) ->
+    40000.
+
+id(X) ->
+    X.
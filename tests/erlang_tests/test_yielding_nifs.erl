@@ -0,0 +1,25 @@
+-module(test_yielding_nifs).
+-export([start/0]).
+
+start() ->
+    Default = erlang:system_flag(reductions_per_slice, 10),
+    L = make_list(20000, []),
+    Bin = list_to_binary(L),
+    L2 = binary_to_list(Bin),
+    Bin2 = list_to_binary(L2 ++ "XYZ" ++ L),
+    [Tok, Rest] = binary:split(Bin2, <<"XYZ">>),
+    Invalid = invalid(L ++ [foo]),
+    Default = erlang:system_flag(reductions_per_slice, Default),
+    byte_size(Bin) + length(L2) + byte_size(Tok) + byte_size(Rest) + Invalid.
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [N rem 64 | Acc]).
+
+invalid(L) ->
+    try list_to_binary(L) of
+        _Any -> 1000
+    catch
+        error:badarg -> 1
+    end.
@@ -19,8 +19,19 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "atomshashtable.h"
+#include "context.h"
+#include "globalcontext.h"
+#include "memory.h"
+#include "term.h"
+#ifdef ENABLE_JIT
+    #include "bif.h"
+    #include "jit.h"
+    #include "module.h"
+    #include "opcodes.h"
+#endif
 #include "valueshashtable.h"
 #include "utils.h"
 
@@ -138,6 +149,323 @@ void test_valueshashtable()
     }
 }
 
+static term make_pair(Context *ctx, term first, term second)
+{
+    assert(memory_ensure_free(ctx, 3) == MEMORY_GC_OK);
+    term pair = term_alloc_tuple(2, ctx);
+    term_put_tuple_element(pair, 0, first);
+    term_put_tuple_element(pair, 1, second);
+
+    return pair;
+}
+
+static void make_garbage(Context *ctx, int count)
+{
+    for (int i = 0; i < count; i++) {
+        make_pair(ctx, term_from_int32(i), term_nil());
+    }
+}
+
+void test_incremental_gc_write_barrier()
+{
+    GlobalContext *glb = globalcontext_new();
+    assert(glb != NULL);
+    Context *ctx = context_new(glb);
+    assert(ctx != NULL);
+    ctx->max_gc_pause = 200;
+    ctx->has_min_heap_size = 1;
+    ctx->min_heap_size = 32768;
+
+    const int items_count = 2000;
+    ctx->x[0] = term_nil();
+    for (int i = 0; i < items_count; i++) {
+        term pair = make_pair(ctx, term_from_int32(i), term_nil());
+        assert(memory_ensure_free(ctx, 2) == MEMORY_GC_OK);
+        ctx->x[0] = term_list_prepend(pair, ctx->x[0], ctx);
+    }
+
+    int slices = 0;
+    while (!ctx->incremental_gc) {
+        make_garbage(ctx, 64);
+        memory_incremental_gc_slice(ctx);
+        slices++;
+        assert(slices < 10000);
+    }
+
+    // pairs built before the collection started are modified while it is running, half of them get a term that is
+    // allocated after the collection started
+    int writes = 0;
+    int written = 0;
+    while (ctx->incremental_gc && (written < items_count)) {
+        term value = (written % 2) ? term_from_int32(written) : make_pair(ctx, term_from_int32(written), term_nil());
+
+        // make_pair might have run a collection, so the list is walked only now
+        term t = ctx->x[0];
+        for (int i = 0; i < written; i++) {
+            t = term_get_list_tail(t);
+        }
+        term pair = term_get_list_head(t);
+        term_put_tuple_element(pair, 1, value);
+        if (ctx->incremental_gc) {
+            writes++;
+        }
+        context_write_barrier(ctx, pair);
+        written++;
+
+        // enough garbage to keep the collection from being completed without extending the snapshot first
+        make_garbage(ctx, 512);
+        memory_incremental_gc_slice(ctx);
+    }
+    assert(writes > 0);
+
+    // terms allocated in the meantime make the snapshot be extended before the collection is completed
+    while (ctx->incremental_gc) {
+        make_garbage(ctx, 64);
+        memory_incremental_gc_slice(ctx);
+    }
+
+    int count = 0;
+    for (term t = ctx->x[0]; !term_is_nil(t); t = term_get_list_tail(t)) {
+        term pair = term_get_list_head(t);
+        assert(term_to_int32(term_get_tuple_element(pair, 0)) == items_count - 1 - count);
+        term value = term_get_tuple_element(pair, 1);
+        if (count >= written) {
+            assert(term_is_nil(value));
+        } else if (count % 2) {
+            assert(value == term_from_int32(count));
+        } else {
+            assert(term_is_tuple(value));
+            assert(term_to_int32(term_get_tuple_element(value, 0)) == count);
+        }
+        count++;
+    }
+    assert(count == items_count);
+
+    context_destroy(ctx);
+    globalcontext_destroy(glb);
+}
+
+#ifdef ENABLE_JIT
+// operand words, as they are emitted by the code loader
+#define XREG(index) (((index) << 4) | 3)
+#define YREG(index) (((index) << 4) | 4)
+
+struct JitTestCode
+{
+    const term *code;
+    int code_len;
+    // instructions as they are recorded by the loader, a negative index is a jump target
+    const int *instructions;
+    int instructions_count;
+    const int *labels;
+    int labels_count;
+};
+
+static Module *new_jit_module(GlobalContext *glb, const struct JitTestCode *test_code)
+{
+    Module *mod = calloc(1, sizeof(Module));
+    assert(mod != NULL);
+    mod->global = glb;
+    mod->instructions = malloc(test_code->code_len * sizeof(term));
+    assert(mod->instructions != NULL);
+    memcpy(mod->instructions, test_code->code, test_code->code_len * sizeof(term));
+    mod->labels = calloc(test_code->labels_count, sizeof(void *));
+    assert(mod->labels != NULL);
+    for (int i = 1; i < test_code->labels_count; i++) {
+        mod->labels[i] = &mod->instructions[test_code->labels[i]];
+    }
+    // code ends with int_call_end
+    mod->end_instruction_ii = test_code->code_len - 1;
+    mod->imported_funcs = calloc(2, sizeof(union imported_func));
+    assert(mod->imported_funcs != NULL);
+    mod->imported_funcs[0].bif = (BifImpl) bif_erlang_add_2;
+    mod->imported_funcs[1].bif = (BifImpl) bif_erlang_sub_2;
+
+    mod->jit_instructions = malloc(test_code->code_len * sizeof(unsigned int));
+    assert(mod->jit_instructions != NULL);
+    for (int i = 0; i < test_code->instructions_count; i++) {
+        int instruction_ii = test_code->instructions[i];
+        jit_add_instruction(mod, abs(instruction_ii), (i == 0) || (instruction_ii < 0));
+    }
+    jit_compile_module(mod);
+
+    return mod;
+}
+
+static void destroy_jit_module(Module *mod)
+{
+    jit_module_destroy(mod);
+    free(mod->imported_funcs);
+    free(mod->labels);
+    free(mod->instructions);
+    free(mod);
+}
+
+static void test_jit_list_instructions(Context *ctx)
+{
+    const term code[] = {
+        OP_MOVE, XREG(0), XREG(1),
+        OP_GET_LIST, XREG(1), YREG(1), XREG(2),
+        OP_IS_NIL, 1, XREG(2),
+        OP_GET_TUPLE_ELEMENT, YREG(1), 1, XREG(3),
+        OP_MOVE, term_from_int32(42), YREG(0),
+        OP_INT_CALL_END
+    };
+    const int instructions[] = { 0, 3, 7, 10, 14 };
+    const int labels[] = { 0, 17 };
+    struct JitTestCode test_code = { code, sizeof(code) / sizeof(term), instructions, 5, labels, 2 };
+
+    ctx->e[0] = term_nil();
+    ctx->e[1] = term_nil();
+    term tuple = term_alloc_tuple(2, ctx);
+    term_put_tuple_element(tuple, 0, term_from_int32(7));
+    term_put_tuple_element(tuple, 1, term_from_int32(8));
+    term list = term_list_prepend(tuple, term_nil(), ctx);
+    term longer_list = term_list_prepend(tuple, list, ctx);
+
+    // the whole function is a single run, that returns the instruction after it
+    Module *mod = new_jit_module(ctx->global, &test_code);
+    assert(mod->instructions[0] == OP_INT_NATIVE);
+    NativeCode native_code = (NativeCode) mod->instructions[1];
+
+    ctx->x[0] = list;
+    assert(native_code(ctx) == 17);
+    assert(ctx->x[1] == list);
+    assert(ctx->e[1] == tuple);
+    assert(ctx->x[2] == term_nil());
+    assert(ctx->x[3] == term_from_int32(8));
+    assert(ctx->e[0] == term_from_int32(42));
+
+    // a failed test returns its label, and following instructions are not executed
+    ctx->x[3] = term_nil();
+    ctx->e[0] = term_nil();
+    ctx->x[0] = longer_list;
+    assert(native_code(ctx) == 17);
+    assert(ctx->x[2] == list);
+    assert(ctx->x[3] == term_nil());
+    assert(ctx->e[0] == term_nil());
+    destroy_jit_module(mod);
+
+    // jump targets start a new run
+    const int split_instructions[] = { 0, 3, -7, 10, 14 };
+    test_code.instructions = split_instructions;
+    mod = new_jit_module(ctx->global, &test_code);
+    assert(mod->instructions[0] == OP_INT_NATIVE);
+    assert(mod->instructions[3] == OP_GET_LIST);
+    assert(mod->instructions[7] == OP_INT_NATIVE);
+    native_code = (NativeCode) mod->instructions[1];
+    ctx->x[0] = list;
+    assert(native_code(ctx) == 7);
+    destroy_jit_module(mod);
+}
+
+static void test_jit_branch_instructions(Context *ctx)
+{
+    const term code[] = {
+        OP_MOVE, XREG(0), XREG(1),
+        OP_IS_INTEGER, 2, XREG(1),
+        OP_IS_LT, 2, XREG(1), term_from_int32(100),
+        OP_GC_BIF2, 0, 2, 0, XREG(1), term_from_int32(5), XREG(2),
+        OP_GC_BIF2, 0, 3, 1, XREG(2), XREG(0), XREG(3),
+        OP_IS_EQ_EXACT, 2, XREG(3), term_from_int32(5),
+        OP_JUMP, 1,
+        OP_RETURN,
+        OP_INT_CALL_END
+    };
+    const int instructions[] = { 0, 3, 6, 10, 17, 24, 28, 30 };
+    const int labels[] = { 0, 31, 30 };
+    struct JitTestCode test_code = { code, sizeof(code) / sizeof(term), instructions, 8, labels, 3 };
+
+    // a run ends with a jump, that returns its label
+    Module *mod = new_jit_module(ctx->global, &test_code);
+    assert(mod->instructions[0] == OP_INT_NATIVE);
+    NativeCode native_code = (NativeCode) mod->instructions[1];
+
+    ctx->remaining_reductions = 10;
+    ctx->x[0] = term_from_int32(3);
+    assert(native_code(ctx) == 31);
+    assert(ctx->x[2] == term_from_int32(8));
+    assert(ctx->x[3] == term_from_int32(5));
+    assert(ctx->remaining_reductions == 9);
+
+    // failed type and compare tests
+    ctx->x[2] = term_nil();
+    ctx->x[0] = context_make_atom(ctx, "\x2" "ok");
+    assert(native_code(ctx) == 30);
+    ctx->x[0] = term_from_int32(200);
+    assert(native_code(ctx) == 30);
+    assert(ctx->x[2] == term_nil());
+
+    // the interpreter executes the jump when the process has to be scheduled out
+    ctx->remaining_reductions = 1;
+    ctx->x[0] = term_from_int32(3);
+    assert(native_code(ctx) == 28);
+    assert(ctx->remaining_reductions == 1);
+    destroy_jit_module(mod);
+
+    const term fallback_code[] = {
+        OP_MOVE, XREG(0), XREG(1),
+        OP_IS_EQ_EXACT, 1, XREG(1), XREG(4),
+        OP_GC_BIF2, 0, 2, 0, XREG(1), XREG(4), XREG(2),
+        OP_RETURN,
+        OP_RETURN,
+        OP_INT_CALL_END
+    };
+    const int fallback_instructions[] = { 0, 3, 7, 14, 15 };
+    const int fallback_labels[] = { 0, 15 };
+    struct JitTestCode fallback_test_code = { fallback_code, sizeof(fallback_code) / sizeof(term), fallback_instructions, 5, fallback_labels, 2 };
+
+    mod = new_jit_module(ctx->global, &fallback_test_code);
+    assert(mod->instructions[0] == OP_INT_NATIVE);
+    native_code = (NativeCode) mod->instructions[1];
+
+    ctx->x[0] = term_from_int32(7);
+    ctx->x[4] = term_from_int32(7);
+    assert(native_code(ctx) == 14);
+    assert(ctx->x[2] == term_from_int32(14));
+
+    ctx->x[4] = term_from_int32(8);
+    assert(native_code(ctx) == 15);
+
+    // boxed terms are compared by the interpreter
+    ctx->x[0] = term_alloc_tuple(0, ctx);
+    ctx->x[4] = term_alloc_tuple(0, ctx);
+    assert(native_code(ctx) == 3);
+    assert(ctx->x[1] == ctx->x[0]);
+
+    // anything but 32 bits integer arithmetic is left to the BIF
+    ctx->x[2] = term_nil();
+    ctx->x[0] = context_make_atom(ctx, "\x2" "ok");
+    ctx->x[4] = ctx->x[0];
+    assert(native_code(ctx) == 7);
+    ctx->x[0] = term_from_int32(1 << 26);
+    ctx->x[4] = ctx->x[0];
+    assert(native_code(ctx) == 7);
+    assert(ctx->x[2] == term_nil());
+    ctx->x[0] = term_from_int32(-3);
+    ctx->x[4] = ctx->x[0];
+    assert(native_code(ctx) == 14);
+    assert(ctx->x[2] == term_from_int32(-6));
+    destroy_jit_module(mod);
+}
+
+void test_jit()
+{
+    GlobalContext *glb = globalcontext_new();
+    assert(glb != NULL);
+    Context *ctx = context_new(glb);
+    assert(ctx != NULL);
+    assert(memory_ensure_free(ctx, 16) == MEMORY_GC_OK);
+    ctx->e -= 2;
+
+    test_jit_list_instructions(ctx);
+    test_jit_branch_instructions(ctx);
+
+    context_destroy(ctx);
+    globalcontext_destroy(glb);
+}
+#endif
+
 int main(int argc, char **argv)
 {
     UNUSED(argc);
@@ -145,6 +473,10 @@ int main(int argc, char **argv)
 
     test_atomshashtable();
     test_valueshashtable();
+    test_incremental_gc_write_barrier();
+#ifdef ENABLE_JIT
+    test_jit();
+#endif
 
     return EXIT_SUCCESS;
 }
@@ -27,6 +27,7 @@
 #include <unistd.h>
 
 #include "atom.h"
+#include "atomshashtable.h"
 #include "bif.h"
 #include "context.h"
 #include "../platforms/generic_unix/mapped_file.h"
@@ -257,6 +258,34 @@ struct Test tests[] =
     {"test_binary_part.beam", 12},
     {"test_binary_split.beam", 16},
 
+    {"test_predecoded_operands.beam", 18072},
+    {"test_large_integer_operands.beam", 26},
+    {"test_dispatch.beam", 80016},
+    {"test_superinstructions.beam", 72469},
+    {"test_select_table.beam", 174},
+    {"test_link_on_load.beam", 42},
+#ifdef ENABLE_OPCODE_PROFILER
+    {"test_opcode_stats.beam", 1},
+#endif
+    {"test_dynamic_call_cache.beam", 216},
+    {"test_function_profiler.beam", 65},
+    {"test_reductions.beam", 4097},
+    {"test_yielding_nifs.beam", 80001},
+    {"test_dirty_file_read.beam", 136},
+    {"test_literal_area.beam", 1000},
+    {"test_persistent_term.beam", 1601},
+    {"test_generational_gc.beam", 6003},
+    {"test_heap_growth.beam", 1500},
+    {"test_heap_pool.beam", 50},
+    {"test_compacting_gc.beam", 1500},
+    {"test_incremental_gc.beam", 27000},
+    {"test_shared_copy.beam", 153},
+    {"test_heap_fragments.beam", 2000},
+    {"test_selective_receive.beam", 10200},
+    {"test_recv_mark.beam", 1062},
+    {"test_message_queue_len.beam", 219},
+    {"test_message_pool.beam", 500500},
+
     {"plusone.beam", 67108863},
     {"plusone2.beam", 1},
     {"minusone.beam", -67108864},
@@ -277,10 +306,6 @@ int test_modules_execution()
 {
     struct Test *test = tests;
 
-    if (chdir("erlang_tests")) {
-        return EXIT_FAILURE;
-    }
-
     int failed_tests = 0;
 
     do {
@@ -298,6 +323,12 @@ int test_modules_execution()
             continue;
         }
         globalcontext_insert_module_with_filename(glb, mod, test->test_file);
+#ifdef ENABLE_LINK_ON_LOAD
+        int unresolved_count = globalcontext_link_modules(glb);
+        if (unresolved_count) {
+            fprintf(stderr, "Warning: %i imported functions cannot be resolved.\n", unresolved_count);
+        }
+#endif
         Context *ctx = context_new(glb);
         ctx->leader = 1;
 
@@ -326,6 +357,60 @@ int test_modules_execution()
     }
 }
 
+// the link phase loads the whole dependency graph before any code runs: test_link_on_load imports
+// test_link_on_load_dep, that imports modc, that imports moda, that imports modb
+static const char *const linked_modules[] = {
+    "\x15" "test_link_on_load_dep",
+    "\x4" "modc",
+    "\x4" "moda",
+    "\x4" "modb",
+    NULL
+};
+
+static int is_module_loaded(GlobalContext *glb, const char *module_name)
+{
+    return atomshashtable_get_value(glb->modules_table, (AtomString) module_name, (unsigned long) NULL) != (unsigned long) NULL;
+}
+
+int test_link_on_load()
+{
+    printf("-- EXECUTING TEST: link on load\n");
+    MappedFile *beam_file = mapped_file_open_beam("test_link_on_load.beam");
+    assert(beam_file != NULL);
+
+    GlobalContext *glb = globalcontext_new();
+    glb->avmpack_data = NULL;
+    glb->avmpack_platform_data = NULL;
+    Module *mod = module_new_from_iff_binary(glb, beam_file->mapped, beam_file->size);
+    assert(mod != NULL);
+    globalcontext_insert_module_with_filename(glb, mod, "test_link_on_load.beam");
+
+    int failed = is_module_loaded(glb, linked_modules[0]);
+    // non_existing_module:f/0 cannot be resolved, but it doesn't stop the link phase
+    failed |= globalcontext_link_modules(glb) == 0;
+    for (const char *const *module_name = linked_modules; *module_name; module_name++) {
+        failed |= !is_module_loaded(glb, *module_name);
+    }
+
+    Context *ctx = context_new(glb);
+    ctx->leader = 1;
+
+    context_execute_loop(ctx, mod, "start", 0);
+    failed |= term_to_int32(ctx->x[0]) != 42;
+
+    context_destroy(ctx);
+    globalcontext_destroy(glb);
+    module_destroy(mod);
+    mapped_file_close(beam_file);
+
+    if (failed) {
+        fprintf(stderr, "\x1b[1;31mFailed test link on load\x1b[0m\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv)
 {
     UNUSED(argc)
@@ -335,6 +420,14 @@ int main(int argc, char **argv)
     srand(seed);
 
     chdir(dirname(argv[0]));
+    if (chdir("erlang_tests")) {
+        return EXIT_FAILURE;
+    }
+
+    int result = test_modules_execution();
+    if (test_link_on_load() != EXIT_SUCCESS) {
+        result = EXIT_FAILURE;
+    }
 
-    return test_modules_execution();
+    return result;
 }
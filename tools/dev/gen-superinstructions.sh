@@ -0,0 +1,101 @@
+#!/bin/bash
+
+# Generates src/libAtomVM/superinstructions.h from the opcode pairs reported by a build configured with
+# -DAVM_OPCODE_PROFILER=ON -DAVM_OPCODE_PROFILER_PAIRS=ON (instructions are not fused by such a build).
+#
+# Usage: gen-superinstructions.sh opcode_stats.txt [max_pairs]
+#
+# The most executed pairs are turned into fused opcodes, starting from opcode 240. A handler must exist in
+# opcodesswitch.h for each fused opcode, the build fails until it is written.
+
+set -e
+
+ROOT_DIR=$(cd $(dirname $0)/../.. && pwd)
+OUTPUT=${ROOT_DIR}/src/libAtomVM/superinstructions.h
+
+# fused opcodes are allocated from 240 up to 244, 245 is the first select lowering opcode
+FIRST_FUSED_OPCODE=240
+MAX_PAIRS=5
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 opcode_stats.txt [max_pairs]" >&2
+    exit 1
+fi
+STATS_FILE=$1
+if [ -n "$2" ]; then
+    if [ "$2" -gt ${MAX_PAIRS} ]; then
+        echo "At most ${MAX_PAIRS} pairs can be fused" >&2
+        exit 1
+    fi
+    MAX_PAIRS=$2
+fi
+
+# the second instruction of a pair is not the one that follows the first instruction in the code when the first one
+# transfers control, so those pairs are never fused. Instructions that are not executed cannot be fused as well.
+NOT_FIRST="call call_last call_only call_ext call_ext_last call_ext_only call_fun apply apply_last return jump \
+select_val select_tuple_arity badmatch if_end case_end try_case_end loop_rec_end wait wait_timeout"
+NOT_FUSED="label func_info int_call_end line"
+
+awk -v first_fused_opcode=${FIRST_FUSED_OPCODE} -v max_pairs=${MAX_PAIRS} -v not_first="${NOT_FIRST}" -v not_fused="${NOT_FUSED}" -v stats_file=$(basename ${STATS_FILE}) '
+BEGIN {
+    split(not_first, names, " ");
+    for (i in names) {
+        excluded_first[names[i]] = 1;
+    }
+    split(not_fused, names, " ");
+    for (i in names) {
+        excluded_first[names[i]] = 1;
+        excluded_second[names[i]] = 1;
+    }
+    pairs_count = 0;
+}
+
+/^# first_opcode second_opcode/ {
+    in_pairs = 1;
+    next;
+}
+
+in_pairs && (NF >= 5) && (pairs_count < max_pairs) {
+    if (($1 >= first_fused_opcode) || ($2 >= first_fused_opcode) || ($3 in excluded_first) || ($4 in excluded_second)) {
+        next;
+    }
+    first[pairs_count] = "OP_" toupper($3);
+    second[pairs_count] = "OP_" toupper($4);
+    fused_name[pairs_count] = $3 "_" $4;
+    fused[pairs_count] = "OP_" toupper(fused_name[pairs_count]);
+    pairs_count++;
+}
+
+END {
+    if (!in_pairs) {
+        print "No opcode pairs found in " stats_file ", AVM_OPCODE_PROFILER_PAIRS is required" > "/dev/stderr";
+        exit 1;
+    }
+
+    print "// This file has been generated by tools/dev/gen-superinstructions.sh from " stats_file ", do not edit.";
+    print "";
+    print "#ifndef _SUPERINSTRUCTIONS_H_";
+    print "#define _SUPERINSTRUCTIONS_H_";
+    print "";
+    print "// Fused opcodes, sorted by the execution count of the pair they replace.";
+    for (i = 0; i < pairs_count; i++) {
+        print "#define " fused[i] " " (first_fused_opcode + i);
+    }
+    print "";
+    print "// first opcode, second opcode, fused opcode";
+    print "#define SUPERINSTRUCTIONS \\";
+    for (i = 0; i < pairs_count; i++) {
+        print "    { " first[i] ", " second[i] ", " fused[i] " }, \\";
+    }
+    print "";
+    print "#define SUPERINSTRUCTION_NAMES \\";
+    for (i = 0; i < pairs_count; i++) {
+        print "    [" fused[i] "] = \"" fused_name[i] "\", \\";
+    }
+    print "";
+    print "#endif";
+}
+' ${STATS_FILE} > ${OUTPUT}.tmp || { rm -f ${OUTPUT}.tmp; exit 1; }
+
+mv ${OUTPUT}.tmp ${OUTPUT}
+echo "Generated ${OUTPUT}"